@@ -0,0 +1,312 @@
+#include "compiler.h"
+#include "lexer.h"
+#include "utils.h"
+#include "generator.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+
+const char* usage =
+R"(Usage: bench <options>
+Generates a Nyla project and times each stage of compiling it
+over repeated runs. The results are written as JSON.
+Possible Options:
+  -files=<count>
+      Number of files in the project's lib directory. Default 100
+  -modules=<count>
+      Modules in each file. Default 2
+  -functions=<count>
+      Functions in each module. Default 10
+  -fanout=<count>
+      Number of earlier files each file imports. Default 4
+  -depth=<count>
+      How deeply the expression in each function nests. Default 4
+  -array=<count>
+      Elements of the array literal in each function. Default 8
+  -runs=<count>
+      Number of timed compiles. Default 5
+  -warmup=<count>
+      Compiles run before the timed compiles. Default 1
+  -lexer=<count>
+      Number of timed passes of the lexer alone over the
+      project's files. Default 20
+  -jobs=<count>
+      Processes the source files on <count> threads. Default 1
+  -O0 -O1 -O2 -O3 -Os
+      Sets the optimization level of the generated code
+  -out=<directory>
+      Directory the projects are generated into. Default bench_projects
+  -json=<file>
+      Writes the results to the file instead of stdout
+  -verbose
+      Shows the output of the compiler
+)";
+
+/*
+ * The times one stage took over every timed run.
+ */
+struct stage_samples {
+	const c8*        name;
+	// Time of the stage within the compile times or
+	// nullptr for the time of the entire compile
+	u64 nyla::compile_times::* time;
+	std::vector<u64> times_in_nanoseconds;
+};
+
+/*
+ * Files of the project mapped into memory so the lexer
+ * is timed without reading the files.
+ */
+struct mapped_file {
+	c8*  buffer;
+	ulen length;
+};
+
+// Number of tokens in the file
+static u64 lex_file(const mapped_file& file, nyla::compilation_context& context) {
+	nyla::source source(file.buffer, file.length);
+	nyla::log log(source, context);
+	nyla::lexer lexer(source, log, context);
+	lexer.lex_file();
+	return lexer.get_tokens().size() - 1; // Not counting TK_EOF
+}
+
+// Times passes of only the lexer over every file. The
+// first passes are not timed so the words are already
+// in the word table
+static void time_lexer(const std::vector<std::string>& paths, u32 num_runs, u32 num_warmups,
+	                   u64& num_tokens, stage_samples& samples) {
+	std::vector<mapped_file> files;
+	for (const std::string& path : paths) {
+		mapped_file file;
+		if (nyla::map_file(path, nyla::source_padding, file.buffer, file.length)) {
+			files.push_back(file);
+		}
+	}
+
+	nyla::compilation_context context;
+	for (u32 run = 0; run < num_warmups + num_runs; run++) {
+		u64 lex_st = nyla::get_time_in_nanoseconds();
+		num_tokens = 0;
+		for (const mapped_file& file : files) {
+			num_tokens += lex_file(file, context);
+		}
+		u64 lex_time = nyla::get_time_in_nanoseconds() - lex_st;
+		if (run >= num_warmups) {
+			samples.times_in_nanoseconds.push_back(lex_time);
+		}
+	}
+
+	for (const mapped_file& file : files) {
+		nyla::unmap_file(file.buffer, file.length, nyla::source_padding);
+	}
+}
+
+static std::string format_double(double value, s32 precision) {
+	c8 buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+	return buffer;
+}
+
+static double to_milliseconds(u64 time_in_nanoseconds) {
+	return time_in_nanoseconds / 1000000.0;
+}
+
+// Amount processed per second given the time in nanoseconds
+static u64 get_rate(u64 amount, u64 time_in_nanoseconds) {
+	if (time_in_nanoseconds == 0) return 0;
+	return (u64)(amount / (time_in_nanoseconds / 1000000000.0));
+}
+
+// The keys are always written in the same order so the results
+// of different builds can be compared line by line
+static void write_json(std::ostream& out,
+	                   const nyla::project_options& options,
+	                   const nyla::generated_project& project,
+	                   u64 num_tokens, u32 num_runs, u32 num_jobs,
+	                   const std::string& opt_level,
+	                   stage_samples& lexer,
+	                   std::vector<stage_samples>& stages) {
+	out << "{\n";
+	out << "  \"project\": {\n";
+	out << "    \"files\": "                << project.paths.size()         << ",\n";
+	out << "    \"modules_per_file\": "     << options.modules_per_file     << ",\n";
+	out << "    \"functions_per_module\": " << options.functions_per_module << ",\n";
+	out << "    \"import_fan_out\": "       << options.import_fan_out       << ",\n";
+	out << "    \"expression_depth\": "     << options.expression_depth     << ",\n";
+	out << "    \"array_literal_size\": "   << options.array_literal_size   << ",\n";
+	out << "    \"lines\": "                << project.num_lines            << ",\n";
+	out << "    \"bytes\": "                << project.num_bytes            << ",\n";
+	out << "    \"tokens\": "               << num_tokens                   << "\n";
+	out << "  },\n";
+	out << "  \"runs\": "      << num_runs  << ",\n";
+	out << "  \"jobs\": "      << num_jobs  << ",\n";
+	out << "  \"opt_level\": \"" << opt_level << "\",\n";
+
+	std::vector<u64>& lex_times = lexer.times_in_nanoseconds;
+	std::sort(lex_times.begin(), lex_times.end());
+	u64 lex_median = lex_times[lex_times.size() / 2];
+	out << "  \"lexer\": {";
+	out << " \"runs\": "           << lex_times.size();
+	out << ", \"min_ms\": "         << format_double(to_milliseconds(lex_times.front()), 3);
+	out << ", \"median_ms\": "      << format_double(to_milliseconds(lex_median), 3);
+	out << ", \"bytes_per_sec\": "  << get_rate(project.num_bytes, lex_median);
+	out << ", \"tokens_per_sec\": " << get_rate(num_tokens, lex_median);
+	out << " },\n";
+	out << "  \"stages\": [\n";
+	for (ulen i = 0; i < stages.size(); i++) {
+		std::vector<u64>& times = stages[i].times_in_nanoseconds;
+		std::sort(times.begin(), times.end());
+		u64 sum = 0;
+		for (u64 time : times) sum += time;
+		u64 min    = times.front();
+		u64 median = times[times.size() / 2];
+		u64 mean   = sum / times.size();
+
+		out << "    { \"name\": \"" << stages[i].name << "\"";
+		out << ", \"min_ms\": "         << format_double(to_milliseconds(min), 3);
+		out << ", \"median_ms\": "      << format_double(to_milliseconds(median), 3);
+		out << ", \"mean_ms\": "        << format_double(to_milliseconds(mean), 3);
+		out << ", \"lines_per_sec\": "  << get_rate(project.num_lines, median);
+		out << ", \"tokens_per_sec\": " << get_rate(num_tokens, median);
+		out << " }" << (i + 1 != stages.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n";
+	out << "}\n";
+}
+
+int main(int argc, char* argv[]) {
+
+	nyla::project_options options;
+	std::string out_directory = "bench_projects";
+	std::string json_file;
+	std::string opt_level = "O0";
+	u32  opt_flags   = 0;
+	u32  num_runs    = 5;
+	u32  num_warmups = 1;
+	u32  num_lexes   = 20;
+	u32  num_jobs    = 1;
+	bool verbose     = false;
+
+	for (s32 i = 1; i < argc; i++) {
+		std::string option = argv[i];
+		if (option.empty() || option[0] != '-') {
+			std::cout << usage;
+			return 1;
+		}
+		option = option.substr(1);
+		std::string value = option.substr(option.find('=') + 1);
+		if (nyla::string_starts_with(option, std::string("files="))) {
+			options.num_files = std::stoul(value);
+		} else if (nyla::string_starts_with(option, std::string("modules="))) {
+			options.modules_per_file = std::max(1ul, std::stoul(value));
+		} else if (nyla::string_starts_with(option, std::string("functions="))) {
+			options.functions_per_module = std::stoul(value);
+		} else if (nyla::string_starts_with(option, std::string("fanout="))) {
+			options.import_fan_out = std::stoul(value);
+		} else if (nyla::string_starts_with(option, std::string("depth="))) {
+			options.expression_depth = std::stoul(value);
+		} else if (nyla::string_starts_with(option, std::string("array="))) {
+			options.array_literal_size = std::stoul(value);
+		} else if (nyla::string_starts_with(option, std::string("runs="))) {
+			num_runs = std::max(1ul, std::stoul(value));
+		} else if (nyla::string_starts_with(option, std::string("warmup="))) {
+			num_warmups = std::stoul(value);
+		} else if (nyla::string_starts_with(option, std::string("lexer="))) {
+			num_lexes = std::max(1ul, std::stoul(value));
+		} else if (nyla::string_starts_with(option, std::string("jobs="))) {
+			num_jobs = std::stoul(value);
+		} else if (nyla::string_starts_with(option, std::string("out="))) {
+			out_directory = value;
+		} else if (nyla::string_starts_with(option, std::string("json="))) {
+			json_file = value;
+		} else if (option == "verbose") {
+			verbose = true;
+		} else if (option == "O0") {
+			opt_level = option; opt_flags = 0;
+		} else if (option == "O1") {
+			opt_level = option; opt_flags = nyla::COMPFLAG_OPT_O1;
+		} else if (option == "O2") {
+			opt_level = option; opt_flags = nyla::COMPFLAG_OPT_O2;
+		} else if (option == "O3") {
+			opt_level = option; opt_flags = nyla::COMPFLAG_OPT_O3;
+		} else if (option == "Os") {
+			opt_level = option; opt_flags = nyla::COMPFLAG_OPT_Os;
+		} else {
+			std::cout << "Unknown option: " << option << '\n';
+			std::cout << usage;
+			return 1;
+		}
+	}
+
+	nyla::generated_project project;
+	if (!nyla::generate_project(out_directory, options, project)) {
+		std::cerr << "Failed to generate the project in: " << out_directory << '\n';
+		return 1;
+	}
+	u64 num_tokens = 0;
+	stage_samples lexer = { "lexer", nullptr };
+	time_lexer(project.paths, num_lexes, num_warmups, num_tokens, lexer);
+
+	std::vector<stage_samples> stages;
+	stages.push_back({ "parse",    &nyla::compile_times::parse    });
+	stages.push_back({ "analysis", &nyla::compile_times::analysis });
+	stages.push_back({ "llvm_ir",  &nyla::compile_times::llvm_ir  });
+	if (opt_flags != 0) {
+		// Nothing is optimized at O0
+		stages.push_back({ "optimization", &nyla::compile_times::optimization });
+	}
+	stages.push_back({ "emit",  &nyla::compile_times::emit });
+	stages.push_back({ "link",  &nyla::compile_times::link });
+	stages.push_back({ "total", nullptr                    });
+
+	for (u32 run = 0; run < num_warmups + num_runs; run++) {
+		// The compiler prints every file it processes
+		std::streambuf* cout_buffer = std::cout.rdbuf();
+		if (!verbose) {
+			std::cout.rdbuf(nullptr);
+		}
+
+		nyla::compiler compiler;
+		compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION | opt_flags);
+		compiler.set_num_jobs(num_jobs);
+		compiler.set_executable_name(project.directory + "/bench.exe");
+
+		u64 compile_st = nyla::get_time_in_nanoseconds();
+		compiler.compile({ project.directory }, "Main");
+		u64 total_time = nyla::get_time_in_nanoseconds() - compile_st;
+
+		std::cout.rdbuf(cout_buffer);
+		std::cout.clear();
+
+		if (compiler.get_found_compilation_errors()) {
+			std::cerr << "Failed to compile the generated project: " << project.directory << '\n';
+			std::cerr << "Run with -verbose to see the errors\n";
+			compiler.completely_cleanup();
+			return 1;
+		}
+
+		if (run >= num_warmups) {
+			const nyla::compile_times& times = compiler.get_compile_times();
+			for (stage_samples& stage : stages) {
+				stage.times_in_nanoseconds.push_back(stage.time ? times.*stage.time : total_time);
+			}
+		}
+		compiler.completely_cleanup();
+	}
+
+	if (json_file.empty()) {
+		write_json(std::cout, options, project, num_tokens, num_runs, num_jobs, opt_level, lexer, stages);
+	} else {
+		std::ofstream out(json_file, std::ios::binary | std::ios::out | std::ios::trunc);
+		if (!out.good()) {
+			std::cerr << "Failed to write the results to: " << json_file << '\n';
+			return 1;
+		}
+		write_json(out, options, project, num_tokens, num_runs, num_jobs, opt_level, lexer, stages);
+	}
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include "generator.h"
+#include "utils.h"
+
+#include <algorithm>
+
+static std::string get_module_name(u32 file_index, u32 module_index) {
+	return "M" + std::to_string(file_index) + "_" + std::to_string(module_index);
+}
+
+// Adds the calls together or returns 0 if there are none
+static std::string sum_calls(const std::vector<std::string>& calls) {
+	if (calls.empty()) {
+		return "0";
+	}
+	std::string sum = calls[0];
+	for (ulen i = 1; i < calls.size(); i++) {
+		sum += " + " + calls[i];
+	}
+	return sum;
+}
+
+// Nests the expression to the right so the depth grows
+// linearly instead of doubling at each level
+static std::string gen_expression(u32 depth, u32 seed) {
+	static const c8* ops[] = { " + ", " - ", " * ", " ^ ", " & ", " | " };
+	std::string leaf = (seed % 3 == 0) ? "a" : std::to_string(seed % 97 + 1);
+	if (depth == 0) {
+		return leaf;
+	}
+	return "(" + leaf + ops[seed % 6] + gen_expression(depth - 1, seed * 31 + 7) + ")";
+}
+
+static void gen_function(std::string& code, const nyla::project_options& options,
+	                     u32 function_index, u32 seed) {
+	code += "\tstatic int f" + std::to_string(function_index) + "(int a) {\n";
+	if (options.array_literal_size > 0) {
+		code += "\t\tint[] arr = { ";
+		for (u32 i = 0; i < options.array_literal_size; i++) {
+			if (i != 0) code += ", ";
+			code += std::to_string((seed + i * 13) % 1000);
+		}
+		code += " };\n";
+	}
+	code += "\t\tint b = " + gen_expression(options.expression_depth, seed) + ";\n";
+	if (options.array_literal_size > 0) {
+		code += "\t\tfor int i = 0; i < arr.length; i += 1 {\n";
+		code += "\t\t\tb += arr[i];\n";
+		code += "\t\t}\n";
+	}
+	code += "\t\treturn b;\n";
+	code += "\t}\n\n";
+}
+
+static void gen_file(std::string& code, const nyla::project_options& options, u32 file_index) {
+	u32 first_import = file_index - std::min(file_index, options.import_fan_out);
+	for (u32 j = first_import; j < file_index; j++) {
+		code += "import lib.F" + std::to_string(j) + ";\n";
+	}
+	code += "\n";
+
+	for (u32 m = 0; m < options.modules_per_file; m++) {
+		code += "module " + get_module_name(file_index, m) + " {\n";
+		for (u32 k = 0; k < options.functions_per_module; k++) {
+			gen_function(code, options, k, file_index * 7919 + m * 104729 + k * 31);
+		}
+
+		// Calls every function so that all of the code is
+		// reached from the main function
+		std::vector<std::string> calls;
+		for (u32 k = 0; k < options.functions_per_module; k++) {
+			calls.push_back("f" + std::to_string(k) + "(" + std::to_string(k) + ")");
+		}
+		if (m == 0) {
+			for (u32 other = 1; other < options.modules_per_file; other++) {
+				calls.push_back(get_module_name(file_index, other) + ".g()");
+			}
+			for (u32 j = first_import; j < file_index; j++) {
+				calls.push_back(get_module_name(j, 0) + ".g()");
+			}
+		}
+		code += "\tstatic int g() {\n";
+		code += "\t\treturn " + sum_calls(calls) + ";\n";
+		code += "\t}\n";
+		code += "}\n\n";
+	}
+}
+
+static bool write_project_file(const std::string& path, const std::string& code,
+	                           nyla::generated_project& project) {
+	if (!nyla::write_file(path, code.data(), code.size())) {
+		return false;
+	}
+	project.paths.push_back(path);
+	project.num_lines += std::count(code.begin(), code.end(), '\n');
+	project.num_bytes += code.size();
+	return true;
+}
+
+std::string nyla::get_project_name(const project_options& options) {
+	return "project_f"  + std::to_string(options.num_files) +
+		   "_m"  + std::to_string(options.modules_per_file) +
+		   "_fn" + std::to_string(options.functions_per_module) +
+		   "_i"  + std::to_string(options.import_fan_out) +
+		   "_d"  + std::to_string(options.expression_depth) +
+		   "_a"  + std::to_string(options.array_literal_size);
+}
+
+bool nyla::generate_project(const std::string& parent_directory,
+	                        const project_options& options,
+	                        generated_project& project) {
+	project.directory = parent_directory + "/" + get_project_name(options);
+	if (!nyla::create_directory(parent_directory) ||
+		!nyla::create_directory(project.directory) ||
+		!nyla::create_directory(project.directory + "/lib")) {
+		return false;
+	}
+
+	for (u32 i = 0; i < options.num_files; i++) {
+		std::string code;
+		gen_file(code, options, i);
+		if (!write_project_file(project.directory + "/lib/F" + std::to_string(i) + ".nyla", code, project)) {
+			return false;
+		}
+	}
+
+	// The main file only calls into the last files since
+	// those reach every file before them
+	std::string code;
+	u32 first_import = options.num_files - std::min(options.num_files, std::max(options.import_fan_out, 1u));
+	std::vector<std::string> calls;
+	for (u32 j = first_import; j < options.num_files; j++) {
+		code += "import lib.F" + std::to_string(j) + ";\n";
+		calls.push_back(get_module_name(j, 0) + ".g()");
+	}
+	code += "\nmodule Main {\n";
+	code += "\tstatic int main() {\n";
+	// The program is compiled but never run
+	code += "\t\treturn (" + sum_calls(calls) + ") & 0;\n";
+	code += "\t}\n";
+	code += "}\n";
+	return write_project_file(project.directory + "/Main.nyla", code, project);
+}
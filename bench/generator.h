@@ -0,0 +1,50 @@
+#ifndef NYLA_GENERATOR_H
+#define NYLA_GENERATOR_H
+
+#include <string>
+#include <vector>
+
+#include "types_ext.h"
+
+namespace nyla {
+
+	/*
+	 * Size and shape of a generated project. The project has
+	 * a Main.nyla file along with num_files files in a lib
+	 * directory. Each file imports the import_fan_out files
+	 * before it so every file is reached from the main function.
+	 */
+	struct project_options {
+		u32 num_files            = 100;
+		u32 modules_per_file     = 2;
+		u32 functions_per_module = 10;
+		u32 import_fan_out       = 4;
+		// How deeply the arithmetic expressions nest
+		u32 expression_depth     = 4;
+		// Number of elements of the array literal in each function
+		u32 array_literal_size   = 8;
+	};
+
+	struct generated_project {
+		// Directory the project was written to
+		std::string              directory;
+		// System paths of every file of the project
+		std::vector<std::string> paths;
+		u64                      num_lines = 0;
+		u64                      num_bytes = 0;
+	};
+
+	// Name of the directory a project is generated into so that
+	// projects with different options do not share files
+	std::string get_project_name(const project_options& options);
+
+	// Writes the project into a directory within parent_directory.
+	// The same options always produce the same files. Returns false
+	// if the files could not be written
+	bool generate_project(const std::string& parent_directory,
+		                  const project_options& options,
+		                  generated_project& project);
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+#include "server.h"
+
+#include <iostream>
+
+// Thin client which sends its arguments to a compile
+// server started with nylac -server. It does not link
+// against the compiler so it starts instantly
+int main(int argc, char* argv[]) {
+
+	std::string socket_path = nyla::get_default_server_socket_path();
+	int args_start = 1;
+	if (argc > 1 && std::string(argv[1]).compare(0, 8, "-server=") == 0) {
+		socket_path = std::string(argv[1]).substr(8);
+		++args_start;
+	}
+
+	std::vector<std::string> args(argv + args_start, argv + argc);
+
+	s32 exit_code;
+	if (!nyla::send_server_request(socket_path, args, exit_code)) {
+		std::cerr << "Failed to reach the compile server at: " << socket_path << '\n';
+		std::cerr << "Start it with: nylac -server=" << socket_path << '\n';
+		return 1;
+	}
+	return exit_code;
+}
@@ -1,10 +1,17 @@
 #include "compiler.h"
 #include "utils.h"
+#include "server.h"
+#include "watcher.h"
 
 #include <iostream>
+#include <cstdlib>
+#include <cctype>
+#include <llvm/Support/raw_ostream.h>
 
 const char* usage =
 R"(Usage: nylac <options> !entry=<file> <source directories>
+       nylac -server[=<socket>]
+       nylac -watch <options> !entry=<file> <source directories>
 Possible Options:
   -name=<name>
       Sets the name of the generated executable
@@ -14,45 +21,186 @@ Possible Options:
       Displays the stages for the files
   -display.times
       Displays how long different stages took
+  -display.memory
+      Displays the memory used after each stage of each file,
+      what is released when a file is unloaded and the peak
+      memory used
+  -trace=<file.json>
+      Writes the time spent on every file, stage, function and
+      LLVM pass as a Chrome trace. Viewed with chrome://tracing
+      or Perfetto
+  -emit.deps=<file.d>
+      Writes a Make style dependency file of every source file
+      the executable is built from for build systems like ninja
+  -emit.graph=<file.dot|file.json>
+      Writes the imports between the files the executable is built
+      from. Written as JSON for .json files and as DOT otherwise
+  -jobs=<count>
+      Processes the source files on <count> threads
+  -run
+      Compiles the program in memory and runs it instead of
+      writing an executable. Exits with the program's exit code
+  -O0 -O1 -O2 -O3 -Os
+      Sets the optimization level of the generated code
+  -lto=<thin|full>
+      Optimizes across files when linking. thin imports functions
+      across files in parallel. full merges every file into one
+  -target.cpu=<name|native>
+      Generates code for the CPU. native uses the CPU of this machine
+  -target.features=<features>
+      Enables or disables CPU features. Ex. +avx2,+fma,-sse4a
+  -code.model=<small|kernel|medium|large>
+      Sets the code model of the generated code
+  -reloc.model=<static|pic|dynamic-no-pic>
+      Sets the relocation model. static links a non-PIC executable
+  -interface.dir=<dir>
+      Writes the interfaces of analyzed files into <dir>. Files
+      which have not changed are loaded from their interface
+      instead of being parsed and analyzed if they are not compiled.
+      With -cache.dir, -server and -watch also load compiled files
+      from their interface when their object code is cached
+  -cache.dir=<dir>
+      Keeps the object code of compiled files in <dir>. Files are
+      not compiled again while they and the files they depend on,
+      the options, the target and the functions the program calls
+      in them stay the same
+  -server[=<socket>]
+      Runs a compile server which keeps unchanged files parsed,
+      analyzed and compiled between requests. Requests are sent
+      by nylac-client with the same arguments given to nylac.
+      The socket defaults to /tmp/nylac-<uid>.sock. Kept files
+      generate every function since later requests may call them
+  -watch
+      Stays running and compiles again whenever a file in the
+      source directories changes. Only the changed files and the
+      files which import them are processed again. Every function
+      is generated since later changes may call them
 )";
 
-int main(int argc, char* argv[]) {
-
-	nyla::compiler compiler;
+// Compiles the program based on the arguments. Returns
+// the exit code of nylac
+static int run_compiler(nyla::compiler& compiler, const std::vector<std::string>& args) {
 
 	std::vector<std::string> src_directories;
 	std::vector<std::string> options;
-	int options_count = 1;
-	while (options_count < argc) {
-		if (argv[options_count][0] == '-') {
-			options.push_back(std::string(argv[options_count]).substr(1));
+	ulen options_count = 0;
+	while (options_count < args.size()) {
+		if (args[options_count][0] == '-') {
+			options.push_back(args[options_count].substr(1));
 			++options_count;
 		} else {
 			break;
 		}
 	}
 
+	// The compiler may be used for more than one compile
+	// so every option is set
+	compiler.set_executable_name("program.exe");
+	compiler.set_num_jobs(1);
+	compiler.set_interface_directory("");
+	compiler.set_object_cache_directory("");
+	compiler.set_trace_file("");
+	compiler.set_deps_file("");
+	compiler.set_graph_file("");
+
 	u32 flags = nyla::COMPFLAGS_FULL_COMPILATION;
+	nyla::target_options target_options;
 	for (const std::string& option : options) {
 		if (nyla::string_starts_with(option, std::string("name="))) {
 			std::string exe_name = option.substr(option.find('=') + 1);
 			compiler.set_executable_name(exe_name);
+		} else if (nyla::string_starts_with(option, std::string("jobs="))) {
+			// Parsed without exceptions so a bad request
+			// cannot bring down the server
+			std::string num_jobs = option.substr(option.find('=') + 1);
+			char* num_jobs_end;
+			unsigned long jobs = strtoul(num_jobs.c_str(), &num_jobs_end, 10);
+			if (num_jobs.empty() || *num_jobs_end != '\0' || !isdigit(num_jobs[0])) {
+				std::cout << "Unknown option: " << option << '\n';
+				return 1;
+			}
+			compiler.set_num_jobs((u32) jobs);
+		} else if (nyla::string_starts_with(option, std::string("interface.dir="))) {
+			compiler.set_interface_directory(option.substr(option.find('=') + 1));
+		} else if (nyla::string_starts_with(option, std::string("cache.dir="))) {
+			compiler.set_object_cache_directory(option.substr(option.find('=') + 1));
+		} else if (nyla::string_starts_with(option, std::string("trace="))) {
+			compiler.set_trace_file(option.substr(option.find('=') + 1));
+		} else if (nyla::string_starts_with(option, std::string("emit.deps="))) {
+			compiler.set_deps_file(option.substr(option.find('=') + 1));
+		} else if (nyla::string_starts_with(option, std::string("emit.graph="))) {
+			compiler.set_graph_file(option.substr(option.find('=') + 1));
+		} else if (nyla::string_starts_with(option, std::string("lto="))) {
+			std::string lto_mode = option.substr(option.find('=') + 1);
+			if (lto_mode == "thin") {
+				flags = (flags & ~nyla::COMPFLAGS_LTO) | nyla::COMPFLAG_LTO_THIN;
+			} else if (lto_mode == "full") {
+				flags = (flags & ~nyla::COMPFLAGS_LTO) | nyla::COMPFLAG_LTO_FULL;
+			} else {
+				std::cout << "Unknown LTO mode: " << lto_mode << '\n';
+				return 1;
+			}
+		} else if (nyla::string_starts_with(option, std::string("target.cpu="))) {
+			target_options.cpu = option.substr(option.find('=') + 1);
+		} else if (nyla::string_starts_with(option, std::string("target.features="))) {
+			target_options.features = option.substr(option.find('=') + 1);
+		} else if (nyla::string_starts_with(option, std::string("code.model="))) {
+			std::string code_model = option.substr(option.find('=') + 1);
+			if (code_model == "small") {
+				target_options.code_model = llvm::CodeModel::Small;
+			} else if (code_model == "kernel") {
+				target_options.code_model = llvm::CodeModel::Kernel;
+			} else if (code_model == "medium") {
+				target_options.code_model = llvm::CodeModel::Medium;
+			} else if (code_model == "large") {
+				target_options.code_model = llvm::CodeModel::Large;
+			} else {
+				std::cout << "Unknown code model: " << code_model << '\n';
+				return 1;
+			}
+		} else if (nyla::string_starts_with(option, std::string("reloc.model="))) {
+			std::string reloc_model = option.substr(option.find('=') + 1);
+			if (reloc_model == "static") {
+				target_options.reloc_model = llvm::Reloc::Static;
+			} else if (reloc_model == "pic") {
+				target_options.reloc_model = llvm::Reloc::PIC_;
+			} else if (reloc_model == "dynamic-no-pic") {
+				target_options.reloc_model = llvm::Reloc::DynamicNoPIC;
+			} else {
+				std::cout << "Unknown relocation model: " << reloc_model << '\n';
+				return 1;
+			}
 		} else if (option == "display.llvm.ir") {
 			flags |= nyla::COMPFLAG_DISPLAY_LLVM_IR;
 		} else if (option == "display.stages") {
 			flags |= nyla::COMPFLAG_DISPLAY_STAGES;
 		} else if (option == "display.times") {
 			flags |= nyla::COMPFLAG_DISPLAY_TIMES;
+		} else if (option == "display.memory") {
+			flags |= nyla::COMPFLAG_DISPLAY_MEMORY;
+		} else if (option == "run") {
+			flags |= nyla::COMPFLAG_RUN;
+		} else if (option == "O0") {
+			flags &= ~nyla::COMPFLAGS_OPT_LEVEL;
+		} else if (option == "O1") {
+			flags = (flags & ~nyla::COMPFLAGS_OPT_LEVEL) | nyla::COMPFLAG_OPT_O1;
+		} else if (option == "O2") {
+			flags = (flags & ~nyla::COMPFLAGS_OPT_LEVEL) | nyla::COMPFLAG_OPT_O2;
+		} else if (option == "O3") {
+			flags = (flags & ~nyla::COMPFLAGS_OPT_LEVEL) | nyla::COMPFLAG_OPT_O3;
+		} else if (option == "Os") {
+			flags = (flags & ~nyla::COMPFLAGS_OPT_LEVEL) | nyla::COMPFLAG_OPT_Os;
 		} else {
 			std::cout << "Unknown option: " << option << '\n';
 			return 1;
 		}
 	}
 	compiler.set_flags(flags);
+	compiler.set_target_options(target_options);
 
 	std::string file_with_main;
-	if (options_count < argc) {
-		std::string main_arg = std::string(argv[options_count]);
+	if (options_count < args.size()) {
+		const std::string& main_arg = args[options_count];
 		if (nyla::string_starts_with(main_arg, std::string("!entry="))) {
 			file_with_main = main_arg.substr(main_arg.find('=') + 1);
 		} else {
@@ -65,8 +213,8 @@ int main(int argc, char* argv[]) {
 		return 1;
 	}
 
-	for (int i = options_count; i < argc; i++) {
-		src_directories.push_back(argv[i]);
+	for (ulen i = options_count; i < args.size(); i++) {
+		src_directories.push_back(args[i]);
 	}
 
 	if (src_directories.empty()) {
@@ -76,5 +224,76 @@ int main(int argc, char* argv[]) {
 
 	compiler.compile(src_directories, file_with_main);
 	
+	// The program did not run if it failed to compile
+	if (compiler.get_found_compilation_errors()) {
+		return 1;
+	}
+	if (flags & nyla::COMPFLAG_RUN) {
+		return compiler.get_run_exit_code();
+	}
 	return 0;
+}
+
+int main(int argc, char* argv[]) {
+
+	std::vector<std::string> args(argv + 1, argv + argc);
+
+	if (!args.empty() && (args[0] == "-server" ||
+		                  nyla::string_starts_with(args[0], std::string("-server=")))) {
+		std::string socket_path = nyla::get_default_server_socket_path();
+		if (args[0] != "-server") {
+			socket_path = args[0].substr(args[0].find('=') + 1);
+		}
+
+		nyla::compiler compiler;
+		compiler.set_reuse_sym_tables(true);
+		bool listened = nyla::run_server(socket_path, [&compiler](const std::vector<std::string>& args) {
+			int exit_code = run_compiler(compiler, args);
+			llvm::outs().flush();
+			llvm::errs().flush();
+			return exit_code;
+		});
+		return listened ? 0 : 1;
+	}
+
+	if (!args.empty() && args[0] == "-watch") {
+		args.erase(args.begin());
+
+		// The source directories come after the entry
+		std::vector<std::string> src_directories;
+		for (ulen i = 0; i < args.size(); i++) {
+			if (nyla::string_starts_with(args[i], std::string("!entry="))) {
+				src_directories.assign(args.begin() + i + 1, args.end());
+				break;
+			}
+		}
+
+		if (src_directories.empty()) {
+			std::cout << usage;
+			return 1;
+		}
+
+		nyla::compiler compiler;
+		compiler.set_reuse_sym_tables(true);
+		nyla::file_watcher watcher;
+		if (!watcher.watch(src_directories)) {
+			return 1;
+		}
+		while (true) {
+			u64 compile_st = nyla::get_time_in_milliseconds();
+			int exit_code = run_compiler(compiler, args);
+			u64 compile_time = nyla::get_time_in_milliseconds() - compile_st;
+			std::cout << "-- Finished in " << compile_time << " ms with exit code "
+				      << exit_code << ". Watching for changes\n";
+			std::cout.flush();
+
+			nyla::source_changes changes;
+			if (watcher.wait_for_changes(changes)) {
+				compiler.set_source_changes(changes);
+			}
+		}
+	}
+
+	nyla::compiler compiler;
+	return run_compiler(compiler, args);
 }
\ No newline at end of file
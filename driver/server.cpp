@@ -0,0 +1,269 @@
+#include "server.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __unix__
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#ifdef __unix__
+
+// A request is the length of the payload sent along with the
+// client's stdout and stderr followed by the payload. The payload
+// is the working directory and then the arguments, each as a length
+// followed by the characters. The reply is the exit code
+
+static bool write_all(int fd, const void* data, ulen size) {
+	const c8* bytes = (const c8*)data;
+	while (size > 0) {
+		ssize_t written = send(fd, bytes, size, MSG_NOSIGNAL);
+		if (written <= 0) return false;
+		bytes += written;
+		size  -= written;
+	}
+	return true;
+}
+
+static bool read_all(int fd, void* data, ulen size) {
+	c8* bytes = (c8*)data;
+	while (size > 0) {
+		ssize_t num_read = recv(fd, bytes, size, 0);
+		if (num_read <= 0) return false;
+		bytes += num_read;
+		size  -= num_read;
+	}
+	return true;
+}
+
+static bool fill_socket_address(const std::string& socket_path, sockaddr_un& address) {
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path)) {
+		std::cerr << "Socket path is too long: " << socket_path << '\n';
+		return false;
+	}
+	strcpy(address.sun_path, socket_path.c_str());
+	return true;
+}
+
+// Receives the length of the payload and the client's stdout and stderr
+static bool receive_header(int connection, u32& payload_size, int& out_fd, int& err_fd) {
+	iovec io;
+	io.iov_base = &payload_size;
+	io.iov_len  = sizeof(payload_size);
+
+	union {
+		cmsghdr header;
+		c8      buffer[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov        = &io;
+	message.msg_iovlen     = 1;
+	message.msg_control    = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+	if (recvmsg(connection, &message, MSG_WAITALL) != sizeof(payload_size)) {
+		return false;
+	}
+
+	cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+	if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+		cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+		return false;
+	}
+	int fds[2];
+	memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+	out_fd = fds[0];
+	err_fd = fds[1];
+	return true;
+}
+
+static bool receive_payload(int connection, u32 payload_size, std::vector<std::string>& strings) {
+	std::string payload(payload_size, '\0');
+	if (!read_all(connection, &payload[0], payload_size)) {
+		return false;
+	}
+	ulen offset = 0;
+	while (offset < payload.size()) {
+		u32 length;
+		if (payload.size() - offset < sizeof(length)) return false;
+		memcpy(&length, &payload[offset], sizeof(length));
+		offset += sizeof(length);
+		if (payload.size() - offset < length) return false;
+		strings.push_back(payload.substr(offset, length));
+		offset += length;
+	}
+	return !strings.empty();
+}
+
+static void handle_connection(int connection, const nyla::server_request_handler& handle_request) {
+	u32 payload_size;
+	int out_fd, err_fd;
+	if (!receive_header(connection, payload_size, out_fd, err_fd)) {
+		return;
+	}
+
+	std::vector<std::string> strings;
+	if (!receive_payload(connection, payload_size, strings) ||
+		chdir(strings[0].c_str()) != 0) {
+		close(out_fd);
+		close(err_fd);
+		return;
+	}
+	std::vector<std::string> args(strings.begin() + 1, strings.end());
+
+	// Writing to the client's stdout and stderr
+	// while the request is handled
+	fflush(stdout);
+	fflush(stderr);
+	int server_out_fd = dup(STDOUT_FILENO);
+	int server_err_fd = dup(STDERR_FILENO);
+	dup2(out_fd, STDOUT_FILENO);
+	dup2(err_fd, STDERR_FILENO);
+	close(out_fd);
+	close(err_fd);
+
+	s32 exit_code = handle_request(args);
+
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(stdout);
+	fflush(stderr);
+	dup2(server_out_fd, STDOUT_FILENO);
+	dup2(server_err_fd, STDERR_FILENO);
+	close(server_out_fd);
+	close(server_err_fd);
+
+	write_all(connection, &exit_code, sizeof(exit_code));
+}
+
+std::string nyla::get_default_server_socket_path() {
+	return "/tmp/nylac-" + std::to_string(getuid()) + ".sock";
+}
+
+bool nyla::run_server(const std::string& socket_path, const server_request_handler& handle_request) {
+	sockaddr_un address;
+	if (!fill_socket_address(socket_path, address)) {
+		return false;
+	}
+
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server < 0) {
+		std::cerr << "Failed to create the server socket\n";
+		return false;
+	}
+
+	// Removing the socket left behind by a previous server
+	unlink(socket_path.c_str());
+	if (bind(server, (sockaddr*)&address, sizeof(address)) != 0 || listen(server, 16) != 0) {
+		std::cerr << "Failed to listen on: " << socket_path << '\n';
+		close(server);
+		return false;
+	}
+
+	// A client going away should not take down the server
+	signal(SIGPIPE, SIG_IGN);
+
+	std::cout << "-- Listening on: " << socket_path << std::endl;
+	while (true) {
+		int connection = accept(server, nullptr, nullptr);
+		if (connection < 0) continue;
+		handle_connection(connection, handle_request);
+		close(connection);
+	}
+}
+
+bool nyla::send_server_request(const std::string& socket_path,
+	                           const std::vector<std::string>& args,
+	                           s32& exit_code) {
+	sockaddr_un address;
+	if (!fill_socket_address(socket_path, address)) {
+		return false;
+	}
+
+	int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (connection < 0) {
+		return false;
+	}
+	if (connect(connection, (sockaddr*)&address, sizeof(address)) != 0) {
+		close(connection);
+		return false;
+	}
+
+	c8* cwd = getcwd(nullptr, 0);
+	if (!cwd) {
+		close(connection);
+		return false;
+	}
+	std::vector<std::string> strings;
+	strings.push_back(cwd);
+	free(cwd);
+	strings.insert(strings.end(), args.begin(), args.end());
+
+	std::string payload;
+	for (const std::string& string : strings) {
+		u32 length = string.size();
+		payload.append((const c8*)&length, sizeof(length));
+		payload.append(string);
+	}
+	u32 payload_size = payload.size();
+
+	iovec io;
+	io.iov_base = &payload_size;
+	io.iov_len  = sizeof(payload_size);
+
+	union {
+		cmsghdr header;
+		c8      buffer[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+	memset(&control, 0, sizeof(control));
+
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov        = &io;
+	message.msg_iovlen     = 1;
+	message.msg_control    = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+	cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type  = SCM_RIGHTS;
+	cmsg->cmsg_len   = CMSG_LEN(2 * sizeof(int));
+	int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	fflush(stdout);
+	fflush(stderr);
+	bool sent = sendmsg(connection, &message, MSG_NOSIGNAL) == sizeof(payload_size) &&
+		        write_all(connection, payload.data(), payload.size());
+	bool replied = sent && read_all(connection, &exit_code, sizeof(exit_code));
+	close(connection);
+	return replied;
+}
+
+#else
+
+std::string nyla::get_default_server_socket_path() {
+	return "";
+}
+
+bool nyla::run_server(const std::string& socket_path, const server_request_handler& handle_request) {
+	std::cerr << "The compile server is only supported on unix\n";
+	return false;
+}
+
+bool nyla::send_server_request(const std::string& socket_path,
+	                           const std::vector<std::string>& args,
+	                           s32& exit_code) {
+	return false;
+}
+
+#endif
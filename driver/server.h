@@ -0,0 +1,40 @@
+#ifndef NYLA_SERVER_H
+#define NYLA_SERVER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "types_ext.h"
+
+namespace nyla {
+
+	// Handles the arguments of a request and returns
+	// the exit code sent back to the client
+	using server_request_handler = std::function<s32(const std::vector<std::string>& args)>;
+
+	// Socket used when no socket path is given
+	std::string get_default_server_socket_path();
+
+	/*
+	 * Listens on a unix socket and handles the requests of
+	 * clients one at a time. While a request is handled the
+	 * server's stdout and stderr are the client's and the
+	 * working directory is the client's.
+	 *
+	 * Returns false if the socket could not be created.
+	 * Otherwise it never returns.
+	 */
+	bool run_server(const std::string& socket_path, const server_request_handler& handle_request);
+
+	// Sends the arguments to the server along with the
+	// working directory, stdout and stderr of this process
+	// and waits for the exit code. Returns false if the
+	// server could not be reached
+	bool send_server_request(const std::string& socket_path,
+		                     const std::vector<std::string>& args,
+		                     s32& exit_code);
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "watcher.h"
+
+#include "utils.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+#ifdef __linux__
+
+// How long to wait for more changes after a change
+// before the changes are handed to the compiler
+static const int settle_time_in_milliseconds = 15;
+
+// The last change to a file within a batch of changes
+// decides how the compiler sees it
+enum change_kind {
+	CHANGE_MODIFIED,
+	CHANGE_CREATED,
+	CHANGE_DELETED,
+};
+
+nyla::file_watcher::~file_watcher() {
+	if (m_inotify_fd != -1) {
+		close(m_inotify_fd);
+	}
+}
+
+bool nyla::file_watcher::watch(const std::vector<std::string>& directories) {
+	m_inotify_fd = inotify_init1(IN_CLOEXEC);
+	if (m_inotify_fd == -1) {
+		std::cerr << "Failed to initialize inotify\n";
+		return false;
+	}
+	for (const std::string& directory : directories) {
+		if (!add_watch(nyla::replace(directory, "\\", "/"))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool nyla::file_watcher::add_watch(const std::string& directory) {
+	int wd = inotify_add_watch(m_inotify_fd, directory.c_str(),
+		                       IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+		                       IN_DELETE_SELF | IN_ONLYDIR);
+	if (wd == -1) {
+		std::cerr << "Failed to watch: " << directory << '\n';
+		return false;
+	}
+	m_directories[wd] = directory;
+
+	std::tuple<std::vector<search_file>, bool> files = nyla::get_directory_files(directory);
+	for (const search_file& search_file : std::get<0>(files)) {
+		if (search_file.is_directory && !add_watch(directory + "/" + search_file.path)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool nyla::file_watcher::wait_for_changes(nyla::source_changes& changes) {
+	std::unordered_map<std::string, change_kind> file_changes;
+	std::unordered_map<std::string, change_kind> directory_changes;
+	bool missed_changes = false;
+
+	alignas(inotify_event) c8 buffer[16 * 1024];
+	int timeout = -1; // Waiting as long as it takes for the first change
+	while (true) {
+		pollfd poll_fd = { m_inotify_fd, POLLIN, 0 };
+		int ready = poll(&poll_fd, 1, timeout);
+		if (ready == 0) {
+			break; // Settled
+		}
+		if (ready < 0) {
+			continue; // Interrupted
+		}
+
+		ssize_t length = read(m_inotify_fd, buffer, sizeof(buffer));
+		if (length <= 0) continue;
+
+		for (c8* ptr = buffer; ptr < buffer + length;) {
+			const inotify_event* event = (const inotify_event*)ptr;
+			ptr += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				missed_changes = true;
+				continue;
+			}
+			if (event->mask & IN_IGNORED) {
+				m_directories.erase(event->wd);
+				continue;
+			}
+
+			auto it = m_directories.find(event->wd);
+			if (it == m_directories.end() || event->len == 0) continue;
+			std::string path = it->second + "/" + event->name;
+
+			if (event->mask & IN_ISDIR) {
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					directory_changes[path] = CHANGE_CREATED;
+					add_watch(path);
+				} else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+					directory_changes[path] = CHANGE_DELETED;
+				}
+				timeout = settle_time_in_milliseconds;
+				continue;
+			}
+
+			if (!nyla::string_ends_with(path, std::string(".nyla"))) continue;
+			if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+				file_changes[path] = CHANGE_CREATED;
+			} else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+				file_changes[path] = CHANGE_DELETED;
+			} else if (event->mask & IN_CLOSE_WRITE) {
+				auto file_it = file_changes.find(path);
+				if (file_it == file_changes.end()) {
+					file_changes[path] = CHANGE_MODIFIED;
+				} else if (file_it->second == CHANGE_DELETED) {
+					file_changes[path] = CHANGE_CREATED;
+				}
+			}
+			timeout = settle_time_in_milliseconds;
+		}
+	}
+
+	for (auto& pair : file_changes) {
+		switch (pair.second) {
+		case CHANGE_MODIFIED: changes.modified_files.push_back(pair.first); break;
+		case CHANGE_CREATED:  changes.created_files.push_back(pair.first);  break;
+		case CHANGE_DELETED:  changes.deleted_files.push_back(pair.first);  break;
+		}
+	}
+	for (auto& pair : directory_changes) {
+		if (pair.second == CHANGE_CREATED) {
+			changes.created_directories.push_back(pair.first);
+		} else {
+			changes.deleted_directories.push_back(pair.first);
+		}
+	}
+	return !missed_changes;
+}
+
+#else
+
+nyla::file_watcher::~file_watcher() {
+}
+
+bool nyla::file_watcher::watch(const std::vector<std::string>& directories) {
+	std::cerr << "Watching for changes is only supported on Linux\n";
+	return false;
+}
+
+bool nyla::file_watcher::add_watch(const std::string& directory) {
+	return false;
+}
+
+bool nyla::file_watcher::wait_for_changes(nyla::source_changes& changes) {
+	return false;
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef NYLA_WATCHER_H
+#define NYLA_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "compiler.h"
+
+namespace nyla {
+
+	/*
+	 * Watches the source directories, and every directory
+	 * within them, for changes to .nyla files. Uses inotify
+	 * so it is only supported on Linux.
+	 */
+	class file_watcher {
+	public:
+
+		~file_watcher();
+
+		// Returns false if the directories could not be watched
+		bool watch(const std::vector<std::string>& directories);
+
+		// Blocks until a .nyla file or a directory changes. Changes
+		// which happen right after are collected along with it since
+		// editors tend to save files in more than one step. Returns
+		// false if changes were missed so the source directories
+		// have to be searched again
+		bool wait_for_changes(nyla::source_changes& changes);
+
+	private:
+
+		// Watches the directory along with its sub-directories
+		bool add_watch(const std::string& directory);
+
+		int m_inotify_fd = -1;
+
+		// Directory of each watch descriptor
+		std::unordered_map<int, std::string> m_directories;
+
+	};
+
+}
+
+#endif
@@ -7,9 +7,16 @@ inline u32 max(u32 a, u32 b) {
 nyla::analysis::analysis(nyla::compiler& compiler, nyla::log& log,
 	                     nyla::sym_table* sym_table, nyla::afile_unit* file_unit)
 	: m_compiler(compiler), m_log(log), m_sym_table(sym_table),
-	  m_llvm_generator(compiler, new llvm::Module("JIT module", *llvm_context), nullptr, false),
+	  m_context(compiler.get_context()),
+	  m_types(m_context.get_builtin_types()),
+	  m_reserved_words(m_context.get_reserved_words()),
+	  m_llvm_module(new llvm::Module("JIT module", m_llvm_context)),
+	  m_llvm_generator(compiler, m_llvm_module, nullptr, false),
       m_file_unit(file_unit) {
-	// TODO: clean up JIT module
+}
+
+nyla::analysis::~analysis() {
+	delete m_llvm_module;
 }
 
 void nyla::analysis::check_file_unit() {
@@ -84,10 +91,10 @@ void nyla::analysis::check_expression(nyla::aexpr* expr) {
 		check_number(dynamic_cast<nyla::anumber*>(expr));
 		break;
 	case AST_VALUE_BOOL:
-		expr->type = nyla::types::type_bool;
+		expr->type = m_types.type_bool;
 		break;
 	case AST_VALUE_NULL:
-		expr->type = nyla::types::type_null;
+		expr->type = m_types.type_null;
 		break;
 	case AST_BINARY_OP:
 		check_binary_op(dynamic_cast<nyla::abinary_op*>(expr));
@@ -118,7 +125,7 @@ void nyla::analysis::check_expression(nyla::aexpr* expr) {
 	case AST_STRING8:
 	case AST_STRING16:
 	case AST_STRING32:
-		expr->type = nyla::types::type_string;
+		expr->type = m_types.type_string;
 		break;
 	case AST_FUNCTION_CALL: {
 		bool static_context = true;
@@ -151,7 +158,7 @@ void nyla::analysis::check_expression(nyla::aexpr* expr) {
 		break;
 	case AST_THIS:
 		m_log.err(ERR_THIS_KEYWORD_EXPECTS_DOT_OP, expr);
-		expr->type = nyla::types::type_error;
+		expr->type = m_types.type_error;
 		break;
 	case AST_IF:
 		check_if(dynamic_cast<nyla::aif*>(expr));
@@ -165,7 +172,7 @@ void nyla::analysis::check_expression(nyla::aexpr* expr) {
 void nyla::analysis::check_function(nyla::afunction* function) {
 	function->literal_constant = function->sym_function->mods & MOD_COMPTIME;
 
-	if (function->is_external() && function->name_key == nyla::memcpy_ident) {
+	if (function->is_external() && function->name_key == m_reserved_words.memcpy_ident) {
 		function->sym_function->is_memcpy = true;
 	}
 
@@ -175,7 +182,7 @@ void nyla::analysis::check_function(nyla::afunction* function) {
 	check_scope(function->stmts, function->comptime_compat);
 	
 	if (!m_sym_scope->found_return) {
-		if (function->return_type == nyla::types::type_void) {
+		if (function->return_type == m_types.type_void) {
 			// Adding a void return
 			nyla::areturn* ret = make<nyla::areturn>(AST_RETURN, function);
 			function->stmts.push_back(ret);
@@ -207,8 +214,8 @@ void nyla::analysis::check_variable_decl(nyla::avariable_decl* variable_decl) {
 			variable_decl->comptime_compat = false;
 		}
 
-		if (variable_decl->assignment->type == nyla::types::type_error) {
-			variable_decl->type = nyla::types::type_error;
+		if (variable_decl->assignment->type == m_types.type_error) {
+			variable_decl->type = m_types.type_error;
 			return;
 		}
 	}
@@ -225,12 +232,12 @@ void nyla::analysis::check_variable_decl(nyla::avariable_decl* variable_decl) {
 			}
 
 			check_expression(arr_dim_size);
-			if (arr_dim_size->type == nyla::types::type_error) {
-				variable_decl->type = nyla::types::type_error;
+			if (arr_dim_size->type == m_types.type_error) {
+				variable_decl->type = m_types.type_error;
 				return;
 			}
 			if (!arr_dim_size->type->is_int()) {
-				variable_decl->type = nyla::types::type_error;
+				variable_decl->type = m_types.type_error;
 				return;
 			}
 
@@ -250,7 +257,7 @@ void nyla::analysis::check_variable_decl(nyla::avariable_decl* variable_decl) {
 			// TODO: All of this will need to be moved to the comptime section since
 			// the computed arr size information will not be present until then
 			nyla::abinary_op* assignment = dynamic_cast<nyla::abinary_op*>(variable_decl->assignment);
-			if (assignment->rhs->tag == AST_ARRAY || assignment->rhs->type == nyla::types::type_string) {
+			if (assignment->rhs->tag == AST_ARRAY || assignment->rhs->type == m_types.type_string) {
 
 				bool sizes_match;
 				if (assignment->rhs->tag == AST_ARRAY) {
@@ -261,7 +268,7 @@ void nyla::analysis::check_variable_decl(nyla::avariable_decl* variable_decl) {
 					sizes_match = compare_arr_size(str, variable_decl->sym_variable->computed_arr_dim_sizes);
 				}
 				if (!sizes_match) {
-					variable_decl->type = nyla::types::type_error;
+					variable_decl->type = m_types.type_error;
 					return;
 				}
 			}
@@ -294,7 +301,7 @@ void nyla::analysis::check_return(nyla::areturn* ret) {
 	m_sym_scope->found_return = true;
 	if (ret->value) {
 		check_expression(ret->value);
-		if (ret->value->type == nyla::types::type_error) {
+		if (ret->value->type == m_types.type_error) {
 			return;
 		}
 		if (!ret->value->comptime_compat) {
@@ -308,7 +315,7 @@ void nyla::analysis::check_return(nyla::areturn* ret) {
 				      ret);
 		}
 	} else {
-		if (m_function->return_type != nyla::types::type_void) {
+		if (m_function->return_type != m_types.type_void) {
 			m_log.err(ERR_FUNCTION_EXPECTS_RETURN_VALUE, ret);
 		}
 	}
@@ -316,19 +323,19 @@ void nyla::analysis::check_return(nyla::areturn* ret) {
 
 void nyla::analysis::check_number(nyla::anumber* number) {
 	switch (number->tag) {
-	case AST_VALUE_BYTE:   number->type = nyla::types::type_byte;   break;
-	case AST_VALUE_SHORT:  number->type = nyla::types::type_short;  break;
-	case AST_VALUE_INT:    number->type = nyla::types::type_int;    break;
-	case AST_VALUE_LONG:   number->type = nyla::types::type_long;   break;
-	case AST_VALUE_UBYTE:  number->type = nyla::types::type_ubyte;  break;
-	case AST_VALUE_USHORT: number->type = nyla::types::type_ushort; break;
-	case AST_VALUE_UINT:   number->type = nyla::types::type_uint;   break;
-	case AST_VALUE_ULONG:  number->type = nyla::types::type_ulong;  break;
-	case AST_VALUE_FLOAT:  number->type = nyla::types::type_float;  break;
-	case AST_VALUE_DOUBLE: number->type = nyla::types::type_double; break;
-	case AST_VALUE_CHAR8:  number->type = nyla::types::type_char8;  break;
-	case AST_VALUE_CHAR16: number->type = nyla::types::type_char16; break;
-	case AST_VALUE_CHAR32: number->type = nyla::types::type_char32; break;
+	case AST_VALUE_BYTE:   number->type = m_types.type_byte;   break;
+	case AST_VALUE_SHORT:  number->type = m_types.type_short;  break;
+	case AST_VALUE_INT:    number->type = m_types.type_int;    break;
+	case AST_VALUE_LONG:   number->type = m_types.type_long;   break;
+	case AST_VALUE_UBYTE:  number->type = m_types.type_ubyte;  break;
+	case AST_VALUE_USHORT: number->type = m_types.type_ushort; break;
+	case AST_VALUE_UINT:   number->type = m_types.type_uint;   break;
+	case AST_VALUE_ULONG:  number->type = m_types.type_ulong;  break;
+	case AST_VALUE_FLOAT:  number->type = m_types.type_float;  break;
+	case AST_VALUE_DOUBLE: number->type = m_types.type_double; break;
+	case AST_VALUE_CHAR8:  number->type = m_types.type_char8;  break;
+	case AST_VALUE_CHAR16: number->type = m_types.type_char16; break;
+	case AST_VALUE_CHAR32: number->type = m_types.type_char32; break;
 	default:
 		assert(!"Haven't implemented type mapping for value.");
 		break;
@@ -343,9 +350,9 @@ void nyla::analysis::check_binary_op(nyla::abinary_op* binary_op) {
 	nyla::type* lhs_type = binary_op->lhs->type;
 	nyla::type* rhs_type = binary_op->rhs->type;
 
-	if (lhs_type == nyla::types::type_error ||
-		rhs_type == nyla::types::type_error) {
-		binary_op->type = nyla::types::type_error;
+	if (lhs_type == m_types.type_error ||
+		rhs_type == m_types.type_error) {
+		binary_op->type = m_types.type_error;
 		return;
 	}
 
@@ -375,21 +382,21 @@ void nyla::analysis::check_binary_op(nyla::abinary_op* binary_op) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				      error_payload::op_cannot_apply({ binary_op->op, lhs_type }),
 				      binary_op);
-			binary_op->type = nyla::types::type_error;
+			binary_op->type = m_types.type_error;
 			return;
 		}
 		if (!rhs_type->is_number()) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				      error_payload::op_cannot_apply({ binary_op->op, rhs_type }),
 				      binary_op);
-			binary_op->type = nyla::types::type_error;
+			binary_op->type = m_types.type_error;
 			return;
 		}
 		
 		if (lhs_type->is_int() && rhs_type->is_int()) {
 			u32 larger_mem_size = max(lhs_type->mem_size(), rhs_type->mem_size());
 			nyla::type* to_type =
-				nyla::type::get_int(larger_mem_size,
+				m_types.get_int(larger_mem_size,
 					lhs_type->is_signed() || lhs_type->is_signed());
 			binary_op->lhs = make_cast(binary_op->lhs, to_type);
 			binary_op->rhs = make_cast(binary_op->rhs, to_type);
@@ -397,7 +404,7 @@ void nyla::analysis::check_binary_op(nyla::abinary_op* binary_op) {
 		} else {
 			// At least one float
 			u32 larger_mem_size = max(lhs_type->mem_size(), rhs_type->mem_size());
-			nyla::type* to_type = nyla::type::get_float(larger_mem_size);
+			nyla::type* to_type = m_types.get_float(larger_mem_size);
 			binary_op->lhs = make_cast(binary_op->lhs, to_type);
 			binary_op->rhs = make_cast(binary_op->rhs, to_type);
 			binary_op->type = to_type;
@@ -412,20 +419,20 @@ void nyla::analysis::check_binary_op(nyla::abinary_op* binary_op) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				error_payload::op_cannot_apply({ binary_op->op, lhs_type }),
 				binary_op);
-			binary_op->type = nyla::types::type_error;
+			binary_op->type = m_types.type_error;
 			return;
 		}
 		if (!rhs_type->is_int()) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				error_payload::op_cannot_apply({ binary_op->op, rhs_type }),
 				binary_op);
-			binary_op->type = nyla::types::type_error;
+			binary_op->type = m_types.type_error;
 			return;
 		}
 
 		u32 larger_mem_size = max(lhs_type->mem_size(), rhs_type->mem_size());
 		nyla::type* to_type =
-			nyla::type::get_int(larger_mem_size,
+			m_types.get_int(larger_mem_size,
 				lhs_type->is_signed() || lhs_type->is_signed());
 		binary_op->lhs = make_cast(binary_op->lhs, to_type);
 		binary_op->rhs = make_cast(binary_op->rhs, to_type);
@@ -438,18 +445,18 @@ void nyla::analysis::check_binary_op(nyla::abinary_op* binary_op) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				error_payload::op_cannot_apply({ binary_op->op, lhs_type }),
 				binary_op);
-			binary_op->type = nyla::types::type_error;
+			binary_op->type = m_types.type_error;
 			return;
 		}
 		if (!rhs_type->is_number()) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				error_payload::op_cannot_apply({ binary_op->op, rhs_type }),
 				binary_op);
-			binary_op->type = nyla::types::type_error;
+			binary_op->type = m_types.type_error;
 			return;
 		}
 
-		binary_op->type = nyla::types::type_bool;
+		binary_op->type = m_types.type_bool;
 		break;
 	}
 	case TK_AMP_AMP: case TK_BAR_BAR: {
@@ -457,18 +464,18 @@ void nyla::analysis::check_binary_op(nyla::abinary_op* binary_op) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				error_payload::op_cannot_apply({ binary_op->op, lhs_type }),
 				binary_op);
-			binary_op->type = nyla::types::type_error;
+			binary_op->type = m_types.type_error;
 			return;
 		}
 		if (rhs_type->tag != TYPE_BOOL) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				error_payload::op_cannot_apply({ binary_op->op, rhs_type }),
 				binary_op);
-			binary_op->type = nyla::types::type_error;
+			binary_op->type = m_types.type_error;
 			return;
 		}
 
-		binary_op->type = nyla::types::type_bool;
+		binary_op->type = m_types.type_bool;
 		break;
 	}
 	default: {
@@ -481,8 +488,8 @@ void nyla::analysis::check_binary_op(nyla::abinary_op* binary_op) {
 
 void nyla::analysis::check_unary_op(nyla::aunary_op* unary_op) {
 	check_expression(unary_op->factor);
-	if (unary_op->factor->type == nyla::types::type_error) {
-		unary_op->type = nyla::types::type_error;
+	if (unary_op->factor->type == m_types.type_error) {
+		unary_op->type = m_types.type_error;
 		return;
 	}
 	if (!unary_op->factor->comptime_compat) {
@@ -494,7 +501,7 @@ void nyla::analysis::check_unary_op(nyla::aunary_op* unary_op) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				      error_payload::op_cannot_apply({ unary_op->op, unary_op->factor->type }),
 				      unary_op);
-			unary_op->type = nyla::types::type_error;
+			unary_op->type = m_types.type_error;
 			return;
 		}
 		unary_op->type = unary_op->factor->type;
@@ -506,11 +513,11 @@ void nyla::analysis::check_unary_op(nyla::aunary_op* unary_op) {
 
 		if (!is_lvalue(unary_op->factor)) {
 			// TODO: produce error message
-			unary_op->type = nyla::types::type_error;
+			unary_op->type = m_types.type_error;
 			return;
 		}
 
-		unary_op->type = nyla::type::get_ptr(unary_op->factor->type);
+		unary_op->type = m_context.get_type_table().get_ptr(unary_op->factor->type);
 		unary_op->type->calculate_ptr_depth();
 		break;
 	}
@@ -520,25 +527,25 @@ void nyla::analysis::check_unary_op(nyla::aunary_op* unary_op) {
 			m_log.err(ERR_OP_CANNOT_APPLY_TO,
 				      error_payload::op_cannot_apply({ unary_op->op, unary_op->factor->type }),
 				      unary_op);
-			unary_op->type = nyla::types::type_error;
+			unary_op->type = m_types.type_error;
 			return;
 		}
 		unary_op->type = unary_op->factor->type;
 		break;
 	}
 	case '!': {
-		if (unary_op->factor->type != nyla::types::type_bool) {
+		if (unary_op->factor->type != m_types.type_bool) {
 			// TODO; report error!
-			unary_op->type = nyla::types::type_error;
+			unary_op->type = m_types.type_error;
 			return;
 		}
-		unary_op->type = nyla::types::type_bool;
+		unary_op->type = m_types.type_bool;
 		break;
 	}
 	case '*': {
 		if (!unary_op->factor->type->is_ptr()) {
 			m_log.err(ERR_ATTEMPT_TO_DEREFERENCE_NON_POINTER, unary_op);
-			unary_op->type = nyla::types::type_error;
+			unary_op->type = m_types.type_error;
 			return;
 		}
 
@@ -591,7 +598,7 @@ void nyla::analysis::check_ident(bool static_context, sym_scope* lookup_scope, n
 		m_log.err(ERR_UNDECLARED_VARIABLE,
 			      error_payload::word(ident->ident_key),
 			      ident);
-		ident->type = nyla::types::type_error;
+		ident->type = m_types.type_error;
 	}
 }
 
@@ -600,7 +607,7 @@ void nyla::analysis::check_for_loop(nyla::afor_loop* for_loop) {
 	m_sym_scope = for_loop->sym_scope;
 	for (nyla::avariable_decl* var_decl : for_loop->declarations) {
 		check_expression(var_decl);
-		if (var_decl->type == nyla::types::type_error) return;
+		if (var_decl->type == m_types.type_error) return;
 		if (!var_decl->comptime_compat) {
 			for_loop->comptime_compat = false;
 		}
@@ -618,11 +625,11 @@ void nyla::analysis::check_while_loop(nyla::awhile_loop* while_loop) {
 
 void nyla::analysis::check_loop(nyla::aloop_expr* loop) {
 	check_expression(loop->cond);
-	if (loop->cond->type == nyla::types::type_error) return;
+	if (loop->cond->type == m_types.type_error) return;
 	if (!loop->cond->comptime_compat) {
 		loop->comptime_compat = false;
 	}
-	if (loop->cond->type != nyla::types::type_bool) {
+	if (loop->cond->type != m_types.type_bool) {
 		m_log.err(ERR_EXPECTED_BOOL_COND, loop->cond);
 	}
 	check_scope(loop->body, loop->comptime_compat);
@@ -646,8 +653,8 @@ void nyla::analysis::check_function_call(bool static_call,
 	// Checking types of arguments
 	for (nyla::aexpr* argument : function_call->arguments) {
 		check_expression(argument);
-		if (argument->type == nyla::types::type_error) {
-			function_call->type = nyla::types::type_error;
+		if (argument->type == m_types.type_error) {
+			function_call->type = m_types.type_error;
 			return;
 		}
 		if (!argument->comptime_compat) function_call->comptime_compat = false;
@@ -670,7 +677,7 @@ void nyla::analysis::check_function_call(bool static_call,
 			m_log.err(ERR_COULD_NOT_FIND_FUNCTION,
 				error_payload::function_call(function_call), function_call);
 		}
-		function_call->type = nyla::types::type_error;
+		function_call->type = m_types.type_error;
 		return;
 	}
 
@@ -743,6 +750,14 @@ void nyla::analysis::check_function_call(sym_function* called_function,
 	function_call->type = called_function->return_type;
 	function_call->called_function = called_function;
 
+	// Remembering the call so only the functions the
+	// program calls get their bodies generated
+	if (m_checking_fields || m_checking_globals) {
+		m_sym_module->init_called_functions.push_back(called_function);
+	} else {
+		m_function->sym_function->called_functions.push_back(called_function);
+	}
+
 	for (u32 i = 0; i < called_function->param_types.size(); i++) {
 		attempt_assignment(called_function->param_types[i], function_call->arguments[i]);
 	}
@@ -757,8 +772,8 @@ void nyla::analysis::check_array_access(bool static_context, sym_scope* lookup_s
 	array_access->literal_constant = false;
 
 	check_ident(static_context, lookup_scope, array_access->ident);
-	if (array_access->ident->type == nyla::types::type_error) {
-		array_access->type = nyla::types::type_error;
+	if (array_access->ident->type == m_types.type_error) {
+		array_access->type = m_types.type_error;
 		return;
 	}
 
@@ -769,20 +784,20 @@ void nyla::analysis::check_array_access(bool static_context, sym_scope* lookup_s
 	nyla::type* type_at_index = array_access->ident->type;
 	for (nyla::aexpr* index : array_access->indexes) {
 		check_expression(index);
-		if (index->type == nyla::types::type_error) {
-			array_access->type = nyla::types::type_error;
+		if (index->type == m_types.type_error) {
+			array_access->type = m_types.type_error;
 			return;
 		}
 		if (!index->type->is_int()) {
 			m_log.err(ERR_ARRAY_ACCESS_EXPECTS_INT, index);
-			array_access->type = nyla::types::type_error;
+			array_access->type = m_types.type_error;
 			return;
 		}
 
 		if (!(type_at_index->is_arr() || type_at_index->is_ptr())) {
 			// TODO: pass over type info
 			m_log.err(ERR_ARRAY_ACCESS_ON_INVALID_TYPE, array_access);
-			array_access->type = nyla::types::type_error;
+			array_access->type = m_types.type_error;
 			return;
 		}
 
@@ -793,7 +808,7 @@ void nyla::analysis::check_array_access(bool static_context, sym_scope* lookup_s
 	if (array_access->indexes.size() >
 		array_access->ident->type->arr_depth + array_access->ident->type->ptr_depth) {
 		m_log.err(ERR_TOO_MANY_ARRAY_ACCESS_INDEXES, array_access);
-		array_access->type = nyla::types::type_error;
+		array_access->type = m_types.type_error;
 		return;
 	}
 
@@ -806,7 +821,7 @@ void nyla::analysis::check_array_access(bool static_context, sym_scope* lookup_s
 
 void nyla::analysis::check_array(nyla::aarray* arr, u32 depth) {
 	arr->literal_constant = false;
-	if (arr->type == nyla::types::type_error) return;
+	if (arr->type == m_types.type_error) return;
 
 	bool        last_nesting_level = false;
 	nyla::type* element_array_type = nullptr;
@@ -819,8 +834,8 @@ void nyla::analysis::check_array(nyla::aarray* arr, u32 depth) {
 			check_expression(element);
 		}
 
-		if (element->type == nyla::types::type_error) {
-			arr->type = nyla::types::type_error;
+		if (element->type == m_types.type_error) {
+			arr->type = m_types.type_error;
 			return;
 		}
 
@@ -828,9 +843,9 @@ void nyla::analysis::check_array(nyla::aarray* arr, u32 depth) {
 	}
 
 	if (last_nesting_level) {
-		arr->type = nyla::type::get_arr(nyla::types::type_mixed);
+		arr->type = m_context.get_type_table().get_arr(m_types.type_mixed);
 	} else {
-		arr->type = nyla::type::get_arr(element_array_type);
+		arr->type = m_context.get_type_table().get_arr(element_array_type);
 	}
 }
 
@@ -844,7 +859,7 @@ void nyla::analysis::check_object(nyla::aobject* object) {
 
 	if (!sym_module) {
 		m_log.err(ERR_COULD_NOT_FIND_MODULE_TYPE, object->constructor_call);
-		object->type = nyla::types::type_error;
+		object->type = m_types.type_error;
 		return;
 	}
 
@@ -853,19 +868,19 @@ void nyla::analysis::check_object(nyla::aobject* object) {
 	if (sym_module->no_constructors_found && constructor_call->arguments.empty()) {
 		// Assumed there is a default constructor
 		object->assumed_default_constructor = true;
-		object->type = nyla::type::get_or_enter_module(sym_module);
+		object->type = m_context.get_type_table().get_or_enter_module(sym_module);
 	} else {
 		check_function_call(false, sym_module, constructor_call, true);
-		if (constructor_call->type == nyla::types::type_error) {
-			object->type = nyla::types::type_error;
+		if (constructor_call->type == m_types.type_error) {
+			object->type = m_types.type_error;
 			return;
 		}
 		if (!constructor_call->comptime_compat) object->comptime_compat = false;
-		object->type = nyla::type::get_or_enter_module(sym_module);
+		object->type = m_context.get_type_table().get_or_enter_module(sym_module);
 	}
 	if (object->tag == AST_NEW_OBJECT) {
 		object->comptime_compat = false;
-		object->type = nyla::type::get_ptr(object->type);
+		object->type = m_context.get_type_table().get_ptr(object->type);
 	}
 }
 
@@ -883,13 +898,13 @@ void nyla::analysis::check_new_type(nyla::anew_type* new_type) {
 	} else {
 		if (!new_type->value) {
 			// TODO: produce error
-			new_type->type = nyla::types::type_error;
+			new_type->type = m_types.type_error;
 			return;
 		}
 
 		check_expression(new_type->value);
-		if (new_type->value->type == nyla::types::type_error) {
-			new_type->type = nyla::types::type_error;
+		if (new_type->value->type == m_types.type_error) {
+			new_type->type = m_types.type_error;
 			return;
 		}
 
@@ -899,7 +914,7 @@ void nyla::analysis::check_new_type(nyla::anew_type* new_type) {
 			// TODO: produce error
 		}
 
-		new_type->type = nyla::type::get_ptr(new_type->type_to_allocate.type);
+		new_type->type = m_context.get_type_table().get_ptr(new_type->type_to_allocate.type);
 	}
 }
 
@@ -960,12 +975,12 @@ void nyla::analysis::check_dot_op(nyla::adot_op* dot_op) {
 		case AST_THIS: {
 			if (static_context) {
 				m_log.err(ERR_CANNOT_USE_THIS_KEYWORD_IN_STATIC_CONTEXT, factor);
-				dot_op->type = nyla::types::type_error;
+				dot_op->type = m_types.type_error;
 				return;
 			}
 			if (idx != 0) {
 				m_log.err(ERR_THIS_KEYWORD_MUST_COME_FIRST, factor);
-				dot_op->type = nyla::types::type_error;
+				dot_op->type = m_types.type_error;
 				return;
 			}
 			// Look up variables in the module scope
@@ -974,13 +989,13 @@ void nyla::analysis::check_dot_op(nyla::adot_op* dot_op) {
 		}
 		default: {
 			m_log.err(ERR_DOT_OP_EXPECTS_VARIABLE, factor);
-			dot_op->type = nyla::types::type_error;
+			dot_op->type = m_types.type_error;
 			return;
 		}
 		}
 
-		if (factor->type == nyla::types::type_error) {
-			dot_op->type = nyla::types::type_error;
+		if (factor->type == m_types.type_error) {
+			dot_op->type = m_types.type_error;
 			return;
 		}
 
@@ -995,9 +1010,9 @@ void nyla::analysis::check_dot_op(nyla::adot_op* dot_op) {
 				}
 				if (is_dot_length) {
 					nyla::aident* next_ident = dynamic_cast<nyla::aident*>(next_factor);
-					if (next_ident->ident_key == nyla::length_ident) {
+					if (next_ident->ident_key == m_reserved_words.length_ident) {
 						next_ident->is_array_length = true;
-						dot_op->type = nyla::types::type_uint; // Lengths are in uint
+						dot_op->type = m_types.type_uint; // Lengths are in uint
 						return;
 					} else {
 						is_dot_length = false;
@@ -1007,7 +1022,7 @@ void nyla::analysis::check_dot_op(nyla::adot_op* dot_op) {
 					m_log.err(ERR_TYPE_DOES_NOT_HAVE_FIELD,
 						      error_payload::word({ factor_name_key }),
 						      factor);
-					dot_op->type = nyla::types::type_error;
+					dot_op->type = m_types.type_error;
 					return;
 				}
 
@@ -1023,7 +1038,7 @@ void nyla::analysis::check_dot_op(nyla::adot_op* dot_op) {
 				m_log.err(ERR_TYPE_DOES_NOT_HAVE_FIELD,
 					      error_payload::word({ factor_name_key }),
 					      factor);
-				dot_op->type = nyla::types::type_error;
+				dot_op->type = m_types.type_error;
 				return;
 			}
 		} else {
@@ -1045,8 +1060,8 @@ void nyla::analysis::check_if(nyla::aif* ifstmt) {
 	while (cur_if) {
 
 		check_expression(cur_if->cond);
-		if (cur_if->cond->type == nyla::types::type_error) return;
-		if (cur_if->cond->type != nyla::types::type_bool) {
+		if (cur_if->cond->type == m_types.type_error) return;
+		if (cur_if->cond->type != m_types.type_bool) {
 			m_log.err(ERR_EXPECTED_BOOL_COND, cur_if->cond);
 		}
 		if (!cur_if->cond->comptime_compat) comptime = false;
@@ -1084,7 +1099,7 @@ void nyla::analysis::check_scope(const std::vector<nyla::aexpr*>& stmts, bool& c
 
 	for (nyla::aexpr* stmt : stmts) {
 		if (m_sym_scope->found_return) {
-			// TODO: may need to mark the rest of the statements with nyla::types::type_error
+			// TODO: may need to mark the rest of the statements with m_types.type_error
 			m_log.err(ERR_STMTS_AFTER_RETURN, stmt);
 			break;
 		}
@@ -1134,12 +1149,12 @@ bool nyla::analysis::is_assignable_to(nyla::type* to, nyla::type* from) {
 		if (from->is_ptr()) {  // ptr & ptr
 			return to->ptr_depth == from->ptr_depth &&
 				to->get_base_type()->equals(from->get_base_type());
-		} else if (from == nyla::types::type_null) { // ptr & null
+		} else if (from == m_types.type_null) { // ptr & null
 			return true; // Pointers are always assignable null
 		} else if (from->is_arr()) { // ptr & arr
 			return to->ptr_depth == from->arr_depth &&
 				to->get_base_type()->equals(from->get_base_type());
-		} else if (from == nyla::types::type_string) { // ptr & string
+		} else if (from == m_types.type_string) { // ptr & string
 			return to->ptr_depth == 1
 				&& to->get_base_type()->is_char();
 		}
@@ -1151,7 +1166,7 @@ bool nyla::analysis::is_assignable_to(nyla::type* to, nyla::type* from) {
 				(from->get_base_type()->tag == TYPE_MIXED ||
 					to->get_base_type() == from->get_base_type());
 
-		} else if (from == nyla::types::type_string) {
+		} else if (from == m_types.type_string) {
 			return to->arr_depth == 1
 				&& to->get_base_type()->is_char();
 		}
@@ -1184,7 +1199,7 @@ nyla::aexpr* nyla::analysis::make_cast(nyla::aexpr* value, nyla::type* to_type)
 void nyla::analysis::attempt_assignment(nyla::type* to_type, nyla::aexpr*& value) {
 	nyla::type* value_type = value->type;
 	
-	if (value_type == nyla::types::type_string) {
+	if (value_type == m_types.type_string) {
 		// Strings become the type they are being set to
 		value->type = to_type;
 	} else if (value_type->is_arr() && to_type->is_arr()) {
@@ -1196,7 +1211,7 @@ void nyla::analysis::attempt_assignment(nyla::type* to_type, nyla::aexpr*& value
 		}
 		
 		value->type->set_base_type(to_type->get_base_type());
-	} else if (value_type == nyla::types::type_null) {
+	} else if (value_type == m_types.type_null) {
 		value->type = to_type; // Replacing null type with the type of the pointer
 	} else if (value_type != to_type) {
 		value = make_cast(value, to_type);
@@ -14,6 +14,8 @@ namespace nyla {
 		analysis(nyla::compiler& compiler, nyla::log& log,
 			     nyla::sym_table* sym_table, nyla::afile_unit* file_unit);
 
+		~analysis();
+
 		void check_file_unit();
 
 		nyla::afile_unit* get_file_unit() { return m_file_unit; }
@@ -106,6 +108,10 @@ namespace nyla {
 		nyla::sym_table* m_sym_table;
 		nyla::log&       m_log;
 
+		nyla::compilation_context&  m_context;
+		const nyla::builtin_types&  m_types;
+		const nyla::reserved_words& m_reserved_words;
+
 		  // Current scope to lookup values in
 		nyla::sym_scope*  m_sym_scope  = nullptr;
 		  // Current local module to lookup functions in
@@ -113,7 +119,11 @@ namespace nyla {
 		nyla::afile_unit* m_file_unit  = nullptr;
 		nyla::afunction*  m_function   = nullptr;
 
-		llvm_generator m_llvm_generator;
+		// Compile time expressions are generated into a module
+		// of the analysis' own context
+		llvm::LLVMContext m_llvm_context;
+		llvm::Module*     m_llvm_module;
+		llvm_generator    m_llvm_generator;
 
 		bool m_checking_globals = false;
 		bool m_checking_fields  = false;
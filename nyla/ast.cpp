@@ -2,13 +2,14 @@
 
 #include "words.h"
 #include "tokens.h"
+#include "compilation_context.h"
 
 nyla::ast_node::~ast_node() {
 
 }
 
-std::string nyla::ast_node::word_to_string(u32 word_key) const {
-	return std::string(g_word_table->get_word(word_key).c_str());
+std::string nyla::ast_node::word_to_string(nyla::compilation_context& context, u32 word_key) const {
+	return std::string(context.get_word_table().get_word(word_key).c_str());
 }
 
 std::string nyla::ast_node::indent(u32 depth) const {
@@ -46,27 +47,27 @@ nyla::sym_module* nyla::afile_unit::find_module(u32 name_key) {
 	return nullptr;
 }
 
-void nyla::afile_unit::print(std::ostream& os, u32 depth) const {
+void nyla::afile_unit::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << "imports:\n";
 	for (auto& pair : imports) {
-		pair.second->print(os, depth);
+		pair.second->print(os, context, depth);
 		os << '\n';
 	}
 	os << "modules:\n";
 	for (nyla::amodule* nmodule : modules) {
-		nmodule->print(os, depth);
+		nmodule->print(os, context, depth);
 		os << '\n';
 	}
 }
 
-void nyla::aimport::print(std::ostream& os, u32 depth) const {
+void nyla::aimport::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << "path: \"" << path << "\"";
 	if (!module_aliases.empty()) {
 		os << '\n';
 		os << "aliases:\n";
 		for (auto& pair : module_aliases) {
-			os << indent(1) << g_word_table->get_word(pair.first).c_str()
-			   << " -> " << g_word_table->get_word(pair.second).c_str();
+			os << indent(1) << context.get_word_table().get_word(pair.first).c_str()
+			   << " -> " << context.get_word_table().get_word(pair.second).c_str();
 			os << '\n';
 		}
 	}
@@ -82,22 +83,22 @@ nyla::amodule::~amodule() {
 	// in the symbol table
 }
 
-void nyla::amodule::print(std::ostream& os, u32 depth) const {
-	os << indent(depth) << "module=\"" << word_to_string(name_key) << "\"";
+void nyla::amodule::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << indent(depth) << "module=\"" << word_to_string(context, name_key) << "\"";
 	os << " " << mods_as_string(sym_module->mods) << '\n';
 	os << "constructors:\n";
 	for (nyla::afunction* constructor : constructors) {
-		constructor->print(os, depth + 1);
+		constructor->print(os, context, depth + 1);
 		os << '\n';
 	}
 	os << "fields:\n";
 	for (nyla::avariable_decl* field : fields) {
-		field->print(os, depth + 1);
+		field->print(os, context, depth + 1);
 		os << '\n';
 	}
 	os << "functions:\n";
 	for (nyla::afunction* function : functions) {
-		function->print(os, depth + 1);
+		function->print(os, context, depth + 1);
 		os << '\n';
 	}
 }
@@ -112,13 +113,13 @@ bool nyla::afunction::is_external() const {
 	return sym_function->mods & nyla::modifier::MOD_EXTERNAL;
 }
 
-void nyla::afunction::print(std::ostream& os, u32 depth) const {
-	os << indent(depth) << "function=\"" << word_to_string(name_key) << "\"";
+void nyla::afunction::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << indent(depth) << "function=\"" << word_to_string(context, name_key) << "\"";
 	os << " " << mods_as_string(sym_function->mods) << '\n';
 	if (!is_external())
 		os << indent(depth) << "stmts:\n";
 	for (nyla::aexpr* stmt : stmts) {
-		stmt->print(os, depth + 1);
+		stmt->print(os, context, depth + 1);
 		os << '\n';
 	}
 }
@@ -129,44 +130,44 @@ nyla::avariable_decl::~avariable_decl() {
 	if (!assignment) delete ident;
 }
 
-void nyla::avariable_decl::print(std::ostream& os, u32 depth) const {
-	os << expr_header(depth) << "var_decl=\"" << word_to_string(name_key) << "\"";
-	os << " type='" << type->to_string() << "'";
+void nyla::avariable_decl::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << expr_header(depth) << "var_decl=\"" << word_to_string(context, name_key) << "\"";
+	os << " type='" << type->to_string(context.get_word_table()) << "'";
 	os << " " << mods_as_string(sym_variable->mods);
 	if (sym_variable->is_field) {
 		os << " field_index='" << sym_variable->field_index << "'";
 	}
 	if (assignment) {
 		os << '\n';
-		assignment->print(os, depth + 1);
+		assignment->print(os, context, depth + 1);
 	}
 }
 
-void nyla::areturn::print(std::ostream& os, u32 depth) const {
+void nyla::areturn::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << indent(depth) << "return" << '\n';
 	if (value)
-		value->print(os, depth + 1);
+		value->print(os, context, depth + 1);
 }
 
 nyla::areturn::~areturn() {
 	delete value;
 }
 
-void nyla::aunary_op::print(std::ostream& os, u32 depth) const {
-	os << expr_header(depth) << "unary_op: '" << nyla::token_tag_to_string(op) << "'\n";
-	factor->print(os, depth + 1);
+void nyla::aunary_op::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << expr_header(depth) << "unary_op: '" << nyla::token_tag_to_string(op, context) << "'\n";
+	factor->print(os, context, depth + 1);
 }
 
 nyla::aunary_op::~aunary_op() {
 	delete factor;
 }
 
-void nyla::abinary_op::print(std::ostream& os, u32 depth) const {
-	os << expr_header(depth) << "bin_op: '" << nyla::token_tag_to_string(op) << "'";
+void nyla::abinary_op::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << expr_header(depth) << "bin_op: '" << nyla::token_tag_to_string(op, context) << "'";
 	os << '\n';
-	lhs->print(os, depth + 1);
+	lhs->print(os, context, depth + 1);
 	os << '\n';
-	rhs->print(os, depth + 1);
+	rhs->print(os, context, depth + 1);
 }
 
 nyla::abinary_op::~abinary_op() {
@@ -174,7 +175,7 @@ nyla::abinary_op::~abinary_op() {
 	delete rhs;
 }
 
-void nyla::anumber::print(std::ostream& os, u32 depth) const {
+void nyla::anumber::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	switch (tag) {
 	case AST_VALUE_BYTE:
 		os << expr_header(depth) << "byte: " << value_int; break;
@@ -207,50 +208,45 @@ void nyla::anumber::print(std::ostream& os, u32 depth) const {
 	}
 }
 
-void nyla::abool::print(std::ostream& os, u32 depth) const {
+void nyla::abool::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 }
 
-void nyla::err_expr::print(std::ostream& os, u32 depth) const {
+void nyla::err_expr::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 }
 
-std::ostream& nyla::operator<<(std::ostream& os, const nyla::ast_node& node) {
-	node.print(os);
-	return os;
+void nyla::aident::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << expr_header(depth) << "\"" << word_to_string(context, ident_key) << "\"";
 }
 
-void nyla::aident::print(std::ostream& os, u32 depth) const {
-	os << expr_header(depth) << "\"" << word_to_string(ident_key) << "\"";
-}
-
-void nyla::atype_cast::print(std::ostream& os, u32 depth) const {
-	os << expr_header(depth) << "cast(" << type->to_string() << ")" << '\n';
-	value->print(os, depth + 1);
+void nyla::atype_cast::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << expr_header(depth) << "cast(" << type->to_string(context.get_word_table()) << ")" << '\n';
+	value->print(os, context, depth + 1);
 }
 
 nyla::atype_cast::~atype_cast() {
 	delete value;
 }
 
-void nyla::astring::print(std::ostream& os, u32 depth) const {
+void nyla::astring::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	// TODO: replace escapes with proper output
 	os << expr_header(depth) << "str8=\"" << lit8 << "\"";
 }
 
-void nyla::afor_loop::print(std::ostream& os, u32 depth) const {
+void nyla::afor_loop::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << indent(depth) << "for_loop: " << '\n';
 	os << indent(depth) << "declarations:" << '\n';
 	for (nyla::avariable_decl* decl : declarations) {
-		decl->print(os, depth + 1);
+		decl->print(os, context, depth + 1);
 		os << '\n';
 	}
 	os << indent(depth) << "loop__condition:" << '\n';
 	if (cond) {
-		cond->print(os, depth + 1);
+		cond->print(os, context, depth + 1);
 		os << '\n';
 	}
 	os << indent(depth) << "loop__body:" << '\n';
 	for (nyla::aexpr* stmt : body) {
-		stmt->print(os, depth + 1);
+		stmt->print(os, context, depth + 1);
 		os << '\n';
 	}
 }
@@ -260,16 +256,16 @@ nyla::afor_loop::~afor_loop() {
 		delete decl;
 }
 
-void nyla::awhile_loop::print(std::ostream& os, u32 depth) const {
+void nyla::awhile_loop::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << indent(depth) << "while_loop: " << '\n';
 	os << indent(depth) << "loop_condition:" << '\n';
 	if (cond) {
-		cond->print(os, depth + 1);
+		cond->print(os, context, depth + 1);
 		os << '\n';
 	}
 	os << indent(depth) << "loop__body:" << '\n';
 	for (nyla::aexpr* stmt : body) {
-		stmt->print(os, depth + 1);
+		stmt->print(os, context, depth + 1);
 		os << '\n';
 	}
 }
@@ -282,7 +278,7 @@ nyla::aloop_expr::~aloop_expr() {
 		delete stmt;
 }
 
-void nyla::acontrol::print(std::ostream& os, u32 depth) const {
+void nyla::acontrol::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	switch (tag) {
 	case AST_BREAK:    os << indent(depth) << "break"; break;
 	case AST_CONTINUE: os << indent(depth) << "continue"; break;
@@ -290,19 +286,19 @@ void nyla::acontrol::print(std::ostream& os, u32 depth) const {
 	}
 }
 
-void nyla::aif::print(std::ostream& os, u32 depth) const {
+void nyla::aif::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << indent(depth) << "if:\n";
 	os << indent(depth) << "cond:\n";
-	cond->print(os, depth + 1);
+	cond->print(os, context, depth + 1);
 	os << '\n';
 	os << indent(depth) << "ifbody:\n";
 	for (nyla::aexpr* stmt : body) {
-		stmt->print(os, depth + 1);
+		stmt->print(os, context, depth + 1);
 		os << '\n';
 	}
 	if (else_if) {
 		os << indent(depth) << "else_if:\n";
-		else_if->print(os, depth + 1);
+		else_if->print(os, context, depth + 1);
 	}
 }
 
@@ -315,10 +311,10 @@ nyla::aif::~aif() {
 		delete stmt;
 }
 
-void nyla::afunction_call::print(std::ostream& os, u32 depth) const {
-	os << expr_header(depth) << "function call: " << word_to_string(name_key) << '\n';
+void nyla::afunction_call::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << expr_header(depth) << "function call: " << word_to_string(context, name_key) << '\n';
 	for (nyla::aexpr* parameter_value : arguments) {
-		parameter_value->print(os, depth + 1);
+		parameter_value->print(os, context, depth + 1);
 		os << '\n';
 	}
 }
@@ -328,15 +324,15 @@ nyla::afunction_call::~afunction_call() {
 		delete argument;
 }
 
-void nyla::adot_op::print(std::ostream& os, u32 depth) const {
+void nyla::adot_op::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << expr_header(depth) << "dot_op:\n";
-	factor_list[0]->print(os, depth + 1);
+	factor_list[0]->print(os, context, depth + 1);
 	for (u32 i = 1; i < factor_list.size(); i++) {
 		nyla::aexpr* rhs = factor_list[i];
 		os << '\n';
 		os << indent(depth + 1) << "dot";
 		os << '\n';
-		rhs->print(os, depth + 1);
+		rhs->print(os, context, depth + 1);
 	}
 }
 
@@ -345,19 +341,19 @@ nyla::adot_op::~adot_op() {
 		delete factor;
 }
 
-void nyla::aarray_access::print(std::ostream& os, u32 depth) const {
+void nyla::aarray_access::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << expr_header(depth) << "array_access: \n";
 	for (nyla::aexpr* index : indexes) {
-		index->print(os, depth + 1);
+		index->print(os, context, depth + 1);
 		os << '\n';
 	}
 }
 
-void nyla::aarray::print(std::ostream& os, u32 depth) const {
+void nyla::aarray::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << expr_header(depth) << "array:\n";
 	for (nyla::aexpr* element : elements) {
 		if (element) {
-			element->print(os, depth + 1);
+			element->print(os, context, depth + 1);
 		} else {
 			os << expr_header(depth + 1) << "default_value";
 		}
@@ -371,7 +367,7 @@ nyla::aarray::~aarray() {
 	}
 }
 
-void nyla::aobject::print(std::ostream& os, u32 depth) const {
+void nyla::aobject::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << expr_header(depth);
 	if (AST_VAR_OBJECT) {
 		os << "var";
@@ -379,7 +375,7 @@ void nyla::aobject::print(std::ostream& os, u32 depth) const {
 		os << "new";
 	}
 	os << '\n';
-	constructor_call->print(os, depth + 1);
+	constructor_call->print(os, context, depth + 1);
 }
 
 nyla::anew_type::~anew_type() {
@@ -388,12 +384,12 @@ nyla::anew_type::~anew_type() {
 	}
 }
 
-void nyla::anew_type::print(std::ostream& os, u32 depth) const {
+void nyla::anew_type::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
 	os << expr_header(depth) << "new_type: TODO";
 }
 
-void nyla::aannotation::print(std::ostream& os, u32 depth) const {
-	os << indent(depth) << "annotation: " << word_to_string(ident_key);
+void nyla::aannotation::print(std::ostream& os, nyla::compilation_context& context, u32 depth) const {
+	os << indent(depth) << "annotation: " << word_to_string(context, ident_key);
 }
 
 nyla::aarray_access::~aarray_access() {
@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <map>
 
 #include "sym_table.h"
 #include "types_ext.h"
@@ -11,6 +12,8 @@
 
 namespace nyla {
 
+	class compilation_context;
+
 	enum ast_tag {
 		// High level
 		AST_FILE_UNIT,
@@ -92,10 +95,10 @@ namespace nyla {
 		                              // nodes with comptime modifier. Essentially anything that
 		                              // can be folded by llvm and directly assigned to memory.
 
-		virtual void print(std::ostream& os, u32 depth = 0) const = 0;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const = 0;
 
 		// Gets the string for the word_key in the word_table
-		std::string word_to_string(u32 word_key) const;
+		std::string word_to_string(nyla::compilation_context& context, u32 word_key) const;
 
 		// Converts modifiers to a string
 		std::string mods_as_string(u32 mods) const;
@@ -125,17 +128,17 @@ namespace nyla {
 
 		std::vector<nyla::amodule*> modules;
 
-		std::unordered_map<std::string, aimport*> imports;
-		std::unordered_map<u32, sym_module*>      loaded_modules;
+		// Ordered by path so imports are always resolved
+		// in the same order
+		std::map<std::string, aimport*>      imports;
+		std::unordered_map<u32, sym_module*> loaded_modules;
 		// alias name -> original name
-		std::unordered_map<u32, u32>              module_aliases;
+		std::unordered_map<u32, u32>         module_aliases;
 
 		// Find a module by either the module's name or its alias
 		sym_module* find_module(u32 name_key);
 
-		friend std::ostream& operator<<(std::ostream& os, const nyla::ast_node& node);
-
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 
 	};
 
@@ -147,7 +150,7 @@ namespace nyla {
 		std::unordered_map<u32, u32> module_aliases;
 		
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct amodule : public ast_node {
@@ -163,7 +166,7 @@ namespace nyla {
 		nyla::sym_module* sym_module = nullptr;
 		nyla::sym_scope*  sym_scope  = nullptr;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct afunction : public ast_node {
@@ -185,7 +188,7 @@ namespace nyla {
 
 		bool is_external() const;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	/*----------------------------*\
@@ -215,7 +218,7 @@ namespace nyla {
 		nyla::aident* ident;
 		bool          default_initialize = true;
 		
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct aident : public aexpr {
@@ -229,7 +232,7 @@ namespace nyla {
 
 		sym_variable* sym_variable = nullptr;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	// Representation for either stack or heap objects
@@ -239,7 +242,7 @@ namespace nyla {
 		nyla::afunction_call* constructor_call;
 		nyla::sym_module*     sym_module;
 		bool assumed_default_constructor = false;
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	// Allocating space for a type onto the heap
@@ -249,7 +252,7 @@ namespace nyla {
 		type_info    type_to_allocate;
 		nyla::aexpr* value = nullptr;
 
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct areturn : public aexpr {
@@ -257,7 +260,7 @@ namespace nyla {
 
 		nyla::aexpr* value = nullptr;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct aarray : public aexpr {
@@ -269,7 +272,7 @@ namespace nyla {
 		u32                       dim_size;
 		std::vector<nyla::aexpr*> elements;
 
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct aloop_expr : public aexpr {
@@ -282,7 +285,7 @@ namespace nyla {
 		// is processed
 		std::vector<nyla::aexpr*> post_exprs;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const = 0;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const = 0;
 	};
 
 	struct afor_loop : public aloop_expr {
@@ -290,19 +293,19 @@ namespace nyla {
 
 		std::vector<nyla::avariable_decl*> declarations;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct awhile_loop : public aloop_expr {
 		virtual ~awhile_loop() override {}
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct acontrol : public aexpr {
 		virtual ~acontrol() override {}
 
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct aif : public aexpr {
@@ -315,7 +318,7 @@ namespace nyla {
 		nyla::sym_scope*          else_sym_scope = nullptr;
 		std::vector<nyla::aexpr*> else_body;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct aunary_op : public aexpr {
@@ -324,7 +327,7 @@ namespace nyla {
 		u32 op;
 		nyla::aexpr* factor;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct abinary_op : public aexpr {
@@ -334,7 +337,7 @@ namespace nyla {
 		nyla::aexpr* lhs = nullptr;
 		nyla::aexpr* rhs = nullptr;
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	struct adot_op : public aexpr {
@@ -343,14 +346,14 @@ namespace nyla {
 		// Must contain at least 2 factors
 		std::vector<nyla::aexpr*> factor_list;
 
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct atype_cast : public aexpr {
 		virtual ~atype_cast() override;
 
 		nyla::aexpr* value = nullptr;
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct afunction_call : public aexpr {
@@ -359,7 +362,7 @@ namespace nyla {
 		u32                       name_key;
 		std::vector<nyla::aexpr*> arguments;
 		sym_function*             called_function = nullptr;
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct anumber : public aexpr {
@@ -373,14 +376,14 @@ namespace nyla {
 			float  value_float;
 			double value_double;
 		};
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct abool : public aexpr {
 		virtual ~abool() override {}
 
 		bool tof;
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	// In cases where expressions cannot be parsed
@@ -388,7 +391,7 @@ namespace nyla {
 	struct err_expr : public aexpr {
 		virtual ~err_expr() override {}
 
-		virtual void print(std::ostream& os, u32 depth = 0) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth = 0) const override;
 	};
 
 	// TODO: Array accesses need the ability to access
@@ -398,7 +401,7 @@ namespace nyla {
 
 		nyla::aident*             ident;
 		std::vector<nyla::aexpr*> indexes;
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct astring : public aexpr {
@@ -413,7 +416,7 @@ namespace nyla {
 		u32            dim_size; // Since strings are just arrays and the size
 		                         // could be modified by default initialization
 
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 
 	struct aannotation : public ast_node {
@@ -421,7 +424,7 @@ namespace nyla {
 
 		u32 ident_key;
 
-		virtual void print(std::ostream& os, u32 depth) const override;
+		virtual void print(std::ostream& os, nyla::compilation_context& context, u32 depth) const override;
 	};
 }
 
@@ -1,23 +1,50 @@
 #include "code_gen.h"
+#include "scheduler.h"
+#include "utils.h"
+#include "trace.h"
 
 // LLVM Target
 #include <llvm/Support/Host.h>
 #include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Target/TargetOptions.h>
+#include <llvm/ADT/StringMap.h>
 
 // Needed for writing .o files
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/IR/LegacyPassManager.h>
 
+// Needed for writing bitcode for LTO
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ADT/SmallVector.h>
+
+// Optimization passes
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/IR/PassInstrumentation.h>
+
+// Summaries for ThinLTO
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/IR/ModuleSummaryIndex.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <assert.h>
+
 void nyla::init_llvm_native_target() {
-	llvm::InitializeNativeTarget();
-	llvm::InitializeNativeTargetAsmParser();
-	llvm::InitializeNativeTargetAsmPrinter();
+	// The target registry belongs to the process so
+	// every compiler shares the one registration
+	static std::once_flag init_flag;
+	std::call_once(init_flag, []() {
+		llvm::InitializeNativeTarget();
+		llvm::InitializeNativeTargetAsmParser();
+		llvm::InitializeNativeTargetAsmPrinter();
+	});
 }
 
-llvm::TargetMachine* nyla::create_llvm_target_machine() {
+llvm::TargetMachine* nyla::create_llvm_target_machine(const target_options& options) {
 
 	auto target_triple = llvm::sys::getDefaultTargetTriple();
 
@@ -29,24 +56,124 @@ llvm::TargetMachine* nyla::create_llvm_target_machine() {
 		return nullptr;
 	}
 
-	auto CPU = "generic";
-	auto features = "";
+	std::string CPU = options.cpu;
+	std::string features;
+	if (CPU == "native") {
+		CPU = llvm::sys::getHostCPUName().str();
+
+		llvm::StringMap<bool> host_features;
+		if (llvm::sys::getHostCPUFeatures(host_features)) {
+			for (auto& feature : host_features) {
+				if (!features.empty()) features += ",";
+				features += (feature.getValue() ? "+" : "-") + feature.getKey().str();
+			}
+		}
+	}
+
+	// Explicit features come last so they override
+	// the features of the host
+	if (!options.features.empty()) {
+		if (!features.empty()) features += ",";
+		features += options.features;
+	}
 
 	llvm::TargetOptions opt;
-	auto RM = llvm::Optional<llvm::Reloc::Model>();
 	llvm::TargetMachine* target_machine =
-		target->createTargetMachine(target_triple, CPU, features, opt, RM);
+		target->createTargetMachine(target_triple, CPU, features, opt,
+			                        options.reloc_model, options.code_model);
 
 	return target_machine;
 }
 
-bool nyla::write_obj_file(c_string fname, llvm::Module* llvm_module, llvm::TargetMachine* target_machine) {
+llvm::CodeGenOpt::Level nyla::get_codegen_opt_level(nyla::opt_level opt_level) {
+	switch (opt_level) {
+	case OPT_LEVEL_O0: return llvm::CodeGenOpt::None;
+	case OPT_LEVEL_O1: return llvm::CodeGenOpt::Less;
+	case OPT_LEVEL_O2: return llvm::CodeGenOpt::Default;
+	case OPT_LEVEL_O3: return llvm::CodeGenOpt::Aggressive;
+	case OPT_LEVEL_Os: return llvm::CodeGenOpt::Default;
+	default: assert(!"Unreachable!"); return llvm::CodeGenOpt::None;
+	}
+}
 
-	auto target_triple = llvm::sys::getDefaultTargetTriple();
-	llvm_module->setTargetTriple(target_triple);
+void nyla::optimize_module(llvm::Module* llvm_module, llvm::TargetMachine* target_machine,
+	                       nyla::opt_level opt_level, nyla::lto_mode lto_mode,
+	                       nyla::tracer* tracer) {
+	// Same vectorization defaults as clang. Both vectorizers
+	// run at -O2, -O3 and -Os
+	llvm::PipelineTuningOptions tuning_options;
+	tuning_options.LoopVectorization = opt_level >= OPT_LEVEL_O2;
+	tuning_options.SLPVectorization  = opt_level >= OPT_LEVEL_O2;
 
+	// Passes nest since pass managers are passes themselves
+	// so the start times are kept on a stack
+	llvm::PassInstrumentationCallbacks pass_callbacks;
+	std::vector<u64> pass_start_times;
+	std::string module_name = llvm_module->getModuleIdentifier();
+	auto end_pass = [tracer, &pass_start_times, &module_name](llvm::StringRef pass_name) {
+		tracer->add_span("llvm", pass_name.str(), module_name,
+			             pass_start_times.back(), nyla::get_time_in_nanoseconds());
+		pass_start_times.pop_back();
+	};
+	if (tracer) {
+		pass_callbacks.registerBeforePassCallback([&pass_start_times](llvm::StringRef, llvm::Any) {
+			pass_start_times.push_back(nyla::get_time_in_nanoseconds());
+			return true;
+		});
+		pass_callbacks.registerAfterPassCallback([&end_pass](llvm::StringRef pass_name, llvm::Any) {
+			end_pass(pass_name);
+		});
+		pass_callbacks.registerAfterPassInvalidatedCallback([&end_pass](llvm::StringRef pass_name) {
+			end_pass(pass_name);
+		});
+	}
+
+	llvm::PassBuilder pass_builder(target_machine, tuning_options, llvm::None,
+		                           tracer ? &pass_callbacks : nullptr);
+
+	llvm::LoopAnalysisManager     loop_analysis_manager;
+	llvm::FunctionAnalysisManager function_analysis_manager;
+	llvm::CGSCCAnalysisManager    cgscc_analysis_manager;
+	llvm::ModuleAnalysisManager   module_analysis_manager;
+
+	pass_builder.registerModuleAnalyses(module_analysis_manager);
+	pass_builder.registerCGSCCAnalyses(cgscc_analysis_manager);
+	pass_builder.registerFunctionAnalyses(function_analysis_manager);
+	pass_builder.registerLoopAnalyses(loop_analysis_manager);
+	pass_builder.crossRegisterProxies(loop_analysis_manager, function_analysis_manager,
+		                              cgscc_analysis_manager, module_analysis_manager);
+
+	llvm::PassBuilder::OptimizationLevel pipeline_level;
+	switch (opt_level) {
+	case OPT_LEVEL_O1: pipeline_level = llvm::PassBuilder::OptimizationLevel::O1; break;
+	case OPT_LEVEL_O2: pipeline_level = llvm::PassBuilder::OptimizationLevel::O2; break;
+	case OPT_LEVEL_O3: pipeline_level = llvm::PassBuilder::OptimizationLevel::O3; break;
+	case OPT_LEVEL_Os: pipeline_level = llvm::PassBuilder::OptimizationLevel::Os; break;
+	default: assert(!"O0 does not run any passes"); return;
+	}
+
+	// The target machine decides things such as the vector widths
+	llvm_module->setTargetTriple(target_machine->getTargetTriple().str());
 	llvm_module->setDataLayout(target_machine->createDataLayout());
 
+	// With LTO the pipelines leave the optimizations which
+	// benefit from seeing every file until link time
+	llvm::ModulePassManager module_pass_manager;
+	switch (lto_mode) {
+	case LTO_THIN:
+		module_pass_manager = pass_builder.buildThinLTOPreLinkDefaultPipeline(pipeline_level);
+		break;
+	case LTO_FULL:
+		module_pass_manager = pass_builder.buildLTOPreLinkDefaultPipeline(pipeline_level);
+		break;
+	default:
+		module_pass_manager = pass_builder.buildPerModuleDefaultPipeline(pipeline_level);
+		break;
+	}
+	module_pass_manager.run(*llvm_module, module_analysis_manager);
+}
+
+bool nyla::write_obj_file(c_string fname, llvm::Module* llvm_module, llvm::TargetMachine* target_machine) {
 	std::error_code err;
 	llvm::raw_fd_ostream dest(fname, err, llvm::sys::fs::OF_None);
 
@@ -55,6 +182,41 @@ bool nyla::write_obj_file(c_string fname, llvm::Module* llvm_module, llvm::Targe
 		return false;
 	}
 
+	return write_obj(dest, llvm_module, target_machine);
+}
+
+bool nyla::write_obj_buffer(llvm::SmallVectorImpl<char>& buffer, llvm::Module* llvm_module,
+	                        llvm::TargetMachine* target_machine) {
+	llvm::raw_svector_ostream dest(buffer);
+	return write_obj(dest, llvm_module, target_machine);
+}
+
+void nyla::write_bitcode_buffer(llvm::SmallVectorImpl<char>& buffer, llvm::Module* llvm_module,
+	                            llvm::TargetMachine* target_machine, nyla::lto_mode lto_mode) {
+	llvm_module->setTargetTriple(target_machine->getTargetTriple().str());
+	llvm_module->setDataLayout(target_machine->createDataLayout());
+
+	llvm::raw_svector_ostream dest(buffer);
+	if (lto_mode == LTO_THIN) {
+		// The summary tells the linker which functions
+		// are worth importing into other files
+		llvm::ProfileSummaryInfo profile_summary_info(*llvm_module);
+		llvm::ModuleSummaryIndex summary =
+			llvm::buildModuleSummaryIndex(*llvm_module, nullptr, &profile_summary_info);
+		llvm::WriteBitcodeToFile(*llvm_module, dest, false, &summary);
+	} else {
+		llvm::WriteBitcodeToFile(*llvm_module, dest);
+	}
+}
+
+bool nyla::write_obj(llvm::raw_pwrite_stream& dest, llvm::Module* llvm_module,
+	                 llvm::TargetMachine* target_machine) {
+
+	auto target_triple = llvm::sys::getDefaultTargetTriple();
+	llvm_module->setTargetTriple(target_triple);
+
+	llvm_module->setDataLayout(target_machine->createDataLayout());
+
 	llvm::legacy::PassManager pass;
 	if (target_machine->addPassesToEmitFile(pass, dest, nullptr, llvm::CGFT_ObjectFile)) {
 		llvm::errs() << "TheTargetMachine can't emit a file of this type";
@@ -66,3 +228,70 @@ bool nyla::write_obj_file(c_string fname, llvm::Module* llvm_module, llvm::Targe
 
 	return true;
 }
+
+bool nyla::write_obj_buffers(const std::vector<llvm::Module*>& llvm_modules,
+	                         std::vector<obj_file>& obj_files,
+	                         llvm::TargetMachine* target_machine,
+	                         nyla::opt_level opt_level, nyla::lto_mode lto_mode,
+	                         u32 num_jobs, u64& opt_time_in_nanoseconds,
+	                         nyla::tracer* tracer) {
+	
+	auto for_each_module = [&llvm_modules, num_jobs](const std::function<void(ulen)>& func) {
+		nyla::scheduler scheduler(num_jobs);
+		for (ulen i = 0; i < llvm_modules.size(); i++) {
+			scheduler.add_task([i, &func]() { func(i); });
+		}
+		scheduler.run();
+	};
+
+	target_machine->setOptLevel(get_codegen_opt_level(opt_level));
+
+	// Every module has its own LLVMContext so the modules
+	// are optimized and emitted on different threads in place
+	std::vector<llvm::TargetMachine*> target_machines(llvm_modules.size(), target_machine);
+	std::vector<std::unique_ptr<llvm::TargetMachine>> thread_target_machines(llvm_modules.size());
+	std::atomic<bool> success{ true };
+
+	if (num_jobs > 1) {
+		// Target machines for the threads are created with the
+		// same options as the target machine passed in
+		target_options thread_target_options;
+		thread_target_options.cpu         = target_machine->getTargetCPU().str();
+		thread_target_options.features    = target_machine->getTargetFeatureString().str();
+		thread_target_options.reloc_model = target_machine->getRelocationModel();
+		thread_target_options.code_model  = target_machine->getCodeModel();
+
+		for_each_module([&](ulen i) {
+			// The target machine is not safe to share between threads
+			thread_target_machines[i].reset(create_llvm_target_machine(thread_target_options));
+			if (!thread_target_machines[i]) {
+				success = false;
+				return;
+			}
+			thread_target_machines[i]->setOptLevel(target_machine->getOptLevel());
+			target_machines[i] = thread_target_machines[i].get();
+		});
+		if (!success) return false;
+	}
+
+	u64 opt_st = nyla::get_time_in_nanoseconds();
+	if (opt_level != OPT_LEVEL_O0) {
+		for_each_module([&](ulen i) {
+			nyla::trace_span span(tracer, "compile", "Optimize", obj_files[i].name);
+			optimize_module(llvm_modules[i], target_machines[i], opt_level, lto_mode, tracer);
+		});
+	}
+	opt_time_in_nanoseconds = nyla::get_time_in_nanoseconds() - opt_st;
+
+	for_each_module([&](ulen i) {
+		nyla::trace_span span(tracer, "compile", "Emit", obj_files[i].name);
+		if (lto_mode != LTO_NONE) {
+			// Machine code is generated when linking
+			write_bitcode_buffer(obj_files[i].buffer, llvm_modules[i], target_machines[i], lto_mode);
+		} else if (!write_obj_buffer(obj_files[i].buffer, llvm_modules[i], target_machines[i])) {
+			success = false;
+		}
+	});
+
+	return success;
+}
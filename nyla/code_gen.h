@@ -4,15 +4,103 @@
 #include "types_ext.h"
 #include <llvm/IR/Module.h>
 #include <llvm/Target/TargetMachine.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/ADT/SmallVector.h>
+#include <vector>
+#include <string>
 
 namespace nyla {
+
+	class tracer;
+
+	// Optimization levels in order of how much the
+	// passes try to speed up the code
+	enum opt_level {
+		OPT_LEVEL_O0,
+		OPT_LEVEL_O1,
+		OPT_LEVEL_O2,
+		OPT_LEVEL_O3,
+		// Same as O2 while avoiding passes which
+		// increase the code size
+		OPT_LEVEL_Os,
+	};
 	
+	// Link time optimization. Files are written as bitcode
+	// and optimized together when they are linked
+	enum lto_mode {
+		LTO_NONE,
+		// Each file has a summary of its functions which is used
+		// to import functions across files in parallel
+		LTO_THIN,
+		// Every file is merged into a single module
+		LTO_FULL,
+	};
+
+	// Options for the machine code is generated for
+	struct target_options {
+		// Name of the CPU or "native" to use the
+		// CPU of the host
+		std::string cpu = "generic";
+		// Comma separated list of features to enable or
+		// disable. Ex. +avx2,+fma,-sse4a
+		std::string features;
+		// Left empty to use the defaults of the target
+		llvm::Optional<llvm::Reloc::Model>     reloc_model;
+		llvm::Optional<llvm::CodeModel::Model> code_model;
+
+		bool operator==(const target_options& o) const {
+			return cpu == o.cpu && features == o.features &&
+				   reloc_model == o.reloc_model && code_model == o.code_model;
+		}
+		bool operator!=(const target_options& o) const { return !(*this == o); }
+	};
+
 	void init_llvm_native_target();
 
-	llvm::TargetMachine* create_llvm_target_machine();
+	llvm::TargetMachine* create_llvm_target_machine(const target_options& options);
+
+	llvm::CodeGenOpt::Level get_codegen_opt_level(nyla::opt_level opt_level);
+
+	// Runs the standard LLVM pipeline for the optimization
+	// level over the module. Must not be called with O0. With
+	// LTO the pipeline which runs before linking is used instead.
+	// Every pass run is traced when given a tracer
+	void optimize_module(llvm::Module* llvm_module, llvm::TargetMachine* target_machine,
+		                 nyla::opt_level opt_level, nyla::lto_mode lto_mode = LTO_NONE,
+		                 nyla::tracer* tracer = nullptr);
+
+	// Object code kept in memory until it is linked
+	struct obj_file {
+		std::string                name;
+		llvm::SmallVector<char, 0> buffer;
+	};
+
+	bool write_obj(llvm::raw_pwrite_stream& dest, llvm::Module* llvm_module,
+		           llvm::TargetMachine* target_machine);
 
 	bool write_obj_file(c_string fname, llvm::Module* llvm_module, llvm::TargetMachine* target_machine);
 
+	bool write_obj_buffer(llvm::SmallVectorImpl<char>& buffer, llvm::Module* llvm_module,
+		                  llvm::TargetMachine* target_machine);
+
+	// Writes the module as bitcode for LTO. ThinLTO
+	// bitcode includes the summary of the module
+	void write_bitcode_buffer(llvm::SmallVectorImpl<char>& buffer, llvm::Module* llvm_module,
+		                      llvm::TargetMachine* target_machine, nyla::lto_mode lto_mode);
+
+	// Optimizes and writes every module into the buffer of the
+	// object file of the same index. Every module must have an
+	// LLVMContext of its own since with more than one job the
+	// work happens in parallel. opt_time_in_nanoseconds is set to
+	// how long optimizing took. With LTO the buffers hold
+	// bitcode instead of object code
+	bool write_obj_buffers(const std::vector<llvm::Module*>& llvm_modules,
+		                   std::vector<obj_file>& obj_files,
+		                   llvm::TargetMachine* target_machine,
+		                   nyla::opt_level opt_level, nyla::lto_mode lto_mode,
+		                   u32 num_jobs, u64& opt_time_in_nanoseconds,
+		                   nyla::tracer* tracer = nullptr);
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#include "compilation_context.h"
+
+nyla::compilation_context::compilation_context() {
+	nyla::setup_tokens(m_word_table, m_reserved_words);
+}
+
+nyla::compilation_context::~compilation_context() {
+	delete m_target_machine;
+}
+
+void nyla::compilation_context::set_target_machine(llvm::TargetMachine* target_machine) {
+	delete m_target_machine;
+	m_target_machine = target_machine;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef NYLA_COMPILATION_CONTEXT_H
+#define NYLA_COMPILATION_CONTEXT_H
+
+#include <llvm/Target/TargetMachine.h>
+#include <mutex>
+
+#include "words.h"
+#include "type.h"
+#include "tokens.h"
+
+namespace nyla {
+
+	/*
+	 * Everything that is shared between the files of a
+	 * compile. Each compiler owns its own context so more
+	 * than one compiler may run within the same process
+	 * at the same time.
+	 */
+	class compilation_context {
+	public:
+
+		compilation_context();
+
+		~compilation_context();
+
+		compilation_context(const compilation_context&) = delete;
+		compilation_context& operator=(const compilation_context&) = delete;
+
+		// nullptr until the first compile creates it
+		llvm::TargetMachine* get_target_machine() { return m_target_machine; }
+
+		// Takes ownership of the target machine and deletes
+		// the previous one
+		void set_target_machine(llvm::TargetMachine* target_machine);
+
+		nyla::word_table& get_word_table() { return m_word_table; }
+
+		nyla::type_table& get_type_table() { return m_type_table; }
+
+		const nyla::builtin_types& get_builtin_types() const { return m_builtin_types; }
+
+		const nyla::reserved_words& get_reserved_words() const { return m_reserved_words; }
+
+		// Files may report errors from multiple threads so
+		// printing is serialized to keep messages whole
+		std::mutex& get_print_mutex() { return m_print_mutex; }
+
+	private:
+		llvm::TargetMachine* m_target_machine = nullptr;
+		nyla::word_table     m_word_table;
+		nyla::type_table     m_type_table;
+		nyla::builtin_types  m_builtin_types;
+		nyla::reserved_words m_reserved_words;
+		std::mutex           m_print_mutex;
+	};
+
+}
+
+#endif
\ No newline at end of file
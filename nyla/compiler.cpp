@@ -7,18 +7,23 @@
 #include "analysis.h"
 #include "llvm_gen.h"
 #include "code_gen.h"
+#include "linker.h"
+#include "lto.h"
+#include "jit.h"
+#include "scheduler.h"
+#include "interface.h"
+#include "trace.h"
 
 #include <llvm/IR/Verifier.h>
+#include <llvm/Config/llvm-config.h>
 
 #include <iomanip>
+#include <algorithm>
+#include <unordered_set>
+#include <cstdio>
 
-llvm::LLVMContext* nyla::llvm_context = nullptr;
-llvm::TargetMachine* nyla::g_llvm_target_machine = nullptr;
-
-nyla::compiler::compiler() {
-	nyla::llvm_context = new llvm::LLVMContext;
-	m_llvm_module      = new llvm::Module("Nyla Module", *nyla::llvm_context);
-	nyla::setup_tokens();
+nyla::compiler::compiler()
+	: m_log(m_context) {
 }
 
 void nyla::compiler::set_flags(u32 flags) {
@@ -33,22 +38,73 @@ void nyla::compiler::set_flags(u32 flags) {
 }
 
 void nyla::compiler::compile(const std::vector<std::string>& src_directories, const std::string& main_function_path) {
+	// A trace only holds a single compile
+	if (!m_trace_file.empty()) {
+		m_tracer = new nyla::tracer;
+	}
+	{
+		nyla::trace_span span(m_tracer, "compile", "Compile");
+		compile_program(src_directories, main_function_path);
+	}
+	if (m_tracer) {
+		if (!m_tracer->write(m_trace_file)) {
+			std::cerr << "Failed to write the trace: " << m_trace_file << '\n';
+		}
+		delete m_tracer;
+		m_tracer = nullptr;
+	}
+}
+
+void nyla::compiler::compile_program(const std::vector<std::string>& src_directories, const std::string& main_function_path) {
 	assert(!main_function_path.empty());
 	
+	// Anything left over from a previous compile is
+	// scoped to that compile
+	m_found_compilation_errors           = false;
+	m_total_parse_time_in_nanoseconds    = 0;
+	m_total_analysis_time_in_nanoseconds = 0;
+	m_total_ir_gen_time_in_nanoseconds   = 0;
+	m_compile_times                      = nyla::compile_times();
+	m_total_released_ast_bytes           = 0;
+	m_total_released_source_bytes        = 0;
+	m_run_exit_code                      = 0;
+
 	if (main_function_path.empty()) {
 		m_found_compilation_errors = true;
 		m_log.global_error(ERR_FILE_WITH_MAIN_FUNCTION_EMPTY);
 		return;
 	}
 
-	m_main_function_file = main_function_path;
+	// Symbol tables of the previous compile. Files which have not
+	// changed take them over instead of being processed again
+	std::unordered_map<std::string, sym_table*> old_sym_tables;
+	old_sym_tables.swap(m_sym_tables);
+
+	u32 compiled_flags = m_flags & (COMPFLAGS_FULL_COMPILATION | COMPFLAGS_OPT_LEVEL | COMPFLAGS_LTO);
+	if (m_compiled_before && (compiled_flags != m_compiled_flags ||
+		                      m_target_options != m_compiled_target_options ||
+		                      main_function_path != m_main_function_file)) {
+		// The code would not be generated the same way so
+		// nothing can be reused
+		for (auto& pair : old_sym_tables) {
+			delete_sym_table(pair.second);
+		}
+		old_sym_tables.clear();
+		if (m_target_options != m_compiled_target_options) {
+			m_context.set_target_machine(nullptr);
+		}
+	}
+	m_compiled_before         = true;
+	m_compiled_flags          = compiled_flags;
+	m_compiled_target_options = m_target_options;
+	m_main_function_file      = main_function_path;
 
 	init_llvm_native_target();
-	if (!nyla::g_llvm_target_machine) {
-		nyla::g_llvm_target_machine = nyla::create_llvm_target_machine();
+	if (!m_context.get_target_machine()) {
+		m_context.set_target_machine(nyla::create_llvm_target_machine(m_target_options));
 	}
 
-	if (!nyla::g_llvm_target_machine) {
+	if (!m_context.get_target_machine()) {
 		m_found_compilation_errors = true;
 		return;
 	}
@@ -59,25 +115,73 @@ void nyla::compiler::compile(const std::vector<std::string>& src_directories, co
 			nyla::replace(src_directory, "\\", "/"));
 	}
 
+	// A file watcher already knows which files were
+	// added and removed since the previous compile
+	m_source_changes_known = m_has_source_changes && m_reuse_sym_tables &&
+		                     resolved_src_directories == m_collected_src_directories;
+	m_has_source_changes   = false;
+	m_changed_source_paths.clear();
+
 	std::vector<file_location> source_files;
-	for (const std::string& src_directory : resolved_src_directories) {
-		
-		std::vector<std::string> paths = nyla::split(src_directory, '/');
+	if (m_source_changes_known) {
+		if (!apply_source_changes(resolved_src_directories, source_files)) {
+			m_found_compilation_errors = true;
+			return;
+		}
+	} else {
+		for (const std::string& src_directory : resolved_src_directories) {
+
+			std::vector<std::string> paths = nyla::split(src_directory, '/');
+
+			nyla::trace_span span(m_tracer, "compile", "Find source files", src_directory);
+			if (!collect_source_files(src_directory, "", source_files)) {
+				m_found_compilation_errors = true;
+				return;
+			}
 
-		collect_source_files(src_directory, "", source_files);
-		
-		for (const file_location& file_location : source_files) {
-			if (m_flags & COMPFLAG_DISPLAY_SOURCE_PATHS) {
-				std::cout << "-- Full path relative to compiler: " << file_location.system_path << '\n';
-				std::cout << "-- Internal path: " << file_location.internal_path << '\n';
+			for (const file_location& file_location : source_files) {
+				if (m_flags & COMPFLAG_DISPLAY_SOURCE_PATHS) {
+					std::cout << "-- Full path relative to compiler: " << file_location.system_path << '\n';
+					std::cout << "-- Internal path: " << file_location.internal_path << '\n';
+				}
 			}
 		}
 	}
+	// Directories are not read in the same order on every
+	// system. The files are linked in this order so it must
+	// not change for the executable to be reproducible
+	std::sort(source_files.begin(), source_files.end(), [](const file_location& lhs, const file_location& rhs) {
+		return lhs.internal_path < rhs.internal_path;
+	});
+
+	m_collected_src_directories = resolved_src_directories;
+	m_collected_source_files    = source_files;
+
+	std::unordered_map<std::string, const file_location*> internal_paths;
+	for (const file_location& source_file : source_files) {
+		auto it = internal_paths.find(source_file.internal_path);
+		if (it != internal_paths.end()) {
+			m_log.global_error(
+				ERR_CONFLICTING_INTERNAL_PATHS,
+				error_payload::file_locations(err_file_locations{ it->second, &source_file })
+			);
+			m_found_compilation_errors = true;
+			return;
+		}
+		internal_paths[source_file.internal_path] = &source_file;
+	}
 
-	process_files(source_files);
+	process_files(source_files, old_sym_tables);
+	m_compile_times.parse    = m_total_parse_time_in_nanoseconds;
+	m_compile_times.analysis = m_total_analysis_time_in_nanoseconds;
+	m_compile_times.llvm_ir  = m_total_ir_gen_time_in_nanoseconds;
+	if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+		display_memory("after processing files");
+	}
 	
 	if (!m_main_function) {
 		m_log.global_error(ERR_MAIN_FUNCTION_NOT_FOUND);
+		m_found_compilation_errors = true;
 		return;
 	}
 
@@ -85,57 +189,219 @@ void nyla::compiler::compile(const std::vector<std::string>& src_directories, co
 		return;
 	}
 
-	nyla::llvm_generator generator(*this, m_llvm_module, nullptr, false);
-	generator.gen_global_initializers(m_main_function, m_global_initializer_exprs);
-	generator.gen_startup_function_calls(m_main_function, m_startup_functions);
+	if (!m_deps_file.empty() || !m_graph_file.empty()) {
+		std::vector<sym_table*> imported_files = find_imported_files();
+		if (!m_deps_file.empty() && !write_deps_file(imported_files)) {
+			std::cerr << "Failed to write the dependency file: " << m_deps_file << '\n';
+			m_found_compilation_errors = true;
+			return;
+		}
+		if (!m_graph_file.empty() && !write_graph_file(imported_files)) {
+			std::cerr << "Failed to write the import graph: " << m_graph_file << '\n';
+			m_found_compilation_errors = true;
+			return;
+		}
+	}
 
-	if (llvm::verifyModule(*m_llvm_module, &llvm::errs())) {
+	// Nothing is generated when only analyzing
+	if (!should_gen_obj_code()) {
 		return;
 	}
 
-	if (m_found_compilation_errors) {
-		return;
+	// The global initializers and startup functions are called
+	// by a function in a module of its own so the module with
+	// the main function does not change when other files change
+	std::unique_ptr<llvm::LLVMContext> init_llvm_context(new llvm::LLVMContext);
+	std::unique_ptr<llvm::Module> init_llvm_module(new llvm::Module("__nyla.init", *init_llvm_context));
+	std::vector<nyla::avariable_decl*> global_initializer_exprs;
+	std::vector<sym_function*>         startup_functions;
+	for (const file_location& source_file : source_files) {
+		sym_table* sym_table = m_sym_tables[source_file.internal_path];
+		if (!sym_table->m_linked) continue;
+		global_initializer_exprs.insert(global_initializer_exprs.end(),
+			                            sym_table->m_global_initializer_exprs.begin(),
+			                            sym_table->m_global_initializer_exprs.end());
+		startup_functions.insert(startup_functions.end(),
+			                     sym_table->m_startup_functions.begin(),
+			                     sym_table->m_startup_functions.end());
+	}
+	nyla::llvm_generator generator(*this, init_llvm_module.get(), nullptr, false);
+	generator.gen_init_function(global_initializer_exprs, startup_functions);
+
+	// Every file which was compiled gets its own object file
+	std::vector<sym_table*>     obj_sym_tables;
+	std::vector<llvm::Module*>  llvm_modules;
+	std::vector<nyla::obj_file> obj_files;
+	for (const file_location& source_file : source_files) {
+		sym_table* sym_table = m_sym_tables[source_file.internal_path];
+		if (!sym_table->m_linked) continue;
+		obj_sym_tables.push_back(sym_table);
+		llvm_modules.push_back(sym_table->get_llvm_module());
+		obj_files.emplace_back();
+		obj_files.back().name = m_executable_name + "." + nyla::replace(source_file.internal_path, "/", ".") + ".o";
+	}
+	obj_sym_tables.push_back(nullptr);
+	llvm_modules.push_back(init_llvm_module.get());
+	obj_files.emplace_back();
+	obj_files.back().name = m_executable_name + ".__nyla.init.o";
+
+	for (llvm::Module* llvm_module : llvm_modules) {
+		// Files loaded from their interface only have their cached object
+		if (llvm_module && llvm::verifyModule(*llvm_module, &llvm::errs())) {
+			m_found_compilation_errors = true;
+			return;
+		}
 	}
 
 	if (m_flags & COMPFLAG_DISPLAY_LLVM_IR) {
-		m_main_function->ll_function->print(llvm::outs());
+		m_sym_tables[m_main_function_file]->get_llvm_module()
+			->getFunction(m_main_function->ll_name)->print(llvm::outs());
 		std::cout << '\n';
 	}
 	
+	if (m_flags & COMPFLAG_RUN) {
+		// Compiled in memory so there are no object
+		// files to write or link
+		u64 jit_st = nyla::get_time_in_nanoseconds();
+		nyla::jit jit;
+		{
+			nyla::trace_span span(m_tracer, "compile", "JIT");
+			if (!jit.compile(llvm_modules, get_opt_level())) {
+				m_found_compilation_errors = true;
+				return;
+			}
+		}
+		u64 jit_time = nyla::get_time_in_nanoseconds() - jit_st;
+		m_compile_times.jit = jit_time;
+
+		if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+			display_memory("after JIT");
+			display_memory_totals();
+		}
+
+		if (m_flags & COMPFLAG_DISPLAY_TIMES) {
+			std::cout << "-- Compilation times\n";
+			std::cout << "---------------------------\n";
+			display_time("Parse Time:   ", m_total_parse_time_in_nanoseconds);
+			display_time("Analysis:     ", m_total_analysis_time_in_nanoseconds);
+			display_time("LLVM IR time: ", m_total_ir_gen_time_in_nanoseconds);
+			display_time("JIT time:     ", jit_time);
+			std::cout << '\n';
+			display_time("Total time:   ", m_total_parse_time_in_nanoseconds + m_total_analysis_time_in_nanoseconds +
+				                           m_total_ir_gen_time_in_nanoseconds + jit_time);
+		}
+
+		m_run_exit_code = jit.run_main();
+		return;
+	}
+
 	if (m_flags & COMPFLAG_DISPLAY_STAGES) {
-		std::cout << "-- Finalizing compilation. Writing program.o\n";
+		std::cout << "-- Finalizing compilation. Writing object files\n";
 	}
 
-	std::string obj_name = m_executable_name + ".o";
-	
-	u64 compile_st = nyla::get_time_in_milliseconds();
-	nyla::write_obj_file(obj_name.c_str(), m_llvm_module, nyla::g_llvm_target_machine);
-	u64 compile_time = nyla::get_time_in_milliseconds() - compile_st;
+	// Object code kept from a previous compile does
+	// not need to be written again
+	std::vector<u32>            emit_indexes;
+	std::vector<llvm::Module*>  emit_llvm_modules;
+	std::vector<nyla::obj_file> emit_obj_files;
+	for (u32 i = 0; i < obj_files.size(); i++) {
+		auto it = m_obj_buffers.find(obj_sym_tables[i]);
+		if (it != m_obj_buffers.end()) {
+			obj_files[i].buffer = it->second;
+			continue;
+		}
+		emit_indexes.push_back(i);
+		emit_llvm_modules.push_back(llvm_modules[i]);
+		emit_obj_files.push_back(obj_files[i]);
+	}
+
+	u64 compile_st = nyla::get_time_in_nanoseconds();
+	u64 opt_time;
+	if (!nyla::write_obj_buffers(emit_llvm_modules, emit_obj_files, m_context.get_target_machine(),
+		                         get_opt_level(), get_lto_mode(), m_num_jobs, opt_time, m_tracer)) {
+		m_found_compilation_errors = true;
+		return;
+	}
+	u64 compile_time = nyla::get_time_in_nanoseconds() - compile_st - opt_time;
+	m_compile_times.optimization = opt_time;
+	m_compile_times.emit         = compile_time;
+	if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+		display_memory("after writing object files");
+	}
 
-	u64 link_st = nyla::get_time_in_milliseconds();
-	std::string options = "";
-	options += "-O0 ";
+	for (u32 i = 0; i < emit_indexes.size(); i++) {
+		u32 index = emit_indexes[i];
+		sym_table* obj_sym_table = obj_sym_tables[index];
+		if (obj_sym_table && !m_object_cache_directory.empty()) {
+			// Failing to write to the cache only means the
+			// file is compiled again the next time
+			const llvm::SmallVector<char, 0>& buffer = emit_obj_files[i].buffer;
+			nyla::write_file(get_object_cache_path(obj_sym_table), buffer.data(), buffer.size());
+		}
+		if (m_reuse_sym_tables && obj_sym_table) {
+			m_obj_buffers[obj_sym_table] = emit_obj_files[i].buffer;
+		}
+		obj_files[index].buffer = std::move(emit_obj_files[i].buffer);
+	}
 
-	std::string clang_command = "clang++ ";
-	clang_command += options + " ";
-	clang_command += obj_name;
-	clang_command += " -o " + m_executable_name;
+	// With LTO the buffers hold bitcode which is optimized
+	// across files before the machine code is generated
+	u64 lto_time = 0;
+	if (get_lto_mode() != LTO_NONE) {
+		if (m_flags & COMPFLAG_DISPLAY_STAGES) {
+			std::cout << "-- Running LTO\n";
+		}
+		u64 lto_st = nyla::get_time_in_nanoseconds();
+		nyla::trace_span span(m_tracer, "compile", "LTO");
+		std::vector<nyla::obj_file> bitcode_files;
+		bitcode_files.swap(obj_files);
+		if (!nyla::run_lto(bitcode_files, obj_files, m_context.get_target_machine(), get_opt_level(),
+			               get_lto_mode(), m_num_jobs, m_executable_name + ".lto")) {
+			m_found_compilation_errors = true;
+			return;
+		}
+		lto_time = nyla::get_time_in_nanoseconds() - lto_st;
+		m_compile_times.lto = lto_time;
+		if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+			display_memory("after LTO");
+		}
+	}
 
+	u64 link_st = nyla::get_time_in_nanoseconds();
 	std::cout << "-- Linking: " << m_executable_name << '\n';
-
-	system(clang_command.c_str());
-	u64 link_time = nyla::get_time_in_milliseconds() - link_st;
+	{
+		nyla::trace_span span(m_tracer, "compile", "Link", m_executable_name);
+		if (!nyla::link_executable(m_executable_name, obj_files,
+			                       m_context.get_target_machine()->getTargetTriple(),
+			                       m_target_options.reloc_model)) {
+			m_log.global_error(ERR_FAILED_TO_LINK, error_payload::string({ m_executable_name }));
+			m_found_compilation_errors = true;
+			return;
+		}
+	}
+	u64 link_time = nyla::get_time_in_nanoseconds() - link_st;
+	m_compile_times.link = link_time;
+	if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+		display_memory("after linking");
+		display_memory_totals();
+	}
 
 	if (m_flags & COMPFLAG_DISPLAY_TIMES) {
 		std::cout << "-- Compilation times\n";
 		std::cout << "---------------------------\n";
-		std::cout << "Parse Time:   " << std::fixed << std::setprecision(3) << (m_total_parse_time_in_milliseconds / 1000.0F) << " seconds\n";
-		std::cout << "LLVM IR time: " << std::fixed << std::setprecision(3) << (m_total_ir_gen_time_in_milliseconds / 1000.0F) << " seconds\n";
-		std::cout << "Compile time: " << std::fixed << std::setprecision(3) << (compile_time / 1000.0F) << " seconds\n";
-		std::cout << "Link time:    " << std::fixed << std::setprecision(3) << (link_time / 1000.0F) << " seconds\n";
-		u64 total_time = m_total_parse_time_in_milliseconds + m_total_ir_gen_time_in_milliseconds + compile_time + link_time;
+		display_time("Parse Time:   ", m_total_parse_time_in_nanoseconds);
+		display_time("Analysis:     ", m_total_analysis_time_in_nanoseconds);
+		display_time("LLVM IR time: ", m_total_ir_gen_time_in_nanoseconds);
+		display_time("Optimization: ", opt_time);
+		display_time("Compile time: ", compile_time);
+		if (get_lto_mode() != LTO_NONE) {
+			display_time("LTO time:     ", lto_time);
+		}
+		display_time("Link time:    ", link_time);
+		u64 total_time = m_total_parse_time_in_nanoseconds + m_total_analysis_time_in_nanoseconds +
+			             m_total_ir_gen_time_in_nanoseconds + opt_time + compile_time + lto_time + link_time;
 		std::cout << '\n';
-		std::cout << "Total time:   " << (total_time / 1000.0F) << " seconds\n";
+		display_time("Total time:   ", total_time);
 	}
 }
 
@@ -158,43 +424,335 @@ void nyla::compiler::set_main_function(sym_function* main_function) {
 }
 
 u32 nyla::compiler::get_new_unique_module_id() {
-	u32 unique_id = unique_module_id_count;
-	++unique_module_id_count;
-	return unique_id;
+	return unique_module_id_count++;
+}
+
+void nyla::compiler::set_executable_name(const std::string& executable_name) {
+	m_executable_name = executable_name;
+}
+
+nyla::lto_mode nyla::compiler::get_lto_mode() {
+	switch (m_flags & COMPFLAGS_LTO) {
+	case COMPFLAG_LTO_THIN: return LTO_THIN;
+	case COMPFLAG_LTO_FULL: return LTO_FULL;
+	default:                return LTO_NONE;
+	}
 }
 
-u32 nyla::compiler::get_num_global_const_array_count() {
-	u32 count = m_num_global_const_array_count;
-	++m_num_global_const_array_count;
-	return count;
+nyla::opt_level nyla::compiler::get_opt_level() {
+	switch (m_flags & COMPFLAGS_OPT_LEVEL) {
+	case COMPFLAG_OPT_O1: return OPT_LEVEL_O1;
+	case COMPFLAG_OPT_O2: return OPT_LEVEL_O2;
+	case COMPFLAG_OPT_O3: return OPT_LEVEL_O3;
+	case COMPFLAG_OPT_Os: return OPT_LEVEL_Os;
+	default:              return OPT_LEVEL_O0;
+	}
 }
 
-u32 nyla::compiler::get_num_global_variable_count() {
-	u32 count = m_num_global_variable_count;
-	++m_num_global_variable_count;
-	return count;
+void nyla::compiler::display_time(c_string label, u64 time_in_nanoseconds) {
+	std::cout << label << std::fixed << std::setprecision(3) << (time_in_nanoseconds / 1000000000.0) << " seconds\n";
 }
 
-u32 nyla::compiler::get_num_functions_count() {
-	u32 count = m_num_functions_count;
-	++m_num_functions_count;
-	return count;
+// Readable size such as 12.34 MB
+static std::string format_bytes(u64 num_bytes) {
+	c8 buffer[32];
+	if (num_bytes >= 1024 * 1024) {
+		snprintf(buffer, sizeof(buffer), "%.2f MB", num_bytes / (1024.0 * 1024.0));
+	} else if (num_bytes >= 1024) {
+		snprintf(buffer, sizeof(buffer), "%.2f KB", num_bytes / 1024.0);
+	} else {
+		snprintf(buffer, sizeof(buffer), "%llu B", (unsigned long long)num_bytes);
+	}
+	return buffer;
 }
 
-void nyla::compiler::add_global_initialize_expr(nyla::avariable_decl* expr) {
-	expr->global_initializer_expr = true;
-	m_global_initializer_exprs.push_back(expr);
+// The peak is sampled by the system less often than the
+// current usage so it may briefly fall behind it
+static u64 get_peak_rss() {
+	return std::max(nyla::get_memory_usage(), nyla::get_peak_memory_usage());
 }
 
-void nyla::compiler::add_startup_function(llvm::Function* ll_startup_function) {
-	m_startup_functions.push_back(ll_startup_function);
+void nyla::compiler::display_memory(c_string label) {
+	std::cout << "-- Memory " + std::string(label) + ": rss " + format_bytes(nyla::get_memory_usage()) +
+		         ", peak rss " + format_bytes(get_peak_rss()) + "\n";
 }
 
-void nyla::compiler::set_executable_name(const std::string& executable_name) {
-	m_executable_name = executable_name;
+void nyla::compiler::display_file_memory(sym_table* our_sym_table, c_string stage) {
+	std::string line = "-- Memory after " + std::string(stage) + ": " +
+		               our_sym_table->get_file_location().system_path;
+	line += " | rss " + format_bytes(nyla::get_memory_usage());
+	line += ", peak rss " + format_bytes(get_peak_rss());
+	if (nyla::parser* parser = our_sym_table->get_parser()) {
+		line += ", ast " + format_bytes(parser->get_ast_bytes());
+	}
+	if (nyla::lexer* lexer = our_sym_table->get_lexer()) {
+		line += ", tokens " + format_bytes(lexer->get_tokens().get_memory_usage());
+	}
+	line += ", symbols " + format_bytes(our_sym_table->m_symbol_bytes);
+	if (llvm::Module* llvm_module = our_sym_table->get_llvm_module()) {
+		// Only the thread processing the file changes its module
+		line += ", llvm " + std::to_string(llvm_module->getInstructionCount()) + " instructions";
+	}
+	std::cout << line + "\n";
+}
+
+void nyla::compiler::display_memory_totals() {
+	ulen num_words, word_bytes, num_types, type_bytes;
+	m_context.get_word_table().get_memory_usage(num_words, word_bytes);
+	m_context.get_type_table().get_memory_usage(num_types, type_bytes);
+	// Import resolution adds nodes to the AST so
+	// it is only complete once it is released
+	u64 symbol_bytes = 0, held_ast_bytes = 0;
+	for (auto& pair : m_sym_tables) {
+		symbol_bytes += pair.second->m_symbol_bytes;
+		if (nyla::parser* parser = pair.second->get_parser()) {
+			held_ast_bytes += parser->get_ast_bytes();
+		}
+	}
+
+	std::cout << "-- Memory usage\n";
+	std::cout << "---------------------------\n";
+	std::cout << "Peak rss:     " << format_bytes(get_peak_rss()) << '\n';
+	std::cout << "Words:        " << format_bytes(word_bytes) << " (" << num_words << " entries)\n";
+	std::cout << "Types:        " << format_bytes(type_bytes) << " (" << num_types << " entries)\n";
+	std::cout << "Symbols:      " << format_bytes(symbol_bytes) << '\n';
+	std::cout << "Held AST:     " << format_bytes(held_ast_bytes) << '\n';
+	std::cout << "Released AST: " << format_bytes(m_total_released_ast_bytes) << '\n';
+	std::cout << "Released src: " << format_bytes(m_total_released_source_bytes) << '\n';
+}
+
+void nyla::compiler::set_target_options(const nyla::target_options& target_options) {
+	m_target_options = target_options;
+}
+
+void nyla::compiler::set_num_jobs(u32 num_jobs) {
+	m_num_jobs = num_jobs == 0 ? 1 : num_jobs;
+}
+
+void nyla::compiler::set_object_cache_directory(const std::string& object_cache_directory) {
+	m_object_cache_directory = object_cache_directory;
+	if (!m_object_cache_directory.empty() && !nyla::create_directory(m_object_cache_directory)) {
+		// Continuing without the object cache
+		std::cerr << "Failed to create the object cache directory: " << m_object_cache_directory << '\n';
+		m_object_cache_directory.clear();
+	}
+}
+
+void nyla::compiler::set_trace_file(const std::string& trace_file) {
+	m_trace_file = trace_file;
+}
+
+void nyla::compiler::set_deps_file(const std::string& deps_file) {
+	m_deps_file = deps_file;
+}
+
+void nyla::compiler::set_graph_file(const std::string& graph_file) {
+	m_graph_file = graph_file;
+}
+
+std::vector<nyla::sym_table*> nyla::compiler::find_imported_files() {
+	std::vector<sym_table*> imported_files;
+	sym_table* main_file_sym_table = find_sym_table(m_main_function_file);
+	if (!main_file_sym_table) return imported_files;
+
+	std::unordered_set<sym_table*> found;
+	std::vector<sym_table*> work_list;
+	found.insert(main_file_sym_table);
+	work_list.push_back(main_file_sym_table);
+	while (!work_list.empty()) {
+		sym_table* our_sym_table = work_list.back();
+		work_list.pop_back();
+		imported_files.push_back(our_sym_table);
+		for (sym_table* dep_sym_table : our_sym_table->m_dependencies) {
+			if (found.insert(dep_sym_table).second) {
+				work_list.push_back(dep_sym_table);
+			}
+		}
+	}
+
+	std::sort(imported_files.begin(), imported_files.end(), [](sym_table* lhs, sym_table* rhs) {
+		return lhs->get_file_location().internal_path < rhs->get_file_location().internal_path;
+	});
+	return imported_files;
+}
+
+// Escapes the characters which have a meaning in Makefiles
+static std::string escape_make_path(const std::string& path) {
+	std::string escaped;
+	for (c8 ch : path) {
+		switch (ch) {
+		case ' ':  escaped += "\\ "; break;
+		case '#':  escaped += "\\#"; break;
+		case '$':  escaped += "$$";  break;
+		default:   escaped += ch;    break;
+		}
+	}
+	return escaped;
+}
+
+bool nyla::compiler::write_deps_file(const std::vector<sym_table*>& sym_tables) {
+	std::string contents = escape_make_path(m_executable_name) + ":";
+	for (sym_table* our_sym_table : sym_tables) {
+		contents += " \\\n  " + escape_make_path(our_sym_table->get_file_location().system_path);
+	}
+	contents += "\n";
+	return nyla::write_file(m_deps_file, contents.data(), contents.size());
+}
+
+// Quotes the string for JSON and DOT. Quotes, backslashes and
+// control characters are escaped since JSON does not allow them
+// within a string
+static std::string escape_graph_string(const std::string& str) {
+	std::string escaped = "\"";
+	for (c8 ch : str) {
+		switch (ch) {
+		case '"':  escaped += "\\\""; break;
+		case '\\': escaped += "\\\\"; break;
+		case '\n': escaped += "\\n";  break;
+		case '\r': escaped += "\\r";  break;
+		case '\t': escaped += "\\t";  break;
+		case '\b': escaped += "\\b";  break;
+		case '\f': escaped += "\\f";  break;
+		default:
+			if ((u8)ch < 0x20) {
+				c8 code[7];
+				snprintf(code, sizeof(code), "\\u%04x", (u8)ch);
+				escaped += code;
+			} else {
+				escaped += ch;
+			}
+			break;
+		}
+	}
+	return escaped + "\"";
+}
+
+bool nyla::compiler::write_graph_file(const std::vector<sym_table*>& sym_tables) {
+	// Imports are sorted so the same program
+	// always gives the same graph
+	std::vector<std::pair<std::string, std::string>> edges;
+	for (sym_table* our_sym_table : sym_tables) {
+		for (sym_table* dep_sym_table : our_sym_table->m_dependencies) {
+			edges.emplace_back(our_sym_table->get_file_location().internal_path,
+				               dep_sym_table->get_file_location().internal_path);
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+
+	std::string contents;
+	if (nyla::string_ends_with(m_graph_file, std::string(".json"))) {
+		contents += "{\n  \"files\": [";
+		for (ulen i = 0; i < sym_tables.size(); i++) {
+			const file_location& location = sym_tables[i]->get_file_location();
+			contents += i == 0 ? "\n" : ",\n";
+			contents += "    { \"path\": " + escape_graph_string(location.internal_path) +
+				        ", \"file\": " + escape_graph_string(location.system_path) + " }";
+		}
+		contents += "\n  ],\n  \"imports\": [";
+		for (ulen i = 0; i < edges.size(); i++) {
+			contents += i == 0 ? "\n" : ",\n";
+			contents += "    { \"from\": " + escape_graph_string(edges[i].first) +
+				        ", \"to\": " + escape_graph_string(edges[i].second) + " }";
+		}
+		contents += "\n  ]\n}\n";
+	} else {
+		contents += "digraph imports {\n";
+		for (sym_table* our_sym_table : sym_tables) {
+			contents += "  " + escape_graph_string(our_sym_table->get_file_location().internal_path) + ";\n";
+		}
+		for (auto& edge : edges) {
+			contents += "  " + escape_graph_string(edge.first) + " -> " + escape_graph_string(edge.second) + ";\n";
+		}
+		contents += "}\n";
+	}
+	return nyla::write_file(m_graph_file, contents.data(), contents.size());
+}
+
+void nyla::compiler::set_reuse_sym_tables(bool reuse_sym_tables) {
+	m_reuse_sym_tables = reuse_sym_tables;
+}
+
+void nyla::compiler::set_interface_directory(const std::string& interface_directory) {
+	m_interface_directory = interface_directory;
+	if (!m_interface_directory.empty() && !nyla::create_directory(m_interface_directory)) {
+		// Continuing without interfaces
+		std::cerr << "Failed to create the interface directory: " << m_interface_directory << '\n';
+		m_interface_directory.clear();
+	}
+}
+
+void nyla::compiler::set_source_changes(const nyla::source_changes& source_changes) {
+	m_has_source_changes = true;
+	m_source_changes     = source_changes;
+}
+
+bool nyla::compiler::apply_source_changes(const std::vector<std::string>& src_directories,
+	                                      std::vector<file_location>& source_files) {
+	nyla::trace_span span(m_tracer, "compile", "Apply source changes");
+
+	auto in_directory = [](const std::string& path, const std::string& directory) {
+		return nyla::string_starts_with(path, directory + "/");
+	};
+
+	std::unordered_set<std::string> deleted_files(m_source_changes.deleted_files.begin(),
+		                                          m_source_changes.deleted_files.end());
+	std::unordered_set<std::string> system_paths;
+	for (const file_location& source_file : m_collected_source_files) {
+		if (deleted_files.find(source_file.system_path) != deleted_files.end()) continue;
+		bool in_deleted_directory = false;
+		for (const std::string& directory : m_source_changes.deleted_directories) {
+			if (in_directory(source_file.system_path, directory)) {
+				in_deleted_directory = true;
+				break;
+			}
+		}
+		if (in_deleted_directory) continue;
+		source_files.push_back(source_file);
+		system_paths.insert(source_file.system_path);
+	}
+
+	// Source directory the path is found in. Empty
+	// if it is not within any of them
+	auto find_src_directory = [&](const std::string& path) -> std::string {
+		for (const std::string& src_directory : src_directories) {
+			if (in_directory(path, src_directory)) {
+				return src_directory;
+			}
+		}
+		return "";
+	};
+
+	std::vector<file_location> created_files;
+	for (const std::string& directory : m_source_changes.created_directories) {
+		std::string src_directory = find_src_directory(directory);
+		if (src_directory.empty()) continue;
+		if (!collect_source_files(directory, directory.substr(src_directory.size() + 1), created_files)) {
+			return false;
+		}
+	}
+	for (const std::string& path : m_source_changes.created_files) {
+		std::string src_directory = find_src_directory(path);
+		if (src_directory.empty() || !nyla::string_ends_with(path, std::string(".nyla"))) continue;
+		file_location file_location;
+		file_location.system_path   = path;
+		file_location.internal_path = path.substr(src_directory.size() + 1,
+			                                      path.size() - src_directory.size() - 1 - 5);
+		created_files.push_back(file_location);
+	}
+	for (const file_location& created_file : created_files) {
+		m_changed_source_paths.insert(created_file.system_path);
+		if (system_paths.insert(created_file.system_path).second) {
+			source_files.push_back(created_file);
+		}
+	}
+
+	for (const std::string& path : m_source_changes.modified_files) {
+		m_changed_source_paths.insert(path);
+	}
+	return true;
 }
 
-void nyla::compiler::collect_source_files(const std::string& directory,
+bool nyla::compiler::collect_source_files(const std::string& directory,
 	                                      const std::string& directory_rel_src,
 	                                      std::vector<file_location>& source_files) {
 	std::tuple<std::vector<search_file>, bool> files =
@@ -202,15 +760,16 @@ void nyla::compiler::collect_source_files(const std::string& directory,
 	if (!std::get<1>(files)) {
 		m_log.global_error(ERR_FAILED_TO_READ_SOURCE_DIRECTORY,
 			               error_payload::string({directory}));
-		exit(-1);
-		return;
+		return false;
 	}
 	for (const search_file& search_file : std::get<0>(files)) {
 		if (search_file.is_directory) {
-			collect_source_files(
+			if (!collect_source_files(
 				directory         + "/" + search_file.path, 
 				directory_rel_src + (directory_rel_src.empty() ? "" : "/") + search_file.path,
-				source_files);
+				source_files)) {
+				return false;
+			}
 		}
 		if (nyla::string_ends_with(search_file.path, std::string(".nyla"))) {
 			file_location file_location;
@@ -218,329 +777,995 @@ void nyla::compiler::collect_source_files(const std::string& directory,
 			file_location.internal_path = directory_rel_src
 				                             + (directory_rel_src.empty() ? "" : "/")
 				                             + search_file.path.substr(0, search_file.path.size() - 5);
-			
-			auto it = m_sym_tables.find(file_location.internal_path);
-			if (it != m_sym_tables.end()) {
-				m_log.global_error(
-					ERR_CONFLICTING_INTERNAL_PATHS,
-					error_payload::file_locations(err_file_locations{ &file_location, &file_location })
-				);
-				exit(-1);
-			}
-
-			sym_table* new_sym_table = new sym_table;
-			new_sym_table->m_search_for_main_function =
-				m_main_function_file == file_location.internal_path;
-
-			new_sym_table->set_file_location(file_location);
-			m_sym_tables[file_location.internal_path] = new_sym_table;
 			source_files.push_back(file_location);
 		}
 	}
+	return true;
 }
 
-void nyla::compiler::process_files(std::vector<file_location>& source_files) {
+void nyla::compiler::process_files(std::vector<file_location>& source_files,
+	                               std::unordered_map<std::string, sym_table*>& old_sym_tables) {
+
+	std::vector<sym_table*> sym_tables;
+	sym_table* main_file_sym_table = nullptr;
+	for (const file_location& source_file : source_files) {
+		sym_table* new_sym_table = new sym_table;
+		new_sym_table->m_search_for_main_function =
+			m_main_function_file == source_file.internal_path;
+		new_sym_table->set_file_location(source_file);
+		sym_tables.push_back(new_sym_table);
+		if (new_sym_table->m_search_for_main_function) {
+			main_file_sym_table = new_sym_table;
+		}
+	}
 
-	auto it = m_sym_tables.find(m_main_function_file);
-	if (it == m_sym_tables.end()) {
+	if (!main_file_sym_table) {
 		m_log.global_error(ERR_FILE_WITH_MAIN_FUNCTION_DOES_NOT_EXIST,
 			               error_payload::string({ m_main_function_file }));
 		m_found_compilation_errors = true;
+		for (sym_table* sym_table : sym_tables) {
+			delete sym_table;
+		}
+		for (auto& pair : old_sym_tables) {
+			delete_sym_table(pair.second);
+		}
+		old_sym_tables.clear();
+		m_main_function = nullptr;
 		return;
 	}
 
-	// Parsing all files that depend on the file
-	// with the main function and creating llvm ir
-	sym_table* main_file_sym_table = it->second;
-	file_location source_file = main_file_sym_table->get_file_location();
-	process_file(source_file, main_file_sym_table);
+	// 1. Reading every file and swapping in the symbol tables
+	//    of the files which have not changed. When the changes
+	//    are known unchanged files are only read if they have
+	//    to be processed again
+	std::vector<sym_table*> read_sym_tables;
+	for (sym_table* sym_table : sym_tables) {
+		const file_location& source_file = sym_table->get_file_location();
+		if (m_source_changes_known &&
+			m_changed_source_paths.find(source_file.system_path) == m_changed_source_paths.end()) {
+			auto it = old_sym_tables.find(source_file.internal_path);
+			if (it != old_sym_tables.end() &&
+				it->second->get_file_location().system_path == source_file.system_path) {
+				sym_table->m_source_hash = it->second->m_source_hash;
+				continue;
+			}
+		}
+		read_sym_tables.push_back(sym_table);
+	}
+	if (!read_files(read_sym_tables)) {
+		m_found_compilation_errors = true;
+	}
+	reuse_sym_tables(sym_tables, old_sym_tables);
 
-	u32 save_flags = m_flags;
-	// Making sure no object code is generated
-	if (should_analyze()) {
-		m_flags = COMPFLAG_ONLY_PARSE_AND_ANALYZE;
+	std::vector<sym_table*> unread_sym_tables;
+	for (sym_table* sym_table : sym_tables) {
+		if (!sym_table->m_reused && !sym_table->get_source_buffer()) {
+			unread_sym_tables.push_back(sym_table);
+		}
+	}
+	if (!m_found_compilation_errors && !read_files(unread_sym_tables)) {
+		m_found_compilation_errors = true;
+	}
+	for (sym_table* sym_table : sym_tables) {
+		m_sym_tables[sym_table->get_file_location().internal_path] = sym_table;
 	}
 
-	// Parsing the rest of the files but since they do
-	// not depend on the main file there is no reason
-	// to fully process them
-	for (file_location& source_file : source_files) {
-		sym_table* sym_table = m_sym_tables[source_file.internal_path];
-		if (!sym_table->m_started_processing) {
-			process_file(source_file, sym_table);
+	main_file_sym_table = m_sym_tables[m_main_function_file];
+	if (!main_file_sym_table->m_reused) {
+		m_main_function = nullptr;
+	}
+
+	if (m_found_compilation_errors) {
+		return;
+	}
+
+	// 2. Parsing the files. Files which can be loaded from their
+	//    interface are not parsed. When generating code only the
+	//    files the main file depends on are parsed. Otherwise every
+	//    other file is parsed. The imports have to be known before
+	//    the rest of the work can be scheduled
+	find_interface_files(sym_tables);
+	if (should_gen_obj_code()) {
+		parse_reachable_files(sym_tables, main_file_sym_table);
+	} else {
+		parse_files(sym_tables);
+	}
+
+	for (sym_table* sym_table : sym_tables) {
+		if (sym_table->needs_processing()) {
+			find_dependencies(sym_table);
+		}
+	}
+	find_import_components(sym_tables);
+	find_final_states(sym_tables, main_file_sym_table);
+
+	load_interfaces(sym_tables);
+	if (m_found_compilation_errors) {
+		return;
+	}
+	// Files loaded from their interface already found their object
+	for (sym_table* sym_table : sym_tables) {
+		if (!sym_table->m_from_interface) {
+			sym_table->m_obj_cache_hit = false;
+		}
+	}
+	if (!should_skip_unreachable_functions()) {
+		find_cached_objects(sym_tables);
+	}
+
+	// 3. Building a graph of (file, state) tasks. A state of a
+	//    file runs after the previous state of the same file and
+	//    after the same state of the files it imports. Files
+	//    with cyclic imports instead wait for the previous state
+	//    of each other and run the same state one at a time.
+	//    Every file generates its IR in its own LLVMContext so
+	//    the states of independent files, including the code
+	//    generation states, run in parallel. Reused files and
+	//    files loaded from their interface are already done
+	nyla::scheduler scheduler(m_num_jobs);
+	std::unordered_map<sym_table*, std::vector<u32>> state_tasks;
+	for (sym_table* sym_table : sym_tables) {
+		if (!sym_table->needs_processing()) continue;
+		std::vector<u32>& tasks = state_tasks[sym_table];
+		tasks.resize(FS_LLVM_IR_GEN + 1);
+		for (u32 state = FS_IMPORT_RESOLVED; state <= sym_table->m_final_state; state++) {
+			tasks[state] = scheduler.add_task([this, sym_table, state]() {
+				process_state(sym_table, (file_state)state);
+			});
+		}
+	}
+
+	std::unordered_map<u32, std::vector<sym_table*>> components;
+	for (sym_table* sym_table : sym_tables) {
+		if (!sym_table->needs_processing()) continue;
+		components[sym_table->m_import_component].push_back(sym_table);
+	}
+
+	for (sym_table* sym_table : sym_tables) {
+		if (!sym_table->needs_processing()) continue;
+		const std::vector<u32>& tasks = state_tasks[sym_table];
+		for (u32 state = FS_ANALYZED; state <= sym_table->m_final_state; state++) {
+			scheduler.add_dependency(tasks[state], tasks[state - 1]);
+			for (nyla::sym_table* dep_sym_table : sym_table->m_dependencies) {
+				if (!dep_sym_table->needs_processing()) continue;
+				if (dep_sym_table->m_import_component != sym_table->m_import_component) {
+					scheduler.add_dependency(tasks[state], state_tasks[dep_sym_table][state]);
+				} else {
+					scheduler.add_dependency(tasks[state], state_tasks[dep_sym_table][state - 1]);
+				}
+			}
+		}
+	}
+
+	for (auto& pair : components) {
+		const std::vector<sym_table*>& component = pair.second;
+		for (u32 i = 1; i < component.size(); i++) {
+			for (u32 state = FS_ANALYZED; state <= component[i]->m_final_state; state++) {
+				scheduler.add_dependency(state_tasks[component[i]][state],
+					                     state_tasks[component[i - 1]][state]);
+			}
 		}
 	}
 
-	m_flags = save_flags;
+	// Bodies are only generated for the functions the program
+	// calls which is known once every compiled file is analyzed.
+	// The cached objects depend on those functions so they are
+	// looked up before the file starts generating its IR
+	if (should_skip_unreachable_functions()) {
+		u32 reachability_task = scheduler.add_task([this, &sym_tables]() {
+			find_reachable_functions(sym_tables);
+		});
+		for (sym_table* sym_table : sym_tables) {
+			if (!sym_table->needs_processing() || sym_table->m_final_state != FS_LLVM_IR_GEN) continue;
+			const std::vector<u32>& tasks = state_tasks[sym_table];
+			scheduler.add_dependency(reachability_task, tasks[FS_ANALYZED]);
+			if (should_use_object_cache() && sym_table->m_linked) {
+				u32 cache_task = scheduler.add_task([this, sym_table]() {
+					find_cached_object(sym_table);
+				});
+				scheduler.add_dependency(cache_task, reachability_task);
+				scheduler.add_dependency(tasks[FS_TYPE_DECL_GEN], cache_task);
+			} else {
+				scheduler.add_dependency(tasks[FS_LLVM_IR_GEN], reachability_task);
+			}
+		}
+	}
+
+	// 4. Processing the files
+	scheduler.run();
+
+	// Files that stopped processing early due to errors
+	// still have their resources around
+	for (sym_table* sym_table : sym_tables) {
+		unload_file(sym_table);
+	}
+}
+
+bool nyla::compiler::read_files(std::vector<sym_table*>& sym_tables) {
+	std::atomic<bool> failed_to_read{ false };
+
+	nyla::scheduler scheduler(m_num_jobs);
+	for (sym_table* our_sym_table : sym_tables) {
+		scheduler.add_task([this, our_sym_table, &failed_to_read]() {
+			const file_location& source_file = our_sym_table->get_file_location();
+			nyla::trace_span span(m_tracer, "file", "Read", source_file.system_path);
+
+			c8* buffer;
+			ulen buffer_len;
+			if (!nyla::map_file(source_file.system_path, source_padding, buffer, buffer_len)) {
+				m_log.global_error(
+					ERR_FAILED_TO_READ_FILE,
+					error_payload::file_locations(err_file_locations{ &source_file })
+				);
+				failed_to_read = true;
+				return;
+			}
+
+			our_sym_table->set_source_buffer(buffer);
+			our_sym_table->set_source_buffer_length(buffer_len);
+			our_sym_table->m_source_hash = nyla::hash_bytes(buffer, buffer_len);
+		});
+	}
+	scheduler.run();
+
+	return !failed_to_read;
 }
 
-void nyla::compiler::process_file(const file_location& source_file, sym_table* our_sym_table) {
+void nyla::compiler::reuse_sym_tables(std::vector<sym_table*>& sym_tables,
+	                                  std::unordered_map<std::string, sym_table*>& old_sym_tables) {
 	
-#define ERROR_RETURN() {                          \
-m_found_compilation_errors = true;                \
-our_sym_table->m_found_compilation_errors = true; \
-	return;                                       \
- }
+	// A symbol table can only be reused if the file has not changed
+	// and every file it imports can also be reused
+	std::unordered_map<sym_table*, sym_table*> reusable;
+	if (m_reuse_sym_tables) {
+		for (sym_table* new_sym_table : sym_tables) {
+			auto it = old_sym_tables.find(new_sym_table->get_file_location().internal_path);
+			if (it == old_sym_tables.end()) continue;
+			sym_table* old_sym_table = it->second;
+			// Files which failed to be read are left without a hash
+			if (!old_sym_table->m_found_compilation_errors &&
+				!old_sym_table->m_skipped &&
+				new_sym_table->m_source_hash != 0 &&
+				old_sym_table->m_source_hash == new_sym_table->m_source_hash) {
+				reusable[old_sym_table] = new_sym_table;
+			}
+		}
+	}
+
+	bool removed_sym_table = true;
+	while (removed_sym_table) {
+		removed_sym_table = false;
+		for (auto it = reusable.begin(); it != reusable.end();) {
+			bool dependencies_reusable = true;
+			for (sym_table* dep_sym_table : it->first->m_dependencies) {
+				if (reusable.find(dep_sym_table) == reusable.end()) {
+					dependencies_reusable = false;
+					break;
+				}
+			}
+			if (dependencies_reusable) {
+				++it;
+			} else {
+				it = reusable.erase(it);
+				removed_sym_table = true;
+			}
+		}
+	}
 
-	if (our_sym_table->m_started_processing) return;
-	our_sym_table->m_started_processing = true;
+	for (auto& pair : old_sym_tables) {
+		if (reusable.find(pair.second) == reusable.end()) {
+			delete_sym_table(pair.second);
+		}
+	}
+	old_sym_tables.clear();
 
-	std::cout << "-- Processing: " << source_file.system_path << '\n';
+	std::unordered_map<sym_table*, sym_table*> replacements;
+	for (auto& pair : reusable) {
+		replacements[pair.second] = pair.first;
+	}
+	for (sym_table*& our_sym_table : sym_tables) {
+		auto it = replacements.find(our_sym_table);
+		if (it == replacements.end()) {
+			our_sym_table->m_reused = false;
+			continue;
+		}
+		sym_table* old_sym_table = it->second;
+		old_sym_table->m_reused = true;
+		// The file location may be different even if the internal
+		// path is the same
+		old_sym_table->set_file_location(our_sym_table->get_file_location());
+		delete_sym_table(our_sym_table);
+		our_sym_table = old_sym_table;
+	}
 
-	// 1. Setup everything needed to parse, analyze and
-	//    generate code
-	u64 parse_st = nyla::get_time_in_milliseconds();
+	if ((m_flags & COMPFLAG_DISPLAY_STAGES) && !reusable.empty()) {
+		std::cout << "-- Reusing " << reusable.size() << " unchanged files\n";
+	}
+}
+
+void nyla::compiler::find_cached_objects(std::vector<sym_table*>& sym_tables) {
+	nyla::trace_span span(m_tracer, "compile", "Find cached objects");
+	if (!should_use_object_cache()) {
+		return;
+	}
+
+	nyla::scheduler scheduler(m_num_jobs);
+	for (sym_table* our_sym_table : sym_tables) {
+		if (!our_sym_table->needs_processing() || !our_sym_table->m_linked) continue;
+		scheduler.add_task([this, our_sym_table]() {
+			find_cached_object(our_sym_table);
+		});
+	}
+	scheduler.run();
+}
+
+void nyla::compiler::find_cached_object(sym_table* our_sym_table) {
+	if (m_found_compilation_errors) return;
+	our_sym_table->m_obj_cache_key = get_object_cache_key(our_sym_table);
 	c8* buffer;
 	ulen buffer_len;
-	if (!nyla::read_file(source_file.system_path, buffer, buffer_len)) {
-		m_log.global_error(
-			ERR_FAILED_TO_READ_FILE,
-			error_payload::file_locations(err_file_locations{ &source_file })
-		);
-		exit(-1);
+	if (!nyla::read_file(get_object_cache_path(our_sym_table), buffer, buffer_len)) {
 		return;
 	}
+	{
+		std::lock_guard<std::mutex> lock(m_obj_buffers_mutex);
+		m_obj_buffers[our_sym_table].assign(buffer, buffer + buffer_len);
+	}
+	delete[] buffer;
+	our_sym_table->m_obj_cache_hit = true;
+
+	if (m_flags & COMPFLAG_DISPLAY_STAGES) {
+		std::cout << "-- Cached object: " + our_sym_table->get_file_location().system_path + "\n";
+	}
+}
+
+u64 nyla::compiler::get_object_cache_key(sym_table* our_sym_table) {
+	// Importers generate the field initializers of the modules they
+	// use so every file the file depends on is part of the key and
+	// not just the files it imports
+	std::vector<sym_table*> dependencies;
+	std::unordered_set<sym_table*> visited = { our_sym_table };
+	std::vector<sym_table*> work_list = { our_sym_table };
+	while (!work_list.empty()) {
+		sym_table* next_sym_table = work_list.back();
+		work_list.pop_back();
+		for (sym_table* dep_sym_table : next_sym_table->m_dependencies) {
+			if (visited.insert(dep_sym_table).second) {
+				dependencies.push_back(dep_sym_table);
+				work_list.push_back(dep_sym_table);
+			}
+		}
+	}
+	std::sort(dependencies.begin(), dependencies.end(), [](sym_table* lhs, sym_table* rhs) {
+		return lhs->get_file_location().internal_path < rhs->get_file_location().internal_path;
+	});
+
+	llvm::TargetMachine* target_machine = m_context.get_target_machine();
+
+	std::string key;
+	auto add_to_key = [&key](const std::string& value) {
+		key += value;
+		key += '\0';
+	};
+	add_to_key(LLVM_VERSION_STRING);
+	add_to_key(std::to_string(m_flags & (COMPFLAGS_FULL_COMPILATION | COMPFLAGS_OPT_LEVEL | COMPFLAGS_LTO)));
+	add_to_key(target_machine->getTargetTriple().str());
+	add_to_key(target_machine->getTargetCPU().str());
+	add_to_key(target_machine->getTargetFeatureString().str());
+	add_to_key(std::to_string(target_machine->getRelocationModel()));
+	add_to_key(std::to_string(target_machine->getCodeModel()));
+	add_to_key(std::to_string(our_sym_table->m_search_for_main_function));
+	add_to_key(our_sym_table->get_file_location().internal_path);
+	add_to_key(std::to_string(our_sym_table->m_source_hash));
+	for (sym_table* dep_sym_table : dependencies) {
+		add_to_key(dep_sym_table->get_file_location().internal_path);
+		add_to_key(std::to_string(dep_sym_table->m_source_hash));
+	}
+	// The object only has bodies for the functions the program
+	// reaches. The source is the same so the functions of the
+	// file are in the same order
+	std::string reachable_functions;
+	if (should_skip_unreachable_functions()) {
+		for (nyla::amodule* nmodule : our_sym_table->get_file_unit()->modules) {
+			for (nyla::afunction* constructor : nmodule->constructors) {
+				reachable_functions += constructor->sym_function->reachable ? '1' : '0';
+			}
+			for (nyla::afunction* function : nmodule->functions) {
+				reachable_functions += function->sym_function->reachable ? '1' : '0';
+			}
+		}
+	} else {
+		reachable_functions = "all";
+	}
+	add_to_key(reachable_functions);
+	return nyla::hash_bytes(key.data(), key.size());
+}
+
+std::string nyla::compiler::get_object_cache_path(sym_table* our_sym_table) {
+	c8 key[17];
+	snprintf(key, sizeof(key), "%016llx", (unsigned long long) our_sym_table->m_obj_cache_key);
+	return m_object_cache_directory + "/" +
+		   nyla::replace(our_sym_table->get_file_location().internal_path, "/", ".") +
+		   "." + key + ".o";
+}
+
+void nyla::compiler::delete_sym_table(sym_table* our_sym_table) {
+	unload_file(our_sym_table);
+	// The module has to be deleted before its context
+	delete our_sym_table->get_llvm_module();
+	delete our_sym_table->get_llvm_context();
+	m_obj_buffers.erase(our_sym_table);
+	delete our_sym_table;
+}
+
+void nyla::compiler::load_file(sym_table* our_sym_table) {
+	const file_location& source_file = our_sym_table->get_file_location();
 
-	nyla::source source(buffer, buffer_len);
-	nyla::log log(source);
-	log.set_file_path(source_file.internal_path);
-	nyla::lexer lexer(source, log);
+	c8*  buffer     = our_sym_table->get_source_buffer();
+	ulen buffer_len = our_sym_table->get_source_buffer_length();
+
+	nyla::source* source = new nyla::source(buffer, buffer_len);
+	nyla::log* log = new nyla::log(*source, m_context);
+	log->set_file_path(source_file.internal_path);
+	nyla::lexer* lexer = new nyla::lexer(*source, *log, m_context);
 
 	nyla::afile_unit* file_unit = new afile_unit;
 	file_unit->tag = AST_FILE_UNIT;
 
-	nyla::parser parser(*this, lexer, log, our_sym_table, file_unit);
-	nyla::analysis analysis(*this, log, our_sym_table, file_unit);
-	nyla::llvm_generator llvm_generator(*this, m_llvm_module, file_unit,
-		m_flags & COMPFLAG_DISPLAY_LLVM_IR);
-
-	our_sym_table->set_parser(&parser);
-	our_sym_table->set_analysis(&analysis);
-	our_sym_table->set_llvm_generator(&llvm_generator);
-
-	// 2. Parsing our file
-	parse_file(our_sym_table);
-	if (log.has_errors()) ERROR_RETURN();
-
-	our_sym_table->m_parse_imports_iterator   = file_unit->imports.begin();
-	our_sym_table->m_resolve_imports_iterator = file_unit->imports.begin();
-	our_sym_table->m_analyze_imports_iterator = file_unit->imports.begin();
-	our_sym_table->m_gen_body_decl_iterator   = file_unit->imports.begin();
-	our_sym_table->m_gen_type_decl_iterator   = file_unit->imports.begin();
-	our_sym_table->m_imports_end              = file_unit->imports.end();
-
-	// 3. Parsing all the dependencies found in
-	//    the imports
-	parse_dependencies(our_sym_table);
-	if (log.has_errors()) ERROR_RETURN();
-
-	// 4. Import resolution
-	resolve_imports(our_sym_table);
-	if (log.has_errors()) ERROR_RETURN();
-	
-	// 5. Import resolution for all dependencies
-	if (!resolve_dependency_imports(our_sym_table)) {
-		ERROR_RETURN();
+	nyla::parser* parser = new nyla::parser(*this, *lexer, *log, our_sym_table, file_unit);
+
+	our_sym_table->set_source(source);
+	our_sym_table->set_log(log);
+	our_sym_table->set_lexer(lexer);
+	our_sym_table->set_file_unit(file_unit);
+	our_sym_table->set_parser(parser);
+}
+
+void nyla::compiler::find_interface_files(std::vector<sym_table*>& sym_tables) {
+	if (m_interface_directory.empty()) return;
+	// When generating code a file is only loaded from its interface
+	// if its object is cached. Objects which skip the unreachable
+	// functions are keyed by the functions the program reaches and
+	// those are only known once the bodies of every file are analyzed
+	bool gen_obj_code = should_gen_obj_code();
+	if (gen_obj_code && (!should_use_object_cache() || should_skip_unreachable_functions())) {
+		return;
 	}
 
-	// 6. Analyzing the file
-	if (!should_analyze()) return;
-	analyze_file(our_sym_table);
-	if (log.has_errors()) ERROR_RETURN();
-	
-	// 7. Analyzing all the dependency files
-	if (!analyze_dependencies(our_sym_table)) {
-		ERROR_RETURN();
+	nyla::scheduler scheduler(m_num_jobs);
+	for (sym_table* our_sym_table : sym_tables) {
+		// The main file is always parsed since the
+		// main function is found while parsing
+		if (!our_sym_table->needs_processing() || our_sym_table->m_search_for_main_function) {
+			continue;
+		}
+		scheduler.add_task([this, our_sym_table, gen_obj_code]() {
+			const std::string& internal_path = our_sym_table->get_file_location().internal_path;
+			nyla::interface_file* interface_file = new nyla::interface_file;
+			if (interface_file->read(nyla::interface_file::get_path(m_interface_directory, internal_path,
+				                                                    our_sym_table->m_source_hash)) &&
+				interface_file->get_source_hash() == our_sym_table->m_source_hash &&
+				interface_file->get_internal_path() == internal_path &&
+				(!gen_obj_code || interface_file->is_linkable())) {
+				our_sym_table->set_interface(interface_file);
+			} else {
+				delete interface_file;
+			}
+		});
+	}
+	scheduler.run();
+
+	// The dependencies are part of the key of the cached object
+	for (sym_table* our_sym_table : sym_tables) {
+		nyla::interface_file* interface_file = our_sym_table->get_interface();
+		if (!interface_file) continue;
+		for (const nyla::interface_file::import_info& import : interface_file->get_imports()) {
+			sym_table* dep_sym_table = find_sym_table(import.internal_path);
+			if (dep_sym_table) {
+				our_sym_table->m_dependencies.push_back(dep_sym_table);
+			}
+		}
 	}
 
-	// Freeing the buffer since it was only
-	// need to stay around for errors
-	delete[] buffer;
+	auto remove_interface = [this](sym_table* our_sym_table) {
+		delete our_sym_table->get_interface();
+		our_sym_table->set_interface(nullptr);
+		our_sym_table->m_dependencies.clear();
+		our_sym_table->m_obj_cache_hit = false;
+		m_obj_buffers.erase(our_sym_table);
+	};
+
+	// An interface can only be used if the files it imports
+	// have not changed since it was written. When generating
+	// code the object of the file has to be cached as well
+	bool removed_interface = true;
+	while (removed_interface) {
+		removed_interface = false;
+		for (sym_table* our_sym_table : sym_tables) {
+			nyla::interface_file* interface_file = our_sym_table->get_interface();
+			if (!interface_file) continue;
+			for (const nyla::interface_file::import_info& import : interface_file->get_imports()) {
+				sym_table* dep_sym_table = find_sym_table(import.internal_path);
+				if (!dep_sym_table || dep_sym_table->m_source_hash != import.source_hash ||
+					(!dep_sym_table->m_reused && !dep_sym_table->get_interface())) {
+					remove_interface(our_sym_table);
+					removed_interface = true;
+					break;
+				}
+			}
+		}
+		if (removed_interface || !gen_obj_code) continue;
+
+		nyla::scheduler cache_scheduler(m_num_jobs);
+		for (sym_table* our_sym_table : sym_tables) {
+			if (!our_sym_table->get_interface() || our_sym_table->m_obj_cache_hit) continue;
+			cache_scheduler.add_task([this, our_sym_table]() {
+				find_cached_object(our_sym_table);
+			});
+		}
+		cache_scheduler.run();
+		for (sym_table* our_sym_table : sym_tables) {
+			if (our_sym_table->get_interface() && !our_sym_table->m_obj_cache_hit) {
+				remove_interface(our_sym_table);
+				removed_interface = true;
+			}
+		}
+	}
 
-	// 8. Generating module declarations
-	if (!should_gen_obj_code()) return;
-	gen_type_declarations(our_sym_table);
+	for (sym_table* our_sym_table : sym_tables) {
+		if (our_sym_table->get_interface()) {
+			our_sym_table->m_from_interface = true;
+		}
+	}
+}
+
+void nyla::compiler::load_interfaces(std::vector<sym_table*>& sym_tables) {
+	for (sym_table* our_sym_table : sym_tables) {
+		if (our_sym_table->m_from_interface) {
+			our_sym_table->get_interface()->enter_modules(*this, our_sym_table);
+		}
+	}
+	for (sym_table* our_sym_table : sym_tables) {
+		if (!our_sym_table->m_from_interface) continue;
+		if (m_flags & COMPFLAG_DISPLAY_STAGES) {
+			std::cout << "-- Loading interface: " + our_sym_table->get_file_location().system_path + "\n";
+		}
+		nyla::trace_span span(m_tracer, "file", "Load interface", our_sym_table->get_file_location().system_path);
+		if (!our_sym_table->get_interface()->load_symbols(*this, our_sym_table)) {
+			m_log.global_error(ERR_FAILED_TO_LOAD_INTERFACE,
+				               error_payload::string({ our_sym_table->get_file_location().internal_path }));
+			our_sym_table->m_found_compilation_errors = true;
+			m_found_compilation_errors = true;
+		}
+		// Only the symbols are needed from here on
+		unload_file(our_sym_table);
+	}
+}
 
-	// 9. Generating the module declarations for
-	//    dependency files
-	gen_dependency_type_declarations(our_sym_table);
+void nyla::compiler::write_interface(sym_table* our_sym_table) {
+	std::string path = nyla::interface_file::get_path(m_interface_directory,
+		                                              our_sym_table->get_file_location().internal_path,
+		                                              our_sym_table->m_source_hash);
+	// Failing to write the interface only means the
+	// file has to be processed again the next time
+	nyla::interface_file::write(path, *this, our_sym_table);
+}
 
-	// 10. Generating the function declarations
-	gen_body_declarations(our_sym_table);
+void nyla::compiler::unload_file(sym_table* our_sym_table) {
+	if ((m_flags & COMPFLAG_DISPLAY_MEMORY) && our_sym_table->get_file_unit()) {
+		ulen ast_bytes    = our_sym_table->get_parser() ? our_sym_table->get_parser()->get_ast_bytes() : 0;
+		ulen source_bytes = our_sym_table->get_source_buffer() ? our_sym_table->get_source_buffer_length() : 0;
+		m_total_released_ast_bytes    += ast_bytes;
+		m_total_released_source_bytes += source_bytes;
+		std::cout << "-- Memory released: " + our_sym_table->get_file_location().system_path +
+			         " | ast " + format_bytes(ast_bytes) + ", source " + format_bytes(source_bytes) + "\n";
+	}
 
-	// 11. Generating the function declarations for dependencies
-	gen_dependency_body_declarations(our_sym_table);
+	delete our_sym_table->get_llvm_generator();
+	delete our_sym_table->get_analysis();
+	delete our_sym_table->get_parser();
+	delete our_sym_table->get_file_unit();
+	delete our_sym_table->get_lexer();
+	delete our_sym_table->get_log();
+	delete our_sym_table->get_source();
+	nyla::unmap_file(our_sym_table->get_source_buffer(),
+		             our_sym_table->get_source_buffer_length(), source_padding);
+	delete our_sym_table->get_interface();
+
+	our_sym_table->set_llvm_generator(nullptr);
+	our_sym_table->set_analysis(nullptr);
+	our_sym_table->set_parser(nullptr);
+	our_sym_table->set_file_unit(nullptr);
+	our_sym_table->set_lexer(nullptr);
+	our_sym_table->set_log(nullptr);
+	our_sym_table->set_source(nullptr);
+	our_sym_table->set_source_buffer(nullptr);
+	our_sym_table->set_interface(nullptr);
+}
 
-	// 12.
-	// TODO: comptime function generation needs to happen here
+void nyla::compiler::parse_files(std::vector<sym_table*>& sym_tables) {
+	u64 parse_st = nyla::get_time_in_nanoseconds();
+
+	nyla::scheduler scheduler(m_num_jobs);
+	for (sym_table* our_sym_table : sym_tables) {
+		if (!our_sym_table->needs_processing()) continue;
+		scheduler.add_task([this, our_sym_table]() {
+			std::cout << "-- Processing: " + our_sym_table->get_file_location().system_path + "\n";
+			nyla::trace_span span(m_tracer, "file", "Parse", our_sym_table->get_file_location().system_path);
+			load_file(our_sym_table);
+			nyla::parser* parser = our_sym_table->get_parser();
+			parser->parse_imports();
+			parser->parse_file_unit();
+			if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+				display_file_memory(our_sym_table, get_file_state_name(FS_PARSED));
+			}
+			if (our_sym_table->get_log()->has_errors()) {
+				m_found_compilation_errors = true;
+				our_sym_table->m_found_compilation_errors = true;
+			}
+		});
+	}
+	scheduler.run();
+	
+	m_total_parse_time_in_nanoseconds += nyla::get_time_in_nanoseconds() - parse_st;
+}
 
-	// 13. Generating the llvm function code
+void nyla::compiler::parse_reachable_files(std::vector<sym_table*>& sym_tables, sym_table* main_file_sym_table) {
+	u64 parse_st = nyla::get_time_in_nanoseconds();
+
+	// Only parsing the imports at the top of the files
+	// to find the files the main file depends on
+	nyla::scheduler import_scheduler(m_num_jobs);
+	for (sym_table* our_sym_table : sym_tables) {
+		if (!our_sym_table->needs_processing()) continue;
+		import_scheduler.add_task([this, our_sym_table]() {
+			nyla::trace_span span(m_tracer, "file", "Parse imports",
+				                  our_sym_table->get_file_location().system_path);
+			load_file(our_sym_table);
+			our_sym_table->get_parser()->parse_imports();
+		});
+	}
+	import_scheduler.run();
+
+	std::unordered_set<sym_table*> reachable;
+	std::vector<sym_table*> work_list;
+	reachable.insert(main_file_sym_table);
+	work_list.push_back(main_file_sym_table);
+	while (!work_list.empty()) {
+		sym_table* our_sym_table = work_list.back();
+		work_list.pop_back();
+		std::vector<sym_table*> dep_sym_tables;
+		if (our_sym_table->needs_processing()) {
+			for (auto& pair : our_sym_table->get_file_unit()->imports) {
+				sym_table* dep_sym_table = find_sym_table(pair.first);
+				if (dep_sym_table) dep_sym_tables.push_back(dep_sym_table);
+			}
+		} else {
+			dep_sym_tables = our_sym_table->m_dependencies;
+		}
+		for (sym_table* dep_sym_table : dep_sym_tables) {
+			if (reachable.insert(dep_sym_table).second) {
+				work_list.push_back(dep_sym_table);
+			}
+		}
+	}
 
-	if ((m_flags & COMPFLAG_DISPLAY_LLVM_IR) || (m_flags & COMPFLAG_DISPLAY_STAGES)) {
-		std::cout << "-- LLVM IR: " << source_file.system_path << '\n';
+	nyla::scheduler scheduler(m_num_jobs);
+	for (sym_table* our_sym_table : sym_tables) {
+		if (!our_sym_table->needs_processing()) continue;
+		if (reachable.find(our_sym_table) == reachable.end()) {
+			our_sym_table->m_skipped = true;
+			unload_file(our_sym_table);
+			continue;
+		}
+		scheduler.add_task([this, our_sym_table]() {
+			std::cout << "-- Processing: " + our_sym_table->get_file_location().system_path + "\n";
+			nyla::trace_span span(m_tracer, "file", "Parse", our_sym_table->get_file_location().system_path);
+			our_sym_table->get_parser()->parse_file_unit();
+			if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+				display_file_memory(our_sym_table, get_file_state_name(FS_PARSED));
+			}
+			if (our_sym_table->get_log()->has_errors()) {
+				m_found_compilation_errors = true;
+				our_sym_table->m_found_compilation_errors = true;
+			}
+		});
 	}
-	u64 it_gen_st = nyla::get_time_in_milliseconds();
-	llvm_generator.gen_file_unit();
-	m_total_ir_gen_time_in_milliseconds += nyla::get_time_in_milliseconds() - it_gen_st;
+	scheduler.run();
 
-	parse_st = nyla::get_time_in_milliseconds();
-	// No longer need the AST so to free up memory deleting it
-	delete file_unit;
-	m_total_parse_time_in_milliseconds += nyla::get_time_in_milliseconds() - parse_st;
+	m_total_parse_time_in_nanoseconds += nyla::get_time_in_nanoseconds() - parse_st;
+}
 
-#undef ERROR_RETURN
+void nyla::compiler::find_reachable_functions(std::vector<sym_table*>& sym_tables) {
+	if (m_found_compilation_errors) return;
+	nyla::trace_span span(m_tracer, "compile", "Find reachable functions");
+
+	// The program starts at the main function, the startup
+	// functions and the initializers of the global variables
+	std::vector<sym_function*> work_list;
+	for (sym_table* our_sym_table : sym_tables) {
+		if (!our_sym_table->m_linked) continue;
+		for (sym_module* sym_module : our_sym_table->get_modules()) {
+			for (auto& pair : sym_module->functions) {
+				for (sym_function* sym_function : pair.second) {
+					sym_function->reachable = sym_function->call_at_startup;
+					if (sym_function->reachable) {
+						work_list.push_back(sym_function);
+					}
+				}
+			}
+			for (auto& pair : sym_module->constructors) {
+				for (sym_function* sym_function : pair.second) {
+					sym_function->reachable = false;
+				}
+			}
+		}
+	}
+	for (sym_table* our_sym_table : sym_tables) {
+		if (!our_sym_table->m_linked) continue;
+		for (sym_module* sym_module : our_sym_table->get_modules()) {
+			work_list.insert(work_list.end(),
+				             sym_module->init_called_functions.begin(),
+				             sym_module->init_called_functions.end());
+		}
+	}
+	if (m_main_function) {
+		work_list.push_back(m_main_function);
+	}
+
+	while (!work_list.empty()) {
+		sym_function* sym_function = work_list.back();
+		work_list.pop_back();
+		sym_function->reachable = true;
+		for (nyla::sym_function* called_function : sym_function->called_functions) {
+			if (!called_function->reachable) {
+				called_function->reachable = true;
+				work_list.push_back(called_function);
+			}
+		}
+	}
 }
 
-void nyla::compiler::parse_file(sym_table* our_sym_table) {
-	if (our_sym_table->m_started_parsing) return;
-	u64 parse_st = nyla::get_time_in_milliseconds();
-	our_sym_table->m_started_parsing = true;
-	nyla::parser* parser = our_sym_table->get_parser();
-	parser->parse_imports();
-	parser->parse_file_unit();
-	m_total_parse_time_in_milliseconds += nyla::get_time_in_milliseconds() - parse_st;
+void nyla::compiler::find_dependencies(sym_table* our_sym_table) {
+	nyla::afile_unit* file_unit = our_sym_table->get_file_unit();
+	for (auto& pair : file_unit->imports) {
+		sym_table* dep_sym_table = find_sym_table(pair.first);
+		// Imports that could not be found or files importing
+		// themselves are reported by the parser
+		if (dep_sym_table && dep_sym_table != our_sym_table) {
+			our_sym_table->m_dependencies.push_back(dep_sym_table);
+		}
+	}
 }
 
-void nyla::compiler::parse_dependencies(sym_table* our_sym_table) {
-	import_iterator& it = our_sym_table->m_parse_imports_iterator;
-	while (it != our_sym_table->m_imports_end) {
-		std::string internal_dep_path = it->first;
-		sym_table* dep_sym_table = m_sym_tables[internal_dep_path];
-		if (!dep_sym_table->m_started_processing) {
-			nyla::file_location location = dep_sym_table->get_file_location();
-			process_file(location, dep_sym_table);
+void nyla::compiler::find_import_components(std::vector<sym_table*>& sym_tables) {
+	// Tarjan's strongly connected components algorithm. Uses
+	// an explicit stack so deep import chains cannot overflow
+	// the call stack
+	struct visit_info {
+		u32  index;
+		u32  low_link;
+		bool on_stack;
+	};
+	std::unordered_map<sym_table*, visit_info> visited;
+	std::vector<sym_table*> component_stack;
+	u32 next_index     = 0;
+	u32 next_component = 0;
+
+	struct frame {
+		sym_table* sym_table;
+		u32        next_dependency;
+	};
+
+	for (sym_table* start_sym_table : sym_tables) {
+		if (visited.find(start_sym_table) != visited.end()) continue;
+
+		std::vector<frame> frames;
+		frames.push_back({ start_sym_table, 0 });
+		visited[start_sym_table] = { next_index, next_index, true };
+		++next_index;
+		component_stack.push_back(start_sym_table);
+
+		while (!frames.empty()) {
+			frame& top = frames.back();
+			sym_table* our_sym_table = top.sym_table;
+			if (top.next_dependency < our_sym_table->m_dependencies.size()) {
+				sym_table* dep_sym_table = our_sym_table->m_dependencies[top.next_dependency++];
+				auto it = visited.find(dep_sym_table);
+				if (it == visited.end()) {
+					visited[dep_sym_table] = { next_index, next_index, true };
+					++next_index;
+					component_stack.push_back(dep_sym_table);
+					frames.push_back({ dep_sym_table, 0 });
+				} else if (it->second.on_stack) {
+					visit_info& info = visited[our_sym_table];
+					info.low_link = std::min(info.low_link, it->second.index);
+				}
+				continue;
+			}
+
+			visit_info& info = visited[our_sym_table];
+			if (info.low_link == info.index) {
+				sym_table* member;
+				do {
+					member = component_stack.back();
+					component_stack.pop_back();
+					visited[member].on_stack = false;
+					member->m_import_component = next_component;
+				} while (member != our_sym_table);
+				++next_component;
+			}
+
+			u32 low_link = info.low_link;
+			frames.pop_back();
+			if (!frames.empty()) {
+				visit_info& parent_info = visited[frames.back().sym_table];
+				parent_info.low_link = std::min(parent_info.low_link, low_link);
+			}
 		}
-		if (it != our_sym_table->m_imports_end) {
-			++it;
+	}
+}
+
+void nyla::compiler::find_final_states(std::vector<sym_table*>& sym_tables, sym_table* main_file_sym_table) {
+	file_state other_final_state = FS_IMPORT_RESOLVED;
+	if (should_analyze()) {
+		other_final_state = FS_ANALYZED;
+	}
+	for (sym_table* sym_table : sym_tables) {
+		sym_table->m_final_state = other_final_state;
+		sym_table->m_linked      = false;
+	}
+
+	if (!should_gen_obj_code()) return;
+
+	// Every file the main file depends on gets compiled
+	std::vector<sym_table*> work_list;
+	work_list.push_back(main_file_sym_table);
+	main_file_sym_table->m_final_state = FS_LLVM_IR_GEN;
+	main_file_sym_table->m_linked      = true;
+	while (!work_list.empty()) {
+		sym_table* our_sym_table = work_list.back();
+		work_list.pop_back();
+		for (sym_table* dep_sym_table : our_sym_table->m_dependencies) {
+			if (!dep_sym_table->m_linked) {
+				dep_sym_table->m_final_state = FS_LLVM_IR_GEN;
+				dep_sym_table->m_linked      = true;
+				work_list.push_back(dep_sym_table);
+			}
 		}
 	}
 }
 
-void nyla::compiler::resolve_imports(sym_table* our_sym_table) {
-	if (our_sym_table->m_started_import_resolution) return;
-	our_sym_table->m_started_import_resolution = true;
+void nyla::compiler::process_state(sym_table* our_sym_table, file_state state) {
+	if (our_sym_table->m_found_compilation_errors) return;
+	for (sym_table* dep_sym_table : our_sym_table->m_dependencies) {
+		if (dep_sym_table->m_found_compilation_errors) {
+			our_sym_table->m_found_compilation_errors = true;
+			m_found_compilation_errors = true;
+			return;
+		}
+	}
 
-	if (m_flags & COMPFLAG_DISPLAY_STAGES) {
-		std::cout << "-- Resolving imports: " << our_sym_table->get_file_location().system_path << '\n';
+	{
+		nyla::trace_span span(m_tracer, "file", get_file_state_name(state),
+			                  our_sym_table->get_file_location().system_path);
+		switch (state) {
+		case FS_IMPORT_RESOLVED: resolve_imports(our_sym_table);       break;
+		case FS_ANALYZED:        analyze_file(our_sym_table);          break;
+		case FS_TYPE_DECL_GEN:   gen_type_declarations(our_sym_table); break;
+		case FS_BODY_DECL_GEN:   gen_body_declarations(our_sym_table); break;
+		case FS_LLVM_IR_GEN:     gen_llvm_ir(our_sym_table);           break;
+		default: assert(!"Unreachable!");                              break;
+		}
 	}
 
-	u64 parse_st = nyla::get_time_in_milliseconds();
-	nyla::parser* parser = our_sym_table->get_parser();
-	parser->resolve_imports();
-	m_total_parse_time_in_milliseconds += nyla::get_time_in_milliseconds() - parse_st;
-}
+	if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+		display_file_memory(our_sym_table, get_file_state_name(state));
+	}
+
+	if (our_sym_table->get_log()->has_errors()) {
+		our_sym_table->m_found_compilation_errors = true;
+		m_found_compilation_errors = true;
+		return;
+	}
+
+	if (state == FS_ANALYZED && !m_interface_directory.empty()) {
+		write_interface(our_sym_table);
+	}
 
-bool nyla::compiler::resolve_dependency_imports(sym_table* our_sym_table) {
-	import_iterator& it = our_sym_table->m_resolve_imports_iterator;
-	while (it != our_sym_table->m_imports_end) {
-		std::string internal_dep_path = it->first;
-		sym_table* dep_sym_table = m_sym_tables[internal_dep_path];
-		ensure_state(dep_sym_table, FS_PARSED);
-		if (dep_sym_table->m_found_compilation_errors) return false;
-		resolve_imports(dep_sym_table);
-		if (dep_sym_table->m_found_compilation_errors) return false;
-		if (it != our_sym_table->m_imports_end) {
-			++it;
+	if (state == our_sym_table->m_final_state) {
+		// No longer need the AST so to free up memory deleting it
+		unload_file(our_sym_table);
+	} else if (state == FS_ANALYZED) {
+		// Freeing the buffer since it was only
+		// need to stay around for errors
+		if (m_flags & COMPFLAG_DISPLAY_MEMORY) {
+			m_total_released_source_bytes += our_sym_table->get_source_buffer_length();
+			std::cout << "-- Memory released: " + our_sym_table->get_file_location().system_path +
+				         " | source " + format_bytes(our_sym_table->get_source_buffer_length()) + "\n";
 		}
+		nyla::unmap_file(our_sym_table->get_source_buffer(),
+			             our_sym_table->get_source_buffer_length(), source_padding);
+		our_sym_table->set_source_buffer(nullptr);
 	}
-	return true;
 }
 
-void nyla::compiler::analyze_file(sym_table* our_sym_table) {
-	if (our_sym_table->m_started_analysis) return;
-	our_sym_table->m_started_analysis = true;
-
+void nyla::compiler::resolve_imports(sym_table* our_sym_table) {
 	if (m_flags & COMPFLAG_DISPLAY_STAGES) {
-		std::cout << "-- Analyzing: " << our_sym_table->get_file_location().system_path << '\n';
+		std::cout << "-- Resolving imports: " + our_sym_table->get_file_location().system_path + "\n";
 	}
-	
-	u64 parse_st = nyla::get_time_in_milliseconds();
-	our_sym_table->get_analysis()->check_file_unit();
-	m_total_parse_time_in_milliseconds += nyla::get_time_in_milliseconds() - parse_st;
-	
+
+	u64 parse_st = nyla::get_time_in_nanoseconds();
+	nyla::parser* parser = our_sym_table->get_parser();
+	parser->resolve_imports();
+	m_total_parse_time_in_nanoseconds += nyla::get_time_in_nanoseconds() - parse_st;
 }
 
-bool nyla::compiler::analyze_dependencies(sym_table* our_sym_table) {
-	import_iterator& it = our_sym_table->m_analyze_imports_iterator;
-	while (it != our_sym_table->m_imports_end) {
-		std::string internal_dep_path = it->first;
-		sym_table* dep_sym_table = m_sym_tables[internal_dep_path];
-		if (dep_sym_table->m_found_compilation_errors) return false;
-		ensure_state(dep_sym_table, FS_IMPORT_RESOLVED);
-		analyze_file(dep_sym_table);
-		if (dep_sym_table->m_found_compilation_errors) return false;
-		if (it != our_sym_table->m_imports_end) {
-			++it;
-		}
+void nyla::compiler::analyze_file(sym_table* our_sym_table) {
+	if (m_flags & COMPFLAG_DISPLAY_STAGES) {
+		std::cout << "-- Analyzing: " + our_sym_table->get_file_location().system_path + "\n";
 	}
-	return true;
+	
+	u64 analysis_st = nyla::get_time_in_nanoseconds();
+	nyla::analysis* analysis = new nyla::analysis(*this, *our_sym_table->get_log(), our_sym_table,
+		                                          our_sym_table->get_file_unit());
+	our_sym_table->set_analysis(analysis);
+	analysis->check_file_unit();
+	nyla::llvm_generator::name_symbols(*this, our_sym_table);
+	m_total_analysis_time_in_nanoseconds += nyla::get_time_in_nanoseconds() - analysis_st;
 }
 
 void nyla::compiler::gen_type_declarations(sym_table* our_sym_table) {
-	if (our_sym_table->m_started_ir_module_declaration_gen) return;
-	our_sym_table->m_started_ir_module_declaration_gen = true;
-
 	if (m_flags & COMPFLAG_DISPLAY_STAGES) {
-		std::cout << "-- Gen module decls: " << our_sym_table->get_file_location().system_path << '\n';
+		std::cout << "-- Gen module decls: " + our_sym_table->get_file_location().system_path + "\n";
 	}
 
-	llvm_generator* llvm_generator = our_sym_table->get_llvm_generator();
+	// Each file generates its IR in a context of its own
+	llvm::LLVMContext* llvm_context = new llvm::LLVMContext;
+	llvm::Module* llvm_module =
+		new llvm::Module(our_sym_table->get_file_location().internal_path, *llvm_context);
+	our_sym_table->set_llvm_context(llvm_context);
+	our_sym_table->set_llvm_module(llvm_module);
+	nyla::llvm_generator* llvm_generator =
+		new nyla::llvm_generator(*this, llvm_module, our_sym_table,
+			                     m_flags & COMPFLAG_DISPLAY_LLVM_IR);
+	our_sym_table->set_llvm_generator(llvm_generator);
+	// The code of the file is already in the object cache
+	llvm_generator->set_declarations_only(our_sym_table->m_obj_cache_hit);
 	llvm_generator->gen_type_declarations();
 }
 
-void nyla::compiler::gen_dependency_type_declarations(sym_table* our_sym_table) {
-	import_iterator& it = our_sym_table->m_gen_type_decl_iterator;
-	while (it != our_sym_table->m_imports_end) {
-		std::string internal_dep_path = it->first;
-		sym_table* dep_sym_table = m_sym_tables[internal_dep_path];
-		ensure_state(dep_sym_table, FS_ANALYZED);
-		gen_type_declarations(dep_sym_table);
-		if (it != our_sym_table->m_imports_end) {
-			++it;
-		}
-	}
-}
-
 void nyla::compiler::gen_body_declarations(sym_table* our_sym_table) {
-	if (our_sym_table->m_started_ir_func_declaration_gen) return;
-	our_sym_table->m_started_ir_func_declaration_gen = true;
-
 	if (m_flags & COMPFLAG_DISPLAY_STAGES) {
-		std::cout << "-- Gen function decls: " << our_sym_table->get_file_location().system_path << '\n';
+		std::cout << "-- Gen function decls: " + our_sym_table->get_file_location().system_path + "\n";
 	}
 
 	llvm_generator* llvm_generator = our_sym_table->get_llvm_generator();
 	llvm_generator->gen_body_declarations();
 }
 
-void nyla::compiler::gen_dependency_body_declarations(sym_table* our_sym_table) {
-	import_iterator& it = our_sym_table->m_gen_body_decl_iterator;
-	while (it != our_sym_table->m_imports_end) {
-		std::string internal_dep_path = it->first;
-		sym_table* dep_sym_table = m_sym_tables[internal_dep_path];
-		ensure_state(dep_sym_table, FS_TYPE_DECL_GEN);
-		gen_body_declarations(dep_sym_table);
-		if (it != our_sym_table->m_imports_end) {
-			++it;
-		}
+void nyla::compiler::gen_llvm_ir(sym_table* our_sym_table) {
+	if ((m_flags & COMPFLAG_DISPLAY_LLVM_IR) || (m_flags & COMPFLAG_DISPLAY_STAGES)) {
+		std::cout << "-- LLVM IR: " + our_sym_table->get_file_location().system_path + "\n";
 	}
-}
 
-void nyla::compiler::ensure_state(sym_table* dep_sym_table, file_state state) {
-	parse_dependencies(dep_sym_table);
-	if (state < FS_IMPORT_RESOLVED) return;
-	resolve_dependency_imports(dep_sym_table);
-	if (state < FS_ANALYZED) return;
-	analyze_dependencies(dep_sym_table);
-	if (state < FS_TYPE_DECL_GEN) return;
-	gen_dependency_type_declarations(dep_sym_table);
-	if (state < FS_BODY_DECL_GEN) return;
-	gen_dependency_body_declarations(dep_sym_table);
+	// TODO: comptime function generation needs to happen here
+
+	u64 it_gen_st = nyla::get_time_in_nanoseconds();
+	if (our_sym_table->m_obj_cache_hit) {
+		our_sym_table->get_llvm_generator()->gen_file_unit_globals();
+	} else {
+		our_sym_table->get_llvm_generator()->gen_file_unit();
+	}
+	m_total_ir_gen_time_in_nanoseconds += nyla::get_time_in_nanoseconds() - it_gen_st;
 }
 
 void nyla::compiler::completely_cleanup() {
-	nyla::g_type_table->clear_table();
-	nyla::g_word_table->clear_table();
-	delete m_llvm_module;
-	delete nyla::llvm_context;
+	for (auto& pair : m_sym_tables) {
+		delete_sym_table(pair.second);
+	}
+	m_sym_tables.clear();
+	// The module types refer to the deleted modules. The words
+	// are kept since the reserved words are looked up by key
+	m_context.get_type_table().clear_table();
 }
\ No newline at end of file
@@ -3,17 +3,21 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <mutex>
 #include <llvm/IR/Module.h>
 #include <llvm/Target/TargetMachine.h>
 
+#include "code_gen.h"
 #include "sym_table.h"
 #include "log.h"
 #include "file_location.h"
+#include "trace.h"
+#include "compilation_context.h"
 
 namespace nyla {
 
-	extern llvm::LLVMContext* llvm_context;
-
 	struct avariable_decl;
 
 	enum compiler_flags {
@@ -45,9 +49,60 @@ namespace nyla {
 		// Enables displaying how long it takes to
 		// process different parts of the file
 		COMPFLAG_DISPLAY_TIMES          = 0x0080,
+		// Optimization level of the generated code. These
+		// are values within COMPFLAGS_OPT_LEVEL rather than
+		// individual bits. No value means O0
+		COMPFLAG_OPT_O1                 = 0x0100,
+		COMPFLAG_OPT_O2                 = 0x0200,
+		COMPFLAG_OPT_O3                 = 0x0300,
+		COMPFLAG_OPT_Os                 = 0x0400,
+		COMPFLAGS_OPT_LEVEL             = 0x0700,
+		// Compiles the program in memory and runs it
+		// instead of writing an executable
+		COMPFLAG_RUN                    = 0x0800,
+		// Link time optimization. These are values within
+		// COMPFLAGS_LTO. No value means no LTO
+		COMPFLAG_LTO_THIN               = 0x1000,
+		COMPFLAG_LTO_FULL               = 0x2000,
+		COMPFLAGS_LTO                   = 0x3000,
+		// Enables displaying how much memory is used
+		// after each stage of each file
+		COMPFLAG_DISPLAY_MEMORY         = 0x4000,
 	};
 
-	extern llvm::TargetMachine* g_llvm_target_machine;
+	/*
+	 * Changes to the source directories since the previous
+	 * compile as seen by a file watcher. The paths are system
+	 * paths the same as the ones found by searching the source
+	 * directories.
+	 */
+	struct source_changes {
+		std::vector<std::string> modified_files;
+		std::vector<std::string> created_files;
+		std::vector<std::string> deleted_files;
+		// The files within created directories are searched for
+		// while deleted directories remove every file within them
+		std::vector<std::string> created_directories;
+		std::vector<std::string> deleted_directories;
+	};
+
+	/*
+	 * How long each stage of a compile took in nanoseconds.
+	 * Parsing is the time spent parsing all the files while
+	 * analysis and LLVM IR are the sums of the time spent on
+	 * each file so they count the time of every thread. Stages
+	 * which did not run are left as 0.
+	 */
+	struct compile_times {
+		u64 parse        = 0;
+		u64 analysis     = 0;
+		u64 llvm_ir      = 0;
+		u64 optimization = 0;
+		u64 emit         = 0;
+		u64 lto          = 0;
+		u64 link         = 0;
+		u64 jit          = 0;
+	};
 
 	/*
 	 * Main class for compilation.
@@ -70,87 +125,233 @@ namespace nyla {
 		void set_found_compilation_errors() { m_found_compilation_errors = true; }
 		bool get_found_compilation_errors() const { return m_found_compilation_errors; }
 
-		void set_main_function(sym_function* main_function);
+		// Exit code of the program when it was run with COMPFLAG_RUN
+		s32 get_run_exit_code() const { return m_run_exit_code; }
 
-		u32 get_new_unique_module_id();
+		// How long the stages of the last compile took
+		const nyla::compile_times& get_compile_times() const { return m_compile_times; }
 
-		u32 get_num_global_const_array_count();
-		u32 get_num_global_variable_count();
-		u32 get_num_functions_count();
+		void set_main_function(sym_function* main_function);
 
-		void add_global_initialize_expr(nyla::avariable_decl* expr);
-		void add_startup_function(llvm::Function* ll_startup_function);
+		u32 get_new_unique_module_id();
 
 		void set_executable_name(const std::string& executable_name);
 
+		// Sets the CPU, features, and relocation and code
+		// models of the generated machine code
+		void set_target_options(const nyla::target_options& target_options);
+
+		// Sets the number of threads used to process the
+		// source files
+		void set_num_jobs(u32 num_jobs);
+
+		// Keeps the symbol tables and object code of files between
+		// calls to compile. Files whose contents did not change, and
+		// whose imports did not change, are not processed again. Every
+		// function of a compiled file gets a body so the file can be
+		// reused no matter which files call into it later
+		void set_reuse_sym_tables(bool reuse_sym_tables);
+
+		// Writes an interface file for every analyzed file into the
+		// directory. Files which have not changed since their interface
+		// was written are loaded from it instead of being parsed and
+		// analyzed as long as they do not need to be compiled
+		void set_interface_directory(const std::string& interface_directory);
+
+		// Keeps the object code of every compiled file in the directory.
+		// The code is looked up by the contents of the file and the files
+		// it depends on, the flags and the target so the same file is not
+		// compiled again by a later build
+		void set_object_cache_directory(const std::string& object_cache_directory);
+
+		// Tells the next compile what changed since the previous one.
+		// The source directories are then not searched again and only
+		// the changed files are read. Only used while symbol tables are
+		// reused and the source directories stay the same
+		void set_source_changes(const nyla::source_changes& source_changes);
+
+		// Writes a trace of the time spent on every file, stage,
+		// function and LLVM pass of a compile to the file. Viewed
+		// with chrome://tracing or Perfetto. Empty to not trace
+		void set_trace_file(const std::string& trace_file);
+
+		// Writes a Make style dependency file listing every source file
+		// the executable was built from. Those are the main file and the
+		// files it imports directly or through other files. Empty to not
+		// write one
+		void set_deps_file(const std::string& deps_file);
+
+		// Writes the imports of the files the executable was built from.
+		// Written as JSON if the file ends with .json and otherwise in
+		// the DOT format of Graphviz. Empty to not write one
+		void set_graph_file(const std::string& graph_file);
+
+		// Words, types and the target machine shared by the
+		// files of this compiler
+		nyla::compilation_context& get_context() { return m_context; }
+
+		// Tracer of the current compile or nullptr if not tracing
+		nyla::tracer* get_tracer() { return m_tracer; }
+
 		// Cleanup anything allocated
 		void completely_cleanup();
 
 	private:
 
+		void compile_program(const std::vector<std::string>& src_directories, const std::string& main_function_path);
+
+		// The main file and every file it imports directly or through
+		// other files sorted by their internal paths
+		std::vector<sym_table*> find_imported_files();
+
+		bool write_deps_file(const std::vector<sym_table*>& sym_tables);
+
+		bool write_graph_file(const std::vector<sym_table*>& sym_tables);
+
 		// Searches for .nyla files in the directory. Decends into sub-directories
-		void collect_source_files(const std::string& directory, 
+		bool collect_source_files(const std::string& directory, 
 			                      const std::string& directory_rel_src,
 			                      std::vector<file_location>& source_files);
 
-		void process_files(std::vector<file_location>& source_files);
-		void process_file(const file_location& source_file, sym_table* our_sym_table);
+		// Applies the changes given by set_source_changes to
+		// the source files found by the previous compile
+		bool apply_source_changes(const std::vector<std::string>& src_directories,
+			                      std::vector<file_location>& source_files);
+
+		void process_files(std::vector<file_location>& source_files,
+			               std::unordered_map<std::string, sym_table*>& old_sym_tables);
+
+		// Reads every source file and hashes its contents
+		bool read_files(std::vector<sym_table*>& sym_tables);
+
+		// Replaces the new symbol tables with the ones from the
+		// previous compile for files which have not changed and
+		// only import files which have not changed. Deletes the
+		// old symbol tables which are not reused
+		void reuse_sym_tables(std::vector<sym_table*>& sym_tables,
+			                  std::unordered_map<std::string, sym_table*>& old_sym_tables);
+
+		// Parses the files the main file depends on. Only the
+		// imports of the other files are parsed and the files
+		// are marked as skipped
+		void parse_reachable_files(std::vector<sym_table*>& sym_tables, sym_table* main_file_sym_table);
+
+		// Marks the functions which may be called starting from the
+		// main function, the startup functions and the initializers
+		// of global variables. The rest do not get a body generated
+		void find_reachable_functions(std::vector<sym_table*>& sym_tables);
+
+		// Reads the interfaces of files which have not changed
+		// and whose imports have not changed. When generating
+		// code the object of the file also has to be cached
+		void find_interface_files(std::vector<sym_table*>& sym_tables);
+
+		// Loads the symbols of the files from their interfaces
+		void load_interfaces(std::vector<sym_table*>& sym_tables);
+
+		void write_interface(sym_table* our_sym_table);
+
+		// Looks up the object code of the compiled files
+		// in the object cache
+		void find_cached_objects(std::vector<sym_table*>& sym_tables);
+
+		// Looks up the object code of the file in the object cache.
+		// When unreachable functions are skipped this runs as a task
+		// once the reachable functions are known
+		void find_cached_object(sym_table* our_sym_table);
 
-		// Parses a file for a given symbol table
-		void parse_file(sym_table* our_sym_table);
+		u64 get_object_cache_key(sym_table* our_sym_table);
 
-		// Parses dependencies found in the imports of the symbol table
-		void parse_dependencies(sym_table* our_sym_table);
+		std::string get_object_cache_path(sym_table* our_sym_table);
+
+		// Deletes the symbol table along with the llvm module
+		// and object code kept for it
+		void delete_sym_table(sym_table* our_sym_table);
+
+		// Creates the lexer and parser for the file's buffer.
+		// Safe to call from multiple threads for different
+		// symbol tables
+		void load_file(sym_table* our_sym_table);
+
+		// Frees everything that was created to process the file
+		void unload_file(sym_table* our_sym_table);
+
+		// Lexes and parses every source file which is not reused
+		// on m_num_jobs threads before any import resolution takes
+		// place
+		void parse_files(std::vector<sym_table*>& sym_tables);
+
+		// Fills in the dependencies of the symbol table based
+		// on the imports found while parsing
+		void find_dependencies(sym_table* our_sym_table);
+
+		// Groups files whose imports form a cycle into the same
+		// import component
+		void find_import_components(std::vector<sym_table*>& sym_tables);
+
+		// Decides how far each file needs to be processed. Files
+		// the main file depends on are fully compiled while the
+		// rest only go through analysis unless symbol tables are
+		// reused
+		void find_final_states(std::vector<sym_table*>& sym_tables, sym_table* main_file_sym_table);
 
 		// Resolves the imports and fixes the types associated
 		// with the imported modules
 		void resolve_imports(sym_table* our_sym_table);
 
-		// Resolving the imports of dependencies if they have
-		// not been resolved yet
-		bool resolve_dependency_imports(sym_table* our_sym_table);
-
 		// Performs type checking, flow control checks and more
 		void analyze_file(sym_table* our_sym_table);
 
-		// Analyzes the imported files
-		bool analyze_dependencies(sym_table* our_sym_table);
-
 		// Generates the llvm struct type for the modules in the file
 		void gen_type_declarations(sym_table* our_sym_table);
 
-		// Generating the module declarations for dependencies
-		void gen_dependency_type_declarations(sym_table* our_sym_table);
-
 		// Generates the llvm functions and type fields
 		// for the modules in the file
 		void gen_body_declarations(sym_table* our_sym_table);
 
-		// Generating the function declarations for dependencies
-		void gen_dependency_body_declarations(sym_table* our_sym_table);
+		// Generates the llvm function code for the modules in the file
+		void gen_llvm_ir(sym_table* our_sym_table);
 
-		enum file_state {
-			FS_PARSED = 1,
-			FS_IMPORT_RESOLVED,
-			FS_ANALYZED,
-			FS_TYPE_DECL_GEN,
-			FS_BODY_DECL_GEN,
-		};
-
-		// Before a file can process a certain state it's dependencies
-		// must have their states updated to the state needed to process
-		// this certain state. For example, before processing analysis
-		// a file must have it's dependency files parsed and imports resolved
-		void ensure_state(sym_table* dep_sym_table, file_state state);
+		// Runs a single state for a file. Called by the scheduler
+		// once the states this state depends on have finished
+		void process_state(sym_table* our_sym_table, file_state state);
 
 		bool should_analyze() { return (m_flags & COMPFLAGS_FULL_COMPILATION) >= COMPFLAG_ONLY_PARSE_AND_ANALYZE; }
 		bool should_gen_obj_code() { return (m_flags & COMPFLAGS_FULL_COMPILATION) >= COMPFLAG_ONLY_GEN_OBJECT; }
+		// Kept symbol tables may be compiled again for programs which
+		// call other functions so they need every body. Cached objects
+		// are keyed by the functions which were given a body
+		bool should_skip_unreachable_functions() {
+			return should_gen_obj_code() && !m_reuse_sym_tables;
+		}
+		// Code compiled in memory is not kept in the cache
+		bool should_use_object_cache() {
+			return !m_object_cache_directory.empty() && should_gen_obj_code() && !(m_flags & COMPFLAG_RUN);
+		}
+
+		nyla::opt_level get_opt_level();
+
+		nyla::lto_mode get_lto_mode();
 
-		// Primary module all the IR is dumped into
-		llvm::Module* m_llvm_module;
+		void display_time(c_string label, u64 time_in_nanoseconds);
+
+		// Displays the memory used by the process
+		void display_memory(c_string label);
+
+		// Displays the memory used by the process along with the
+		// memory held for the file once it finished the stage
+		void display_file_memory(sym_table* our_sym_table, c_string stage);
+
+		// Displays the memory held by the tables shared between
+		// files and the totals for every file
+		void display_memory_totals();
+
+		// Declared first so it outlives everything which
+		// refers to it
+		nyla::compilation_context m_context;
 
 		// If true the compiler will not generate object code.
-		bool m_found_compilation_errors = false;
+		std::atomic<bool> m_found_compilation_errors{ false };
 
 		// For logging global errors
 		nyla::log m_log;
@@ -181,22 +382,62 @@ namespace nyla {
 
 		// A unique id that identifiers a module accross the entire program not
 		// just based on it's name
-		u32 unique_module_id_count = 0;
+		std::atomic<u32> unique_module_id_count{ 0 };
+
+		nyla::target_options m_target_options;
+
+		s32 m_run_exit_code = 0;
+
+		bool m_reuse_sym_tables = false;
+
+		// Empty if interfaces are not used
+		std::string m_interface_directory;
+
+		// Empty if the object cache is not used
+		std::string m_object_cache_directory;
+
+		// Empty if compiles are not traced
+		std::string   m_trace_file;
+		nyla::tracer* m_tracer = nullptr;
+
+		// Empty if the files are not written
+		std::string m_deps_file;
+		std::string m_graph_file;
+
+		// Source files found by the previous compile and the
+		// directories they were found in
+		std::vector<std::string>   m_collected_src_directories;
+		std::vector<file_location> m_collected_source_files;
+
+		bool                 m_has_source_changes = false;
+		nyla::source_changes m_source_changes;
+		// Set while compiling with known changes. Files which
+		// are not in m_changed_source_paths are unchanged
+		bool                            m_source_changes_known = false;
+		std::unordered_set<std::string> m_changed_source_paths;
+
+		// What the kept symbol tables were compiled with. Symbol
+		// tables are only reused if the code would be generated
+		// the same way
+		bool                 m_compiled_before = false;
+		u32                  m_compiled_flags  = 0;
+		nyla::target_options m_compiled_target_options;
 
-		u64 m_total_parse_time_in_milliseconds  = 0;
-		u64 m_total_ir_gen_time_in_milliseconds = 0;
+		// Object code of the files kept between compiles
+		std::unordered_map<sym_table*, llvm::SmallVector<char, 0>> m_obj_buffers;
+		// Guards m_obj_buffers while cached objects are read
+		std::mutex                                                 m_obj_buffers_mutex;
 
-		u32 m_num_global_const_array_count = 0;
-		u32 m_num_global_variable_count    = 0;
-		u32 m_num_functions_count          = 0;
+		// Number of threads used for processing files
+		u32 m_num_jobs = 1;
 
-		// some global variables must be initialized by function
-		// so the expressions are stored for computation at a later
-		// time.
-		std::vector<nyla::avariable_decl*> m_global_initializer_exprs;
+		std::atomic<u64> m_total_parse_time_in_nanoseconds{ 0 };
+		std::atomic<u64> m_total_analysis_time_in_nanoseconds{ 0 };
+		std::atomic<u64> m_total_ir_gen_time_in_nanoseconds{ 0 };
+		nyla::compile_times m_compile_times;
 
-		// Functions that need to be called at startup
-		std::vector<llvm::Function*> m_startup_functions;
+		std::atomic<u64> m_total_released_ast_bytes{ 0 };
+		std::atomic<u64> m_total_released_source_bytes{ 0 };
 
 		// The file where the main function (entry point) of
 		// the program is found. If multiple main functions are found
@@ -0,0 +1,447 @@
+#include "interface.h"
+
+#include "compiler.h"
+#include "ast.h"
+#include "words.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+// Changed whenever the layout of the interface changes
+static constexpr u32 INTERFACE_MAGIC   = 0x49414C4E; // "NLAI"
+static constexpr u32 INTERFACE_VERSION = 2;
+
+// Written in place of a type for functions without
+// a return type such as constructors
+static constexpr u8 NO_TYPE_TAG = 0xFF;
+
+static void write_u8(std::string& data, u8 value) {
+	data.push_back((c8)value);
+}
+
+static void write_u32(std::string& data, u32 value) {
+	data.append((const c8*)&value, sizeof(value));
+}
+
+static void write_u64(std::string& data, u64 value) {
+	data.append((const c8*)&value, sizeof(value));
+}
+
+static void write_string(std::string& data, const std::string& value) {
+	write_u32(data, value.size());
+	data.append(value);
+}
+
+static std::string get_word_string(nyla::word_table& word_table, u32 word_key) {
+	return word_table.get_word(word_key).c_str();
+}
+
+static bool write_type(std::string& data, nyla::word_table& word_table, nyla::type* type) {
+	if (!type) {
+		write_u8(data, NO_TYPE_TAG);
+		return true;
+	}
+	switch (type->tag) {
+	case nyla::TYPE_PTR:
+	case nyla::TYPE_ARR:
+		write_u8(data, type->tag);
+		return write_type(data, word_table, type->element_type);
+	case nyla::TYPE_MODULE:
+		write_u8(data, type->tag);
+		write_string(data, type->sym_module->internal_path);
+		write_string(data, get_word_string(word_table, type->sym_module->name_key));
+		return true;
+	case nyla::TYPE_MIXED:
+	case nyla::TYPE_FD_MODULE:
+	case nyla::TYPE_ERROR:
+		// Types that only exist while the file is
+		// being processed
+		return false;
+	default:
+		write_u8(data, type->tag);
+		return true;
+	}
+}
+
+static nyla::type* get_primitive_type(const nyla::builtin_types& types, nyla::type_tag tag) {
+	switch (tag) {
+	case nyla::TYPE_BYTE:   return types.type_byte;
+	case nyla::TYPE_SHORT:  return types.type_short;
+	case nyla::TYPE_INT:    return types.type_int;
+	case nyla::TYPE_LONG:   return types.type_long;
+	case nyla::TYPE_UBYTE:  return types.type_ubyte;
+	case nyla::TYPE_USHORT: return types.type_ushort;
+	case nyla::TYPE_UINT:   return types.type_uint;
+	case nyla::TYPE_ULONG:  return types.type_ulong;
+	case nyla::TYPE_CHAR8:  return types.type_char8;
+	case nyla::TYPE_CHAR16: return types.type_char16;
+	case nyla::TYPE_CHAR32: return types.type_char32;
+	case nyla::TYPE_FLOAT:  return types.type_float;
+	case nyla::TYPE_DOUBLE: return types.type_double;
+	case nyla::TYPE_BOOL:   return types.type_bool;
+	case nyla::TYPE_VOID:   return types.type_void;
+	case nyla::TYPE_NULL:   return types.type_null;
+	case nyla::TYPE_STRING: return types.type_string;
+	default:                return nullptr;
+	}
+}
+
+static bool write_function(std::string& data, nyla::word_table& word_table, nyla::sym_function* sym_function) {
+	write_string(data, get_word_string(word_table, sym_function->name_key));
+	write_u32(data, sym_function->mods);
+	if (!write_type(data, word_table, sym_function->return_type)) return false;
+	write_u32(data, sym_function->param_types.size());
+	for (nyla::type* param_type : sym_function->param_types) {
+		if (!write_type(data, word_table, param_type)) return false;
+	}
+	write_u32(data, sym_function->line_num);
+	write_u8(data, sym_function->is_memcpy);
+	write_u8(data, sym_function->call_at_startup);
+	write_string(data, sym_function->ll_name);
+	return true;
+}
+
+// Importers generate the field initializers of the modules they
+// use and the init function generates the initializers of the
+// globals. A file without any of them or startup functions has
+// all of its code in its own object
+static bool is_linkable_from_interface(nyla::afile_unit* file_unit) {
+	for (nyla::amodule* nmodule : file_unit->modules) {
+		for (nyla::avariable_decl* field : nmodule->sym_module->fields) {
+			if (field->assignment) return false;
+		}
+		// Same globals which gen_global_variable leaves for the init function
+		for (nyla::avariable_decl* global : nmodule->globals) {
+			if (global->type->tag == nyla::TYPE_ARR || global->type->tag == nyla::TYPE_MODULE) return false;
+			if (global->assignment && !global->assignment->literal_constant)                 return false;
+		}
+		for (nyla::afunction* function : nmodule->functions) {
+			if (function->sym_function->call_at_startup) return false;
+		}
+	}
+	return true;
+}
+
+// Functions ordered by name so the interface is the
+// same every time the file is compiled
+static std::vector<nyla::sym_function*> get_sorted_functions(
+	nyla::word_table& word_table,
+	const std::unordered_map<u32, std::vector<nyla::sym_function*>>& functions) {
+	std::vector<std::pair<std::string, const std::vector<nyla::sym_function*>*>> named_functions;
+	for (auto& pair : functions) {
+		named_functions.push_back({ get_word_string(word_table, pair.first), &pair.second });
+	}
+	std::sort(named_functions.begin(), named_functions.end(),
+		[](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+	std::vector<nyla::sym_function*> sorted_functions;
+	for (auto& pair : named_functions) {
+		sorted_functions.insert(sorted_functions.end(), pair.second->begin(), pair.second->end());
+	}
+	return sorted_functions;
+}
+
+std::string nyla::interface_file::get_path(const std::string& directory,
+	                                       const std::string& internal_path,
+	                                       u64 source_hash) {
+	c8 hash_string[17];
+	snprintf(hash_string, sizeof(hash_string), "%016llx", (unsigned long long)source_hash);
+	return directory + "/" + nyla::replace(internal_path, "/", ".") + "." + hash_string + ".nylai";
+}
+
+bool nyla::interface_file::write(const std::string& path, nyla::compiler& compiler, sym_table* our_sym_table) {
+	nyla::word_table& word_table = compiler.get_context().get_word_table();
+
+	std::string data;
+	write_u32(data, INTERFACE_MAGIC);
+	write_u32(data, INTERFACE_VERSION);
+	write_u64(data, our_sym_table->m_source_hash);
+	write_string(data, our_sym_table->get_file_location().internal_path);
+	write_u8(data, is_linkable_from_interface(our_sym_table->get_file_unit()));
+
+	std::vector<sym_table*> imports = our_sym_table->m_dependencies;
+	std::sort(imports.begin(), imports.end(), [](sym_table* lhs, sym_table* rhs) {
+		return lhs->get_file_location().internal_path < rhs->get_file_location().internal_path;
+	});
+	write_u32(data, imports.size());
+	for (sym_table* import_sym_table : imports) {
+		write_string(data, import_sym_table->get_file_location().internal_path);
+		write_u64(data, import_sym_table->m_source_hash);
+	}
+
+	std::vector<sym_module*> modules = our_sym_table->get_modules();
+	std::sort(modules.begin(), modules.end(), [&word_table](sym_module* lhs, sym_module* rhs) {
+		return get_word_string(word_table, lhs->name_key) < get_word_string(word_table, rhs->name_key);
+	});
+	write_u32(data, modules.size());
+	for (sym_module* sym_module : modules) {
+		write_string(data, get_word_string(word_table, sym_module->name_key));
+		write_u32(data, sym_module->mods);
+		write_u8(data, sym_module->no_constructors_found);
+	}
+
+	for (sym_module* sym_module : modules) {
+		// Fields and static variables
+		std::vector<std::pair<std::string, sym_variable*>> variables;
+		for (auto& pair : sym_module->scope->variables) {
+			variables.push_back({ get_word_string(word_table, pair.first), pair.second });
+		}
+		std::sort(variables.begin(), variables.end(),
+			[](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+		write_u32(data, variables.size());
+		for (auto& pair : variables) {
+			sym_variable* sym_variable = pair.second;
+			write_string(data, pair.first);
+			write_u32(data, sym_variable->mods);
+			if (!write_type(data, word_table, sym_variable->type)) return false;
+			write_u8(data, sym_variable->is_field);
+			write_u8(data, sym_variable->is_global);
+			write_u32(data, sym_variable->is_field ? sym_variable->field_index : 0);
+			write_string(data, sym_variable->ll_name);
+			write_u32(data, sym_variable->computed_arr_dim_sizes.size());
+			for (u32 dim_size : sym_variable->computed_arr_dim_sizes) {
+				write_u32(data, dim_size);
+			}
+		}
+
+		// Order of the fields within the module
+		write_u32(data, sym_module->fields.size());
+		for (nyla::avariable_decl* field : sym_module->fields) {
+			write_string(data, get_word_string(word_table, field->name_key));
+			write_u8(data, field->default_initialize);
+		}
+
+		std::vector<sym_function*> functions = get_sorted_functions(word_table, sym_module->functions);
+		write_u32(data, functions.size());
+		for (sym_function* sym_function : functions) {
+			if (!write_function(data, word_table, sym_function)) return false;
+		}
+
+		std::vector<sym_function*> constructors = get_sorted_functions(word_table, sym_module->constructors);
+		write_u32(data, constructors.size());
+		for (sym_function* sym_function : constructors) {
+			if (!write_function(data, word_table, sym_function)) return false;
+		}
+	}
+
+	return nyla::write_file(path, data.data(), data.size());
+}
+
+bool nyla::interface_file::read(const std::string& path) {
+	c8* buffer;
+	ulen buffer_len;
+	if (!nyla::read_file(path, buffer, buffer_len)) {
+		return false;
+	}
+	m_data.assign(buffer, buffer_len);
+	delete[] buffer;
+	m_offset = 0;
+
+	u32 magic, version;
+	if (!read_u32(magic) || magic != INTERFACE_MAGIC)       return false;
+	if (!read_u32(version) || version != INTERFACE_VERSION) return false;
+	if (!read_u64(m_source_hash))                           return false;
+	if (!read_string(m_internal_path))                      return false;
+	u8 linkable;
+	if (!read_u8(linkable))                                 return false;
+	m_linkable = linkable;
+
+	u32 num_imports;
+	if (!read_u32(num_imports)) return false;
+	m_imports.resize(num_imports);
+	for (import_info& import : m_imports) {
+		if (!read_string(import.internal_path)) return false;
+		if (!read_u64(import.source_hash))      return false;
+	}
+
+	u32 num_modules;
+	if (!read_u32(num_modules)) return false;
+	m_module_headers.resize(num_modules);
+	for (module_header& header : m_module_headers) {
+		u8 no_constructors_found;
+		if (!read_string(header.name))        return false;
+		if (!read_u32(header.mods))           return false;
+		if (!read_u8(no_constructors_found))  return false;
+		header.no_constructors_found = no_constructors_found;
+	}
+	return true;
+}
+
+void nyla::interface_file::enter_modules(nyla::compiler& compiler, sym_table* our_sym_table) {
+	nyla::word_table& word_table = compiler.get_context().get_word_table();
+	for (const module_header& header : m_module_headers) {
+		u32 name_key = word_table.get_key(header.name.c_str());
+		sym_module* sym_module = our_sym_table->enter_module(name_key);
+		sym_module->name_key              = name_key;
+		sym_module->mods                  = header.mods;
+		sym_module->internal_path         = m_internal_path;
+		sym_module->unique_module_id      = compiler.get_new_unique_module_id();
+		sym_module->no_constructors_found = header.no_constructors_found;
+		sym_module->scope                 = new sym_scope;
+		sym_module->scope->is_module_scope = true;
+		m_modules.push_back(sym_module);
+	}
+}
+
+bool nyla::interface_file::load_symbols(nyla::compiler& compiler, sym_table* our_sym_table) {
+	nyla::word_table& word_table = compiler.get_context().get_word_table();
+	auto read_function = [this, &compiler](sym_function* sym_function, sym_module* sym_module) {
+		u32 num_params;
+		u8 is_memcpy, call_at_startup;
+		if (!read_u32(sym_function->mods))                      return false;
+		if (!read_type(compiler, sym_function->return_type))   return false;
+		if (!read_u32(num_params))                              return false;
+		sym_function->param_types.resize(num_params);
+		for (nyla::type*& param_type : sym_function->param_types) {
+			if (!read_type(compiler, param_type)) return false;
+		}
+		if (!read_u32(sym_function->line_num)) return false;
+		if (!read_u8(is_memcpy))               return false;
+		if (!read_u8(call_at_startup))         return false;
+		if (!read_string(sym_function->ll_name)) return false;
+		sym_function->is_memcpy       = is_memcpy;
+		sym_function->call_at_startup = call_at_startup;
+		sym_function->sym_module      = sym_module;
+		return true;
+	};
+
+	for (sym_module* sym_module : m_modules) {
+		u32 num_variables;
+		if (!read_u32(num_variables)) return false;
+		for (u32 i = 0; i < num_variables; i++) {
+			std::string name;
+			u8 is_field, is_global;
+			u32 num_dims;
+			if (!read_string(name)) return false;
+			sym_variable* sym_variable = new nyla::sym_variable;
+			sym_variable->name_key   = word_table.get_key(name.c_str());
+			sym_variable->sym_module = sym_module;
+			sym_variable->position_declared_at = 0;
+			sym_module->scope->variables[sym_variable->name_key] = sym_variable;
+			if (!read_u32(sym_variable->mods))                return false;
+			if (!read_type(compiler, sym_variable->type))     return false;
+			if (!read_u8(is_field))                           return false;
+			if (!read_u8(is_global))                          return false;
+			if (!read_u32(sym_variable->field_index))         return false;
+			if (!read_string(sym_variable->ll_name))          return false;
+			if (!read_u32(num_dims))                          return false;
+			sym_variable->is_field  = is_field;
+			sym_variable->is_global = is_global;
+			sym_variable->computed_arr_dim_sizes.resize(num_dims);
+			for (u32& dim_size : sym_variable->computed_arr_dim_sizes) {
+				if (!read_u32(dim_size)) return false;
+			}
+		}
+
+		u32 num_fields;
+		if (!read_u32(num_fields)) return false;
+		for (u32 i = 0; i < num_fields; i++) {
+			std::string name;
+			u8 default_initialize;
+			if (!read_string(name))           return false;
+			if (!read_u8(default_initialize)) return false;
+			auto it = sym_module->scope->variables.find(word_table.get_key(name.c_str()));
+			if (it == sym_module->scope->variables.end()) return false;
+			nyla::avariable_decl* field = new nyla::avariable_decl;
+			field->tag                = AST_VARIABLE_DECL;
+			field->name_key           = it->second->name_key;
+			field->type               = it->second->type;
+			field->sym_variable       = it->second;
+			field->ident              = nullptr;
+			field->default_initialize = default_initialize;
+			sym_module->fields.push_back(field);
+		}
+
+		u32 num_functions;
+		if (!read_u32(num_functions)) return false;
+		for (u32 i = 0; i < num_functions; i++) {
+			std::string name;
+			if (!read_string(name)) return false;
+			u32 name_key = word_table.get_key(name.c_str());
+			sym_function* sym_function = our_sym_table->enter_function(sym_module, name_key);
+			sym_function->name_key = name_key;
+			if (!read_function(sym_function, sym_module)) return false;
+		}
+
+		u32 num_constructors;
+		if (!read_u32(num_constructors)) return false;
+		for (u32 i = 0; i < num_constructors; i++) {
+			std::string name;
+			if (!read_string(name)) return false;
+			u32 name_key = word_table.get_key(name.c_str());
+			sym_function* sym_function = our_sym_table->enter_constructor(sym_module, name_key);
+			sym_function->name_key = name_key;
+			if (!read_function(sym_function, sym_module)) return false;
+		}
+	}
+
+	bool read_everything = m_offset == m_data.size();
+
+	// No longer needed once the symbols are loaded
+	m_data.clear();
+	m_data.shrink_to_fit();
+	return read_everything;
+}
+
+bool nyla::interface_file::read_u8(u8& value) {
+	if (m_data.size() - m_offset < sizeof(value)) return false;
+	value = (u8)m_data[m_offset++];
+	return true;
+}
+
+bool nyla::interface_file::read_u32(u32& value) {
+	if (m_data.size() - m_offset < sizeof(value)) return false;
+	memcpy(&value, &m_data[m_offset], sizeof(value));
+	m_offset += sizeof(value);
+	return true;
+}
+
+bool nyla::interface_file::read_u64(u64& value) {
+	if (m_data.size() - m_offset < sizeof(value)) return false;
+	memcpy(&value, &m_data[m_offset], sizeof(value));
+	m_offset += sizeof(value);
+	return true;
+}
+
+bool nyla::interface_file::read_string(std::string& value) {
+	u32 length;
+	if (!read_u32(length)) return false;
+	if (m_data.size() - m_offset < length) return false;
+	value.assign(&m_data[m_offset], length);
+	m_offset += length;
+	return true;
+}
+
+bool nyla::interface_file::read_type(nyla::compiler& compiler, nyla::type*& type) {
+	nyla::compilation_context& context = compiler.get_context();
+	u8 tag;
+	if (!read_u8(tag)) return false;
+	switch (tag) {
+	case NO_TYPE_TAG:
+		type = nullptr;
+		return true;
+	case TYPE_PTR:
+	case TYPE_ARR: {
+		nyla::type* element_type;
+		if (!read_type(compiler, element_type) || !element_type) return false;
+		type = tag == TYPE_PTR ? context.get_type_table().get_ptr(element_type)
+			                   : context.get_type_table().get_arr(element_type);
+		return true;
+	}
+	case TYPE_MODULE: {
+		std::string internal_path, name;
+		if (!read_string(internal_path)) return false;
+		if (!read_string(name))          return false;
+		sym_table* module_sym_table = compiler.find_sym_table(internal_path);
+		if (!module_sym_table) return false;
+		sym_module* sym_module = module_sym_table->find_module(context.get_word_table().get_key(name.c_str()));
+		if (!sym_module) return false;
+		type = context.get_type_table().get_or_enter_module(sym_module);
+		return true;
+	}
+	default:
+		type = get_primitive_type(context.get_builtin_types(), (type_tag)tag);
+		return type != nullptr;
+	}
+}
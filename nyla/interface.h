@@ -0,0 +1,97 @@
+#ifndef NYLA_INTERFACE_H
+#define NYLA_INTERFACE_H
+
+#include <string>
+#include <vector>
+
+#include "types_ext.h"
+
+namespace nyla {
+
+	class compiler;
+	class sym_table;
+	struct sym_module;
+	struct type;
+
+	/*
+	 * Interface files (.nylai) hold the symbols of a file which
+	 * other files need when they import it. That is the modules
+	 * with their fields, static variables, functions and
+	 * constructors along with their modifiers and types.
+	 *
+	 * An importer only needs the interface of an unchanged file
+	 * so the file does not have to be parsed or analyzed. The
+	 * names of the functions and globals are kept as well so a
+	 * file with cached object code is linked without compiling it.
+	 */
+	class interface_file {
+	public:
+
+		// Path of the interface for the contents of the file
+		static std::string get_path(const std::string& directory,
+			                        const std::string& internal_path,
+			                        u64 source_hash);
+
+		// Writes the interface of an analyzed file
+		static bool write(const std::string& path, nyla::compiler& compiler, sym_table* our_sym_table);
+
+		// Reads the interface and its header. Returns false if
+		// the file does not exist or is not a valid interface
+		bool read(const std::string& path);
+
+		u64 get_source_hash() const { return m_source_hash; }
+		const std::string& get_internal_path() const { return m_internal_path; }
+
+		// Whether the object code of the file can be linked with only
+		// the interface. Otherwise files compiled with the file need
+		// its AST to generate initializers
+		bool is_linkable() const { return m_linkable; }
+
+		struct import_info {
+			std::string internal_path;
+			// Hash of the imported file's contents when the
+			// interface was written. The interface is only
+			// valid while the hashes match
+			u64         source_hash;
+		};
+
+		// The files imported by the file
+		const std::vector<import_info>& get_imports() const { return m_imports; }
+
+		// Enters the modules of the file into the symbol table. Has
+		// to be called for every interface before any symbols are
+		// loaded since types may refer to modules of other interfaces
+		void enter_modules(nyla::compiler& compiler, sym_table* our_sym_table);
+
+		// Loads the fields, variables, functions and constructors
+		// of the modules entered by enter_modules
+		bool load_symbols(nyla::compiler& compiler, sym_table* our_sym_table);
+
+	private:
+
+		bool read_u8(u8& value);
+		bool read_u32(u32& value);
+		bool read_u64(u64& value);
+		bool read_string(std::string& value);
+		bool read_type(nyla::compiler& compiler, nyla::type*& type);
+
+		std::string m_data;
+		ulen        m_offset = 0;
+
+		u64                      m_source_hash = 0;
+		std::string              m_internal_path;
+		bool                     m_linkable = false;
+		std::vector<import_info> m_imports;
+
+		struct module_header {
+			std::string name;
+			u32         mods;
+			bool        no_constructors_found;
+		};
+		std::vector<module_header> m_module_headers;
+		std::vector<sym_module*>   m_modules;
+	};
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include "jit.h"
+
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/Object/SymbolSize.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+bool nyla::jit::compile(const std::vector<llvm::Module*>& llvm_modules, nyla::opt_level opt_level) {
+
+	llvm::Expected<llvm::orc::JITTargetMachineBuilder> target_machine_builder =
+		llvm::orc::JITTargetMachineBuilder::detectHost();
+	if (!target_machine_builder) {
+		llvm::errs() << llvm::toString(target_machine_builder.takeError()) << '\n';
+		return false;
+	}
+	target_machine_builder->setCodeGenOptLevel(get_codegen_opt_level(opt_level));
+
+	llvm::Expected<std::unique_ptr<llvm::TargetMachine>> target_machine =
+		target_machine_builder->createTargetMachine();
+	if (!target_machine) {
+		llvm::errs() << llvm::toString(target_machine.takeError()) << '\n';
+		return false;
+	}
+
+#ifdef __linux__
+	m_perf_map.open("/tmp/perf-" + std::to_string(getpid()) + ".map");
+#endif
+
+	llvm::Expected<std::unique_ptr<llvm::orc::LLJIT>> lljit =
+		llvm::orc::LLJITBuilder()
+		.setJITTargetMachineBuilder(*target_machine_builder)
+		.setObjectLinkingLayerCreator([this](llvm::orc::ExecutionSession& session, const llvm::Triple&) {
+			auto object_layer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(session, []() {
+				return std::make_unique<llvm::SectionMemoryManager>();
+			});
+			object_layer->setNotifyLoaded([this](llvm::orc::VModuleKey,
+				                                 const llvm::object::ObjectFile& obj,
+				                                 const llvm::RuntimeDyld::LoadedObjectInfo& info) {
+				write_perf_map_entries(obj, info);
+			});
+			return std::unique_ptr<llvm::orc::ObjectLayer>(std::move(object_layer));
+		})
+		.create();
+	if (!lljit) {
+		llvm::errs() << llvm::toString(lljit.takeError()) << '\n';
+		return false;
+	}
+	m_lljit = std::move(*lljit);
+
+	// Allows calling into the C runtime the compiler
+	// is linked against. Ex. malloc
+	llvm::Expected<std::unique_ptr<llvm::orc::DynamicLibrarySearchGenerator>> process_symbols =
+		llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+			m_lljit->getDataLayout().getGlobalPrefix());
+	if (!process_symbols) {
+		llvm::errs() << llvm::toString(process_symbols.takeError()) << '\n';
+		return false;
+	}
+	m_lljit->getMainJITDylib().addGenerator(std::move(*process_symbols));
+
+	// The JIT owns the modules it compiles along with their context
+	// so the modules are copied into a new context through bitcode
+	llvm::orc::ThreadSafeContext thread_safe_context(std::make_unique<llvm::LLVMContext>());
+	for (llvm::Module* llvm_module : llvm_modules) {
+		llvm::SmallVector<char, 0> bitcode;
+		llvm::raw_svector_ostream stream(bitcode);
+		llvm::WriteBitcodeToFile(*llvm_module, stream);
+
+		llvm::Expected<std::unique_ptr<llvm::Module>> jit_module =
+			llvm::parseBitcodeFile(
+				llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()),
+					                  llvm_module->getModuleIdentifier()),
+				*thread_safe_context.getContext());
+		if (!jit_module) {
+			llvm::errs() << llvm::toString(jit_module.takeError()) << '\n';
+			return false;
+		}
+
+		(*jit_module)->setDataLayout(m_lljit->getDataLayout());
+		if (opt_level != OPT_LEVEL_O0) {
+			optimize_module(jit_module->get(), target_machine->get(), opt_level);
+		}
+
+		if (llvm::Error err = m_lljit->addIRModule(
+				llvm::orc::ThreadSafeModule(std::move(*jit_module), thread_safe_context))) {
+			llvm::errs() << llvm::toString(std::move(err)) << '\n';
+			return false;
+		}
+	}
+
+	// Looking up main compiles everything it depends on
+	llvm::Expected<llvm::JITEvaluatedSymbol> main_symbol = m_lljit->lookup("main");
+	if (!main_symbol) {
+		llvm::errs() << llvm::toString(main_symbol.takeError()) << '\n';
+		return false;
+	}
+	m_main_function = (s32(*)()) main_symbol->getAddress();
+
+	return true;
+}
+
+s32 nyla::jit::run_main() {
+	return m_main_function();
+}
+
+void nyla::jit::write_perf_map_entries(const llvm::object::ObjectFile& obj,
+	                                   const llvm::RuntimeDyld::LoadedObjectInfo& info) {
+	if (!m_perf_map.is_open()) return;
+
+	// The debug object has the symbol addresses
+	// of where the sections were loaded
+	llvm::object::OwningBinary<llvm::object::ObjectFile> debug_obj = info.getObjectForDebug(obj);
+	if (!debug_obj.getBinary()) return;
+
+	for (const auto& symbol_size : llvm::object::computeSymbolSizes(*debug_obj.getBinary())) {
+		const llvm::object::SymbolRef& symbol = symbol_size.first;
+		llvm::Expected<llvm::object::SymbolRef::Type> type = symbol.getType();
+		if (!type) {
+			llvm::consumeError(type.takeError());
+			continue;
+		}
+		if (*type != llvm::object::SymbolRef::ST_Function) continue;
+
+		llvm::Expected<llvm::StringRef> name    = symbol.getName();
+		llvm::Expected<u64>             address = symbol.getAddress();
+		if (!name || !address) {
+			if (!name)    llvm::consumeError(name.takeError());
+			if (!address) llvm::consumeError(address.takeError());
+			continue;
+		}
+
+		m_perf_map << std::hex << *address << ' ' << symbol_size.second << ' '
+			       << name->str() << '\n';
+	}
+	m_perf_map.flush();
+}
@@ -0,0 +1,48 @@
+#ifndef NYLA_JIT_H
+#define NYLA_JIT_H
+
+#include "code_gen.h"
+
+#include <fstream>
+#include <memory>
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+
+namespace nyla {
+
+	/*
+	 * Compiles the program in memory and runs it
+	 * within the compiler's process.
+	 * 
+	 * On Linux the addresses of the compiled functions are
+	 * written to /tmp/perf-<pid>.map so that perf can name
+	 * them.
+	 */
+	class jit {
+	public:
+
+		// Copies the modules into the JIT and compiles them.
+		// Returns false if compiling or finding main failed
+		bool compile(const std::vector<llvm::Module*>& llvm_modules, nyla::opt_level opt_level);
+
+		// Runs the main function of the program and
+		// returns the exit code
+		s32 run_main();
+
+	private:
+
+		void write_perf_map_entries(const llvm::object::ObjectFile& obj,
+			                        const llvm::RuntimeDyld::LoadedObjectInfo& info);
+
+		// Must be destroyed after the JIT since the
+		// JIT writes to it when loading objects
+		std::ofstream m_perf_map;
+
+		std::unique_ptr<llvm::orc::LLJIT> m_lljit;
+
+		s32 (*m_main_function)() = nullptr;
+
+	};
+}
+
+#endif
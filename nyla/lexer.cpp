@@ -1,6 +1,7 @@
 #include "lexer.h"
 
 #include "words.h"
+#include "scan.h"
 
 #include <assert.h>
 
@@ -9,37 +10,6 @@
  * sets to ensure speed.
  */
 
-constexpr bool identifier_set[256] = {
-	0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, // 16
-	0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, // 32
-	0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, // 48
-	// Digits
-	1,1,1,1, 1,1,1,1, 1,1,0,0, 0,0,0,0, // 64
-	// Uppercase letters
-	0,1,1,1, 1,1,1,1, 1,1,1,1, 1,1,1,1, // 88
-	// Last 1 is for underscores
-	1,1,1,1, 1,1,1,1, 1,1,1,0, 0,0,0,1, // 96
-	// Lowercase letters
-	0,1,1,1, 1,1,1,1, 1,1,1,1, 1,1,1,1, // 112
-	1,1,1,1, 1,1,1,1, 1,1,1,0, 0,0,0,0,
-};
-
-constexpr bool whitespace_set[256] = {
-		0,0,0,0,0, 0,0,0,1,1,  // 0-9
-		0,1,1,0,0, 0,0,0,0,0,  // 10-19
-		0,0,0,0,0, 0,0,0,0,0,  // 20-29
-		0,0,1,0,0, 0,0,0,0,0,  // 30-39
-};
-
-constexpr bool digits_set[256] = {
-		0,0,0,0,0, 0,0,0,0,0,
-		0,0,0,0,0, 0,0,0,0,0,
-		0,0,0,0,0, 0,0,0,0,0,
-		0,0,0,0,0, 0,0,0,0,0,
-		0,0,0,0,0, 0,0,0,1,1,
-		1,1,1,1,1, 1,1,1,0,0,
-};
-
 constexpr bool hexidecimal_set[256] = {
 		0,0,0,0,0, 0,0,0,0,0,
 		0,0,0,0,0, 0,0,0,0,0,
@@ -59,95 +29,51 @@ constexpr bool hexidecimal_set[256] = {
 		1,1,1,
 };
 
-constexpr bool eof_eol_set[256] = {
-	// '\0'                       '\n'
-		1,   0,0,0, 0,0,0,0, 0,0,  1,  0,
-		//    '\r'
-			0, 1
-};
-
-constexpr bool eol_set[256] = {
-	0,0,0,0, 0,0,0,0, 0,0,1,0,
-	0,1
-};
-
-// '"' '\r' '\n' '\0'
-constexpr bool string_end_set[256] = {
-	// '\0'                       '\n'
-		1,   0,0,0, 0,0,0,0, 0,0,  1,  0,  // 0-11
-	//    '\r'
-		0, 1,0,0,0, 0,0,0,0, 0,0,  0,  0,   // 12-24
-	//                     '"'
-		0, 0,0,0,0, 0,0,0,0,1
-};
-
 void nyla::lexer::consume_ignored() {
-	bool continue_eating = false;
-	do {
-		// Eating newlines
-		while (eol_set[m_source.cur_char()]) {
-			switch (m_source.cur_char()) {
-			case '\n':
-				m_source.next_char(); // consuming '\n'
-				on_new_line();
-				break;
-			case '\r':
-				m_source.next_char(); // consuming '\r'
-				if (m_source.cur_char() == '\n')
-					m_source.next_char(); // consuming '\n' 
-				on_new_line();
-				break;
-			default:
-				assert(!"Unreachable!");
-				break;
-			}
-		}
-		// Eating whitespace
-		c8 ch = m_source.cur_char();
-		while (whitespace_set[ch])
-			ch = m_source.next_char();
+	while (true) {
+		// Eating whitespace and newlines
+		m_cur = nyla::skip_blank(m_cur, m_line_num);
+		if (*m_cur != '/') break;
+
 		// Eating single line comments
-		if (ch == '/' && m_source.peek_char() == '/') {
-			m_source.next_char(); // Consuming /
-			m_source.next_char(); // Consuming /
-			ch = m_source.cur_char();
-			while (!eof_eol_set[ch])
-				ch = m_source.next_char();
+		if (*(m_cur + 1) == '/') {
+			m_cur = nyla::find_line_end(m_cur + 2);
+			continue;
 		}
 
 		// Eating multi-line comments
-		if (ch == '/' && m_source.peek_char() == '*') {
-			m_source.next_char(); // Eating first  (
-			m_source.next_char(); // Eating second `
-			ch = m_source.cur_char();
-			while (!(ch == '*' && m_source.peek_char() == '/')) {
-				if (ch == '\0') {
-					m_log.err(ERR_UNCLOSED_COMMENT,
-						      m_line_num,
-						      m_source.position(),
-						      m_source.position());
-					return;
-				}
-				ch = m_source.next_char();
+		if (*(m_cur + 1) == '*') {
+			m_cur = nyla::find_block_comment_end(m_cur + 2, m_line_num);
+			if (*m_cur == '\0') {
+				m_log.err(ERR_UNCLOSED_COMMENT,
+					      m_line_num,
+					      position(),
+					      position());
+				return;
 			}
-			m_source.next_char(); // Eating first  `
-			m_source.next_char(); // Eating second )
+			m_cur += 2; // Eating */
+			continue;
 		}
-		ch = m_source.cur_char();
-		continue_eating = whitespace_set[ch] ||
-			ch == '`' && m_source.peek_char() == '`' ||
-			eol_set[m_source.cur_char()];
-	} while (continue_eating);
+		break;
+	}
+}
+
+bool nyla::lexer::lex_token() {
+	if (m_tokens.is_finished()) {
+		return false;
+	}
+	m_tokens.add(next_token());
+	return !m_tokens.is_finished();
 }
 
-void nyla::lexer::on_new_line() {
-	++m_line_num;
+void nyla::lexer::lex_file() {
+	while (lex_token());
 }
 
 nyla::token nyla::lexer::next_token() {
 	consume_ignored();
-	m_start_pos = m_source.position();
-	switch (m_source.cur_char()) {
+	m_start_pos = position();
+	switch (*m_cur) {
 	case 'a': case 'b': case 'c': case 'd': case 'e':
 	case 'f': case 'g': case 'h': case 'i': case 'j':
 	case 'k': case 'l': case 'm': case 'n': case 'o':
@@ -181,7 +107,7 @@ nyla::token nyla::lexer::next_token() {
 	default: {
 		nyla::token unknown_token = make(TK_UNKNOWN, m_start_pos, m_start_pos);
 		m_log.err(ERR_UNKNOWN_CHARACTER, unknown_token);
-		m_source.next_char(); // Eating the unknown character.
+		++m_cur; // Eating the unknown character.
 		return unknown_token;
 	}
 	}
@@ -189,23 +115,24 @@ nyla::token nyla::lexer::next_token() {
 }
 
 nyla::token nyla::lexer::next_word() {
-	nyla::word word;
-	c8 ch = m_source.cur_char();
-	while (identifier_set[ch]) {
-		word.append(ch);
-		ch = m_source.next_char();
+	const c8* start = m_cur;
+	m_cur = nyla::find_identifier_end(start);
+	ulen length = m_cur - start;
+
+	// Keywords never touch the word table
+	u32 keyword_tag = nyla::get_keyword_tag(start, length);
+	if (keyword_tag != TK_IDENTIFIER) {
+		return make(keyword_tag, m_start_pos, position());
 	}
 
-	nyla::token word_token = make(TK_IDENTIFIER, m_start_pos, m_source.position());
-	word_token.word_key = g_word_table->get_key(word);
+	// Hashing while the characters are still in the cache
+	u64 hash = nyla::hash_word(start, length);
 
-	if (word.size() > 0xFF) {
-		m_log.err(ERR_IDENTIFIER_TOO_LONG, word_token);
-	}
+	nyla::token word_token = make(TK_IDENTIFIER, m_start_pos, position());
+	word_token.word_key = m_context.get_word_table().get_key(start, length, hash);
 
-	auto it = reserved_words.find(word_token.word_key);
-	if (it != reserved_words.end()) {
-		word_token.tag = it->second;
+	if (length > 0xFF) {
+		m_log.err(ERR_IDENTIFIER_TOO_LONG, word_token);
 	}
 
 	return word_token;
@@ -214,9 +141,9 @@ nyla::token nyla::lexer::next_word() {
 nyla::token nyla::lexer::next_symbol() {
 	#define DOUBLE_SYMBOLS(fst, snd, tk_tag) \
 case fst: {                              \
-	ch = m_source.next_char();           \
+	ch = *++m_cur;                       \
 	if (ch == snd) {                     \
-			m_source.next_char();        \
+			++m_cur;                     \
 			return make(tk_tag,          \
 				        m_start_pos,     \
 				        m_start_pos + 2);\
@@ -224,7 +151,7 @@ case fst: {                              \
 	return make(fst, m_start_pos,        \
 	                 m_start_pos + 1);   \
 }
-	c8 ch = m_source.cur_char();
+	c8 ch = *m_cur;
 	switch (ch) {
 	DOUBLE_SYMBOLS('*', '=', TK_STAR_EQ)
 	DOUBLE_SYMBOLS('/', '=', TK_SLASH_EQ)
@@ -233,95 +160,95 @@ case fst: {                              \
 	DOUBLE_SYMBOLS('!', '=', TK_EXL_EQ)
 	DOUBLE_SYMBOLS('=', '=', TK_EQ_EQ)
 	case '+': {
-		ch = m_source.next_char(); // Eating +
+		ch = *++m_cur; // Eating +
 		if (ch == '=') {
-			m_source.next_char(); // Eating =
+			++m_cur; // Eating =
 			return make(TK_PLUS_EQ, m_start_pos, m_start_pos + 2);
 		} else if (ch == '+') {
-			m_source.next_char(); // Eating +
+			++m_cur; // Eating +
 			return make(TK_PLUS_PLUS, m_start_pos, m_start_pos + 2);
 		}
 		return make('+', m_start_pos, m_start_pos + 1);
 	}
 	case '?': {
-		ch = m_source.next_char(); // Eating ?
+		ch = *++m_cur; // Eating ?
 		if (ch == '?') {
-			if (m_source.peek_char() == '?') {
-				m_source.next_char(); // Eating ?
-				m_source.next_char(); // Eating ?
+			if (*(m_cur + 1) == '?') {
+				++m_cur; // Eating ?
+				++m_cur; // Eating ?
 				return make(TK_QQQ, m_start_pos, m_start_pos + 3);
 			}
 		}
 		return make('?', m_start_pos, m_start_pos + 1);
 	}
 	case '-': {
-		ch = m_source.next_char(); // Eating -
+		ch = *++m_cur; // Eating -
 		if (ch == '=') {
-			m_source.next_char(); // Eating =
+			++m_cur; // Eating =
 			return make(TK_MINUS_EQ, m_start_pos, m_start_pos + 2);
 		} else if (ch == '-') {
-			m_source.next_char(); // Eating -
+			++m_cur; // Eating -
 			return make(TK_MINUS_MINUS, m_start_pos, m_start_pos + 2);
 		} else if (ch == '>') {
-			m_source.next_char(); // Eating >
+			++m_cur; // Eating >
 			return make(TK_MINUS_GT, m_start_pos, m_start_pos + 2);
 		}
 		return make('-', m_start_pos, m_start_pos + 1);
 	}
 	case '|': {
-		ch = m_source.next_char(); // Eating |
+		ch = *++m_cur; // Eating |
 		switch (ch) {
 		case '=': {
-			m_source.next_char(); // Eating =
+			++m_cur; // Eating =
 			return make(TK_BAR_EQ, m_start_pos, m_start_pos + 2);
 		}
 		case '|': {
-			m_source.next_char(); // Eating |
+			++m_cur; // Eating |
 			return make(TK_BAR_BAR, m_start_pos, m_start_pos + 2);
 		}
 		}
 		return make('|', m_start_pos, m_start_pos + 1);
 	}
 	case '&': {
-		ch = m_source.next_char(); // Eating &
+		ch = *++m_cur; // Eating &
 		switch (ch) {
 		case '=': {
-			m_source.next_char(); // Eating =
+			++m_cur; // Eating =
 			return make(TK_AMP_EQ, m_start_pos, m_start_pos + 2);
 		}
 		case '&': {
-			m_source.next_char(); // Eating &
+			++m_cur; // Eating &
 			return make(TK_AMP_AMP, m_start_pos, m_start_pos + 2);
 		}
 		}
 		return make('&', m_start_pos, m_start_pos + 1);
 	}
 	case '>': {
-		ch = m_source.next_char(); // Eating >
+		ch = *++m_cur; // Eating >
 		if (ch == '>') {
-			ch = m_source.next_char(); // Eating >
+			ch = *++m_cur; // Eating >
 			if (ch == '=') {
-				m_source.next_char(); // Eating =
+				++m_cur; // Eating =
 				return make(nyla::TK_GT_GT_EQ, m_start_pos, m_start_pos + 3);
 			}
 			return make(nyla::TK_GT_GT, m_start_pos, m_start_pos + 2);
 		} else if (ch == '=') { // >=
-			m_source.next_char(); // Eating =
+			++m_cur; // Eating =
 			return make(nyla::TK_GT_EQ, m_start_pos, m_start_pos + 2);
 		}
 		return make('>', m_start_pos, m_start_pos + 1);
 	}
 	case '<': {
-		ch = m_source.next_char(); // Eating <
+		ch = *++m_cur; // Eating <
 		if (ch == '<') {
-			ch = m_source.next_char(); // Eating <
+			ch = *++m_cur; // Eating <
 			if (ch == '=') {
-				m_source.next_char(); // Eating =
+				++m_cur; // Eating =
 				return make(nyla::TK_LT_LT_EQ, m_start_pos, m_start_pos + 3);
 			}
 			return make(nyla::TK_LT_LT, m_start_pos, m_start_pos + 2);
 		} else if (ch == '=') { // <=
-			m_source.next_char(); // Eating =
+			++m_cur; // Eating =
 			return make(nyla::TK_LT_EQ, m_start_pos, m_start_pos + 2);
 		}
 		return make('<', m_start_pos, m_start_pos + 1);
@@ -329,7 +256,7 @@ case fst: {                              \
 	default: {
 		nyla::token symbol_token = make(ch, m_start_pos,
 			                                 m_start_pos + 1);
-		m_source.next_char(); // Eating the symbol
+		++m_cur; // Eating the symbol
 		return symbol_token;
 	}
 	}
@@ -338,9 +265,9 @@ case fst: {                              \
 
 nyla::token nyla::lexer::next_number() {
 	// Checking for hexidecimal
-	if (m_source.cur_char() == '0' && m_source.peek_char() == 'x') {
-		m_source.next_char(); // Eating '0'
-		m_source.next_char(); // Eating 'x'
+	if (*m_cur == '0' && *(m_cur + 1) == 'x') {
+		++m_cur; // Eating '0'
+		++m_cur; // Eating 'x'
 		return next_hexidecimal();
 	}
 
@@ -350,26 +277,26 @@ nyla::token nyla::lexer::next_number() {
 	c8 exponent_sign = '+';
 	bool is_integer = true;
 
-	if (m_source.cur_char() == '.') {
-		m_source.next_char(); // Eating .
+	if (*m_cur == '.') {
+		++m_cur; // Eating .
 		fraction_digits = read_unsigned_digits();
 		is_integer = false;
 	}
 
-	if (m_source.cur_char() == 'E') {
+	if (*m_cur == 'E') {
 		is_integer = false;
 
-		c8 possible_sign = m_source.next_char();
+		c8 possible_sign = *++m_cur;
 		if (possible_sign == '+' || possible_sign == '-') {
 			exponent_sign = possible_sign;
-			m_source.next_char(); // Consuming + or -
+			++m_cur; // Consuming + or -
 		}
 
 		exponent_digits = read_unsigned_digits();
 	}
 
 	// checking for floating point units
-	if (m_source.cur_char() == 'f' || m_source.cur_char() == 'd') {
+	if (*m_cur == 'f' || *m_cur == 'd') {
 		is_integer = false;
 	}
 
@@ -382,12 +309,9 @@ nyla::token nyla::lexer::next_number() {
 }
 
 nyla::range nyla::lexer::read_unsigned_digits() {
-	u32 start = m_source.position();
-	c8 ch = m_source.cur_char();
-	while (digits_set[ch]) {
-		ch = m_source.next_char();
-	}
-	u32 end = m_source.position();
+	u32 start = position();
+	m_cur = nyla::find_digits_end(m_cur);
+	u32 end = position();
 	return range{ start, end };
 }
 
@@ -399,7 +323,7 @@ nyla::token nyla::lexer::next_integer(const nyla::range& digits) {
 	nyla::token int_token;
 
 	if (overflow) {
-		int_token = make(TK_VALUE_ULONG, m_start_pos, m_source.position());
+		int_token = make(TK_VALUE_ULONG, m_start_pos, position());
 		int_token.value_ulong = int_value;
 		m_log.err(ERR_INT_TOO_LARGE, int_token);
 		return int_token;
@@ -413,12 +337,12 @@ nyla::range nyla::lexer::read_hexidecimal_digits() {
 	// a range of values from a set into a common function
 	// since the same logic will apply to base-10, hex, octal
 	// and binary
-	u32 start = m_source.position();
-	c8 ch = m_source.cur_char();
+	u32 start = position();
+	c8 ch = *m_cur;
 	while (hexidecimal_set[ch]) {
-		ch = m_source.next_char();
+		ch = *++m_cur;
 	}
-	u32 end = m_source.position();
+	u32 end = position();
 	return range{ start, end };
 }
 
@@ -449,7 +373,10 @@ nyla::token nyla::lexer::next_hexidecimal() {
 	for (ulen index = digits.start; index < digits.end; index++) {
 		prev_value = int_value;
 		int_value <<= 4;
-		int_value += hex_to_decimal_mapping[m_source[index]];
+		auto it = hex_to_decimal_mapping.find(m_source[index]);
+		if (it != hex_to_decimal_mapping.end()) {
+			int_value += it->second;
+		}
 		if (int_value < prev_value) {
 			// TODO: error production?
 		}
@@ -464,22 +391,22 @@ nyla::token nyla::lexer::finalize_integer(u64 int_value) {
 
 	// Maximum signed 32-bit integer
 	if (int_value <= std::numeric_limits<s32>::max()) {
-		int_token = make(TK_VALUE_INT, m_start_pos, m_source.position());
+		int_token = make(TK_VALUE_INT, m_start_pos, position());
 		int_token.value_int = int_value;
 	}
 	// Maximum unsigned 32-bit integer
 	else if (int_value <= std::numeric_limits<u32>::max()) {
-		int_token = make(TK_VALUE_UINT, m_start_pos, m_source.position());
+		int_token = make(TK_VALUE_UINT, m_start_pos, position());
 		int_token.value_uint = int_value;
 	}
 	// Maximum signed 64-bit integer
 	else if (int_value <= std::numeric_limits<s64>::max()) {
-		int_token = make(TK_VALUE_LONG, m_start_pos, m_source.position());
+		int_token = make(TK_VALUE_LONG, m_start_pos, position());
 		int_token.value_long = int_value;
 	}
 	// Only catagory left is an unsigned 64 bit integer
 	else {
-		int_token = make(TK_VALUE_ULONG, m_start_pos, m_source.position());
+		int_token = make(TK_VALUE_ULONG, m_start_pos, position());
 		int_token.value_ulong = int_value;
 	}
 
@@ -531,16 +458,16 @@ nyla::token nyla::lexer::next_float(const range& whole_digits,
 	// Error in reading since the value is too large
 	if (exponent_too_large || isinf(value)) {
 		bool is_float32bits = false;
-		if (m_source.cur_char() == 'f') {
-			m_source.next_char(); // Eating f
-			float_token = make(TK_VALUE_FLOAT, m_start_pos, m_source.position());
+		if (*m_cur == 'f') {
+			++m_cur; // Eating f
+			float_token = make(TK_VALUE_FLOAT, m_start_pos, position());
 			float_token.value_float = std::numeric_limits<float>::max();
 			is_float32bits = true;
-		} else if (m_source.cur_char() == 'd') {
-			m_source.next_char(); // Eating d
+		} else if (*m_cur == 'd') {
+			++m_cur; // Eating d
 		}
 		if (!is_float32bits) {
-			float_token = make(TK_VALUE_DOUBLE, m_start_pos, m_source.position());
+			float_token = make(TK_VALUE_DOUBLE, m_start_pos, position());
 			float_token.value_double = std::numeric_limits<double>::max();
 		}
 
@@ -550,18 +477,18 @@ nyla::token nyla::lexer::next_float(const range& whole_digits,
 	}
 
 	bool is_float32bits = false;
-	if (m_source.cur_char() == 'f') {
+	if (*m_cur == 'f') {
 		is_float32bits = true;
-		m_source.next_char(); // Eating f
-	} else if (m_source.cur_char() == 'd') {
-		m_source.next_char(); // Eating d
+		++m_cur; // Eating f
+	} else if (*m_cur == 'd') {
+		++m_cur; // Eating d
 	}
 
 	if (!is_float32bits) {
-		float_token = make(TK_VALUE_DOUBLE, m_start_pos, m_source.position());
+		float_token = make(TK_VALUE_DOUBLE, m_start_pos, position());
 		float_token.value_double = value;
 	} else {
-		float_token = make(TK_VALUE_FLOAT, m_start_pos, m_source.position());
+		float_token = make(TK_VALUE_FLOAT, m_start_pos, position());
 		float_token.value_float = value;
 	}
 
@@ -597,56 +524,46 @@ std::tuple<u64, bool> nyla::lexer::calculate_int_value(const nyla::range& digits
 }
 
 nyla::token nyla::lexer::next_string() {
-	c8 ch = m_source.next_char(); // Eating "
+	++m_cur; // Eating "
 	std::string str = "";
-	while (!string_end_set[ch]) {
+	c8 ch;
+	while (true) {
+		// Copying everything up to the next escape or end of the string
+		const c8* start = m_cur;
+		m_cur = nyla::find_string_special(start);
+		str.append(start, m_cur - start);
+		ch = *m_cur;
+		if (ch != '\\') break;
+
+		ch = *++m_cur; // Eating '\'
 		switch (ch) {
-		case '\\': {
-			ch = m_source.next_char(); // Eating '\'
-			switch (ch) {
-				// TODO: Is this all the escape sequences?
-			case 'n':
-				str += '\n';
-				ch = m_source.next_char();
-				break;
-			case 'r':
-				str += '\r';
-				ch = m_source.next_char();
-				break;
-			case 't':
-				str += '\t';
-				ch = m_source.next_char();
-				break;
-			case '\\':
-				str += '\\';
-				ch = m_source.next_char();
-				break;
-			case '"':
-				str += '"';
-				ch = m_source.next_char();
-				break;
-			default: {
-				// No escape sequence found
-				m_log.err(ERR_INVALID_ESCAPE_SEQUENCE,
-					      m_line_num, m_source.position() - 1, m_source.position () + 1);
-				ch = m_source.next_char(); // Eating the bad '\'
-			}
-			}
+			// TODO: Is this all the escape sequences?
+		case 'n':  str += '\n'; break;
+		case 'r':  str += '\r'; break;
+		case 't':  str += '\t'; break;
+		case '\\': str += '\\'; break;
+		case '"':  str += '"';  break;
+		default: {
+			// No escape sequence found
+			m_log.err(ERR_INVALID_ESCAPE_SEQUENCE,
+				      m_line_num, position() - 1, position() + 1);
 			break;
 		}
-		default:
-			str += ch;
-			ch = m_source.next_char();
+		}
+		if (ch == '\0' || ch == '\n' || ch == '\r') {
+			// Not eating the end of the line so it is reported
+			// as a missing closing quote
 			break;
 		}
+		++m_cur; // Eating the escaped character
 	}
 
-	nyla::token str_token = make(TK_VALUE_STRING8, m_start_pos, m_source.position());
-	str_token.value_string8 = str;
+	nyla::token str_token = make(TK_VALUE_STRING8, m_start_pos, position());
+	str_token.value_string8 = m_tokens.add_string(str.data(), str.size());
 
 	if (ch == '"') {
-		m_source.next_char();
-		str_token.epos = m_source.position();
+		++m_cur;
+		str_token.epos = position();
 	} else {
 		m_log.err(ERR_MISSING_CLOSING_QUOTE, str_token);
 	}
@@ -655,29 +572,29 @@ nyla::token nyla::lexer::next_string() {
 }
 
 nyla::token nyla::lexer::next_character() {
-	c8 ch = m_source.next_char(); // Eating '
+	c8 ch = *++m_cur; // Eating '
 	nyla::token character_token = make(TK_VALUE_CHAR8, m_start_pos, m_start_pos);
 	if (ch == '\\') {
 		// TODO: escape sequences
-		ch = m_source.next_char();
+		ch = *++m_cur;
 		switch (ch) {
 		case 'n':
 			character_token.value_char8 = '\n';
-			ch = m_source.next_char(); // Consuming 'n'
+			ch = *++m_cur; // Consuming 'n'
 			break;
 		default: break;// TODO: produce error
 		}
 
 	} else {
 		character_token.value_char8 = ch;
-		ch = m_source.next_char(); // Eating character inside ''
+		ch = *++m_cur; // Eating character inside ''
 	}
 
 	if (ch == '\'') {
-		m_source.next_char(); // Eating closing '
-		character_token.epos = m_source.position();
+		++m_cur; // Eating closing '
+		character_token.epos = position();
 	} else {
-		character_token.epos = m_source.position();
+		character_token.epos = position();
 		m_log.err(ERR_MISSING_CLOSING_CHAR_QUOTE, character_token);
 	}
 
@@ -4,28 +4,38 @@
 #include "source.h"
 #include "log.h"
 #include "tokens.h"
+#include "token_stream.h"
+#include "compilation_context.h"
 
 namespace nyla {
 
 	class lexer {
 	public:
 
-		lexer(nyla::source& source, nyla::log& log)
-			: m_source(source), m_log(log) {}
+		lexer(nyla::source& source, nyla::log& log, nyla::compilation_context& context)
+			: m_source(source), m_log(log), m_context(context), m_cur(source.begin()) {}
+
+		// Adds the next token of the source to
+		// the token stream.
+		// @return false once TK_EOF was added
+		bool lex_token();
+
+		// Adds every remaining token of the
+		// source to the token stream.
+		void lex_file();
+
+		const nyla::token_stream& get_tokens() const { return m_tokens; }
+
+	private:
 
 		// Obtains the next token by
 		// analyzing the current source.
 		nyla::token next_token();
 
-	private:
-
 		// Consumes whitespace and comments
 		// until the start of a new token.
 		void consume_ignored();
 
-		// Process encountering a new line
-		void on_new_line();
-
 		// Next token is an identifier or
 		// keyword.
 		nyla::token next_word();
@@ -58,6 +68,9 @@ namespace nyla {
 		// Next token is a character
 		nyla::token next_character();
 
+		// Position of the cursor in the source
+		u32 position() const { return (u32)(m_cur - m_source.begin()); }
+
 		inline nyla::token make(u32 tag, u32 start_pos, u32 end_pos) {
 			nyla::token token;
 			token.tag      = tag;
@@ -67,11 +80,16 @@ namespace nyla {
 			return token;
 		}
 
-		nyla::source& m_source;
-		nyla::log&    m_log;
-		u32           m_line_num  = 1;
-		u32           m_start_pos = 0; // The buffer position that
-							           // a token starts on
+		nyla::source&              m_source;
+		nyla::log&                 m_log;
+		nyla::compilation_context& m_context;
+		nyla::token_stream         m_tokens;
+		// Character the lexer is currently on. Reading ahead of
+		// it is safe since the source is padded with zeros
+		const c8*                  m_cur;
+		u32                        m_line_num  = 1;
+		u32                        m_start_pos = 0; // The buffer position that
+							                        // a token starts on
 	};
 
 }
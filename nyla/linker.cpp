@@ -0,0 +1,289 @@
+#include "linker.h"
+#include "utils.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+#if defined(NYLA_HAS_LLD) && defined(__linux__)
+#define NYLA_LINK_WITH_LLD
+#include <lld/Common/Driver.h>
+#include <lld/Common/ErrorHandler.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <mutex>
+#endif
+
+#ifdef NYLA_LINK_WITH_LLD
+
+// LLD keeps global state while linking so only one
+// compiler in the process may link at a time
+static std::mutex lld_mutex;
+
+static bool file_exists(const std::string& path) {
+	return access(path.c_str(), F_OK) == 0;
+}
+
+// Where the files of a GNU/Linux system needed to link a
+// C program live
+struct linux_link_paths {
+	std::string              dynamic_linker;
+	  // Searched for the C runtime objects and libraries
+	std::vector<std::string> lib_directories;
+	  // Holds crtbegin.o, crtend.o and libgcc
+	std::string              gcc_directory;
+};
+
+// Compares GCC versions such as "9" and "12.2.0" number by number
+static bool is_newer_version(const std::string& version, const std::string& than) {
+	std::vector<std::string> numbers      = nyla::split(version, '.');
+	std::vector<std::string> than_numbers = nyla::split(than, '.');
+	for (ulen i = 0; i < numbers.size() && i < than_numbers.size(); i++) {
+		int number      = std::atoi(numbers[i].c_str());
+		int than_number = std::atoi(than_numbers[i].c_str());
+		if (number != than_number) {
+			return number > than_number;
+		}
+	}
+	return numbers.size() > than_numbers.size();
+}
+
+// Finds the paths for the target. Returns false for targets
+// whose layout is not known so they are linked by clang++
+static bool find_linux_link_paths(const llvm::Triple& triple, linux_link_paths& paths) {
+	if (!triple.isOSLinux() || !triple.isGNUEnvironment()) {
+		return false;
+	}
+
+	std::string arch;
+	switch (triple.getArch()) {
+	case llvm::Triple::x86_64:
+		arch = "x86_64";
+		paths.dynamic_linker = "/lib64/ld-linux-x86-64.so.2";
+		break;
+	case llvm::Triple::aarch64:
+		arch = "aarch64";
+		paths.dynamic_linker = "/lib/ld-linux-aarch64.so.1";
+		break;
+	default:
+		return false;
+	}
+	if (!file_exists(paths.dynamic_linker)) {
+		return false;
+	}
+
+	// Debian based systems keep the libraries of each
+	// architecture in a directory of its own
+	std::string multiarch = arch + "-linux-gnu";
+	const std::string lib_directories[] = {
+		"/usr/lib/" + multiarch,
+		"/lib/" + multiarch,
+		"/usr/lib64",
+		"/lib64",
+		"/usr/lib",
+		"/lib",
+	};
+	for (const std::string& directory : lib_directories) {
+		if (file_exists(directory)) {
+			paths.lib_directories.push_back(directory);
+		}
+	}
+
+	// GCC installs into a directory named by the triple the
+	// distribution built it for and then by its version
+	const std::string gcc_triples[] = {
+		multiarch,
+		arch + "-pc-linux-gnu",
+		arch + "-redhat-linux",
+		arch + "-suse-linux",
+		arch + "-unknown-linux-gnu",
+	};
+	std::string newest_version;
+	for (const char* gcc_root : { "/usr/lib/gcc/", "/usr/lib64/gcc/" }) {
+		for (const std::string& gcc_triple : gcc_triples) {
+			std::string triple_directory = gcc_root + gcc_triple;
+			std::tuple<std::vector<nyla::search_file>, bool> versions =
+				nyla::get_directory_files(triple_directory);
+			for (const nyla::search_file& version : std::get<0>(versions)) {
+				std::string gcc_directory = triple_directory + "/" + version.path;
+				if (file_exists(gcc_directory + "/crtbegin.o") &&
+					(newest_version.empty() || is_newer_version(version.path, newest_version))) {
+					newest_version      = version.path;
+					paths.gcc_directory = gcc_directory;
+				}
+			}
+		}
+	}
+	return !paths.gcc_directory.empty();
+}
+
+static bool write_fd(int fd, const char* data, ulen size) {
+	while (size > 0) {
+		ssize_t written = write(fd, data, size);
+		if (written < 0) return false;
+		data += written;
+		size -= written;
+	}
+	return true;
+}
+
+enum lld_result {
+	LLD_LINKED,
+	// LLD ran and reported errors such as undefined symbols
+	LLD_FAILED,
+	// LLD could not be set up for the target so the
+	// objects are linked some other way
+	LLD_UNAVAILABLE,
+};
+
+static lld_result link_with_lld(const std::string& executable_name,
+	                            const std::vector<nyla::obj_file>& obj_files,
+	                            const llvm::Triple& triple, bool pie) {
+	linux_link_paths paths;
+	if (!find_linux_link_paths(triple, paths)) {
+		return LLD_UNAVAILABLE;
+	}
+
+	std::string crt_start = pie ? "Scrt1.o" : "crt1.o";
+	std::string crt_directory;
+	for (const std::string& directory : paths.lib_directories) {
+		if (file_exists(directory + "/" + crt_start)) {
+			crt_directory = directory;
+			break;
+		}
+	}
+	// Position independent executables use the S variants
+	// of crtbegin.o and crtend.o
+	std::string gcc_crt_begin = paths.gcc_directory + (pie ? "/crtbeginS.o" : "/crtbegin.o");
+	std::string gcc_crt_end   = paths.gcc_directory + (pie ? "/crtendS.o" : "/crtend.o");
+	if (crt_directory.empty() || !file_exists(gcc_crt_begin) || !file_exists(gcc_crt_end)) {
+		return LLD_UNAVAILABLE;
+	}
+
+	// The objects are handed to LLD through memory backed
+	// files so they never have to be written to disk
+	std::vector<int>         fds;
+	std::vector<std::string> obj_paths;
+	bool created_files = true;
+	for (const nyla::obj_file& obj_file : obj_files) {
+		int fd = memfd_create(obj_file.name.c_str(), MFD_CLOEXEC);
+		if (fd == -1) {
+			created_files = false;
+			break;
+		}
+		fds.push_back(fd);
+		if (!write_fd(fd, obj_file.buffer.data(), obj_file.buffer.size())) {
+			created_files = false;
+			break;
+		}
+		obj_paths.push_back("/proc/self/fd/" + std::to_string(fd));
+	}
+
+	lld_result result = LLD_UNAVAILABLE;
+	if (created_files) {
+		std::string crt_begin = crt_directory + "/" + crt_start;
+		std::string crt_init  = crt_directory + "/crti.o";
+		std::string crt_end   = crt_directory + "/crtn.o";
+		std::vector<std::string> lib_dir_args;
+		lib_dir_args.push_back("-L" + paths.gcc_directory);
+		for (const std::string& directory : paths.lib_directories) {
+			lib_dir_args.push_back("-L" + directory);
+		}
+
+		// The same order the GCC driver links a C program in
+		std::vector<const char*> args = {
+			"ld.lld",
+			"-o", executable_name.c_str(),
+			"-dynamic-linker", paths.dynamic_linker.c_str(),
+			pie ? "-pie" : "-no-pie",
+			crt_begin.c_str(),
+			crt_init.c_str(),
+			gcc_crt_begin.c_str(),
+		};
+		for (const std::string& obj_path : obj_paths) {
+			args.push_back(obj_path.c_str());
+		}
+		for (const std::string& lib_dir_arg : lib_dir_args) {
+			args.push_back(lib_dir_arg.c_str());
+		}
+		args.push_back("-lgcc");
+		args.push_back("--as-needed");
+		args.push_back("-lgcc_s");
+		args.push_back("--no-as-needed");
+		args.push_back("-lc");
+		args.push_back("-lgcc");
+		args.push_back("--as-needed");
+		args.push_back("-lgcc_s");
+		args.push_back("--no-as-needed");
+		args.push_back(gcc_crt_end.c_str());
+		args.push_back(crt_end.c_str());
+
+		std::string errors;
+		llvm::raw_string_ostream error_stream(errors);
+		bool linked;
+		{
+			std::lock_guard<std::mutex> lock(lld_mutex);
+			// LLD does not reset its error count between links so
+			// one failed link would fail every later link of the
+			// server or watch process
+			lld::errorHandler().errorCount = 0;
+			linked = lld::elf::link(args, false, llvm::outs(), error_stream);
+		}
+		if (linked) {
+			result = LLD_LINKED;
+		} else {
+			std::cout << error_stream.str();
+			result = LLD_FAILED;
+		}
+	}
+
+	for (int fd : fds) {
+		close(fd);
+	}
+	return result;
+}
+
+#endif
+
+static bool link_with_clang(const std::string& executable_name,
+	                        const std::vector<nyla::obj_file>& obj_files,
+	                        bool pie) {
+	// clang++ reads the objects from disk
+	for (const nyla::obj_file& obj_file : obj_files) {
+		std::ofstream stream(obj_file.name, std::ios::binary);
+		if (!stream) {
+			std::cout << "Could not open file: " << obj_file.name << '\n';
+			return false;
+		}
+		stream.write(obj_file.buffer.data(), obj_file.buffer.size());
+	}
+
+	std::string clang_command = "clang++ ";
+	// Code that is not position independent cannot be linked
+	// into a position independent executable which clang++
+	// may make by default
+	clang_command += pie ? "-pie " : "-no-pie ";
+	for (const nyla::obj_file& obj_file : obj_files) {
+		clang_command += obj_file.name + " ";
+	}
+	clang_command += " -o " + executable_name;
+
+	return system(clang_command.c_str()) == 0;
+}
+
+bool nyla::link_executable(const std::string& executable_name,
+	                       const std::vector<obj_file>& obj_files,
+	                       const llvm::Triple& triple,
+	                       llvm::Optional<llvm::Reloc::Model> reloc_model) {
+	// Without a relocation model LLVM generates static
+	// code for ELF targets
+	bool pie = reloc_model.hasValue() && reloc_model.getValue() == llvm::Reloc::PIC_;
+#ifdef NYLA_LINK_WITH_LLD
+	// clang++ would only report the same errors again
+	lld_result result = link_with_lld(executable_name, obj_files, triple, pie);
+	if (result != LLD_UNAVAILABLE) {
+		return result == LLD_LINKED;
+	}
+#endif
+	return link_with_clang(executable_name, obj_files, pie);
+}
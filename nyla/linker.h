@@ -0,0 +1,23 @@
+#ifndef NYLA_LINKER_H
+#define NYLA_LINKER_H
+
+#include "code_gen.h"
+
+#include <llvm/ADT/Triple.h>
+
+namespace nyla {
+
+	// Links the object files into an executable. The objects are
+	// linked within the process by LLD when the compiler is built
+	// with it and the triple is a GNU/Linux target whose system
+	// files are found. Otherwise they are written to disk and
+	// linked by running clang++. Errors reported by LLD are not
+	// retried with clang++
+	bool link_executable(const std::string& executable_name,
+		                 const std::vector<obj_file>& obj_files,
+		                 const llvm::Triple& triple,
+		                 llvm::Optional<llvm::Reloc::Model> reloc_model);
+
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "llvm_gen.h"
 
+#include "utils.h"
+
 struct ll_vtype_printer {
 	ll_vtype_printer(llvm::Value* _arg)
 		: arg(_arg) {}
@@ -31,14 +33,24 @@ std::ostream& operator<<(std::ostream& os, const ll_type_printer& ll_printer) {
 }
 
 
+// Initializes globals and calls startup functions before main runs
+static const char* init_function_name = "__nyla.init";
+
 nyla::llvm_generator::~llvm_generator() {
 	delete m_llvm_builder;
 }
 
 nyla::llvm_generator::llvm_generator(nyla::compiler& compiler, llvm::Module* llvm_module,
-	                                 nyla::afile_unit* file_unit, bool print)
-	: m_compiler(compiler), m_llvm_module(llvm_module), m_print(print), m_file_unit(file_unit) {
-	m_llvm_builder = new llvm::IRBuilder<>(*llvm_context);
+	                                 nyla::sym_table* sym_table, bool print)
+	: m_compiler(compiler), m_llvm_context(llvm_module->getContext()),
+	  m_llvm_module(llvm_module), m_print(print), m_sym_table(sym_table) {
+	if (m_sym_table) {
+		m_file_unit = m_sym_table->get_file_unit();
+		m_file_name = nyla::replace(m_sym_table->get_file_location().internal_path, "/", ".");
+	} else {
+		m_file_name = m_llvm_module->getName().str();
+	}
+	m_llvm_builder = new llvm::IRBuilder<>(m_llvm_context);
 }
 
 void nyla::llvm_generator::gen_file_unit() {
@@ -47,30 +59,91 @@ void nyla::llvm_generator::gen_file_unit() {
 	}
 }
 
-void nyla::llvm_generator::gen_type_declarations() {
+void nyla::llvm_generator::gen_file_unit_globals() {
 	for (nyla::amodule* nmodule : m_file_unit->modules) {
-		// Creating the type of the struct for the module
-		llvm::StructType* ll_struct_type = llvm::StructType::create(*llvm_context);
-		nmodule->sym_module->ll_struct_type = ll_struct_type;
+		gen_module_globals(nmodule);
 	}
 }
 
-void nyla::llvm_generator::gen_body_declarations() {
+void nyla::llvm_generator::set_declarations_only(bool declarations_only) {
+	m_declarations_only = declarations_only;
+}
+
+void nyla::llvm_generator::gen_type_declarations() {
 	for (nyla::amodule* nmodule : m_file_unit->modules) {
+		// Creating the type of the struct for the module. The
+		// body is set once the types of other files are known
+		std::string struct_name = get_word(nmodule->name_key).c_str();
+		struct_name += ".";
+		struct_name += m_file_name;
+		m_ll_struct_types[nmodule->sym_module] = llvm::StructType::create(m_llvm_context, struct_name);
+	}
+}
 
-		std::vector<llvm::Type*> ll_struct_types;
-		for (nyla::avariable_decl* field : nmodule->fields) {
-			ll_struct_types.push_back(gen_type(field->type));
+void nyla::llvm_generator::name_symbols(nyla::compiler& compiler, nyla::sym_table* sym_table) {
+	nyla::word_table& word_table = compiler.get_context().get_word_table();
+	std::string file_name = nyla::replace(sym_table->get_file_location().internal_path, "/", ".");
+	u32 num_functions = 0;
+	u32 num_globals   = 0;
+
+	// Functions are named by the file and order of declaration
+	// so the name is the same every time the file is compiled
+	auto name_function = [&word_table, &file_name, &num_functions](nyla::afunction* function) {
+		if (function->sym_function->is_memcpy) {
+			// Memcpy is already an existing function by LLVM
+			return;
 		}
 
-		if (ll_struct_types.empty()) {
-			ll_struct_types.push_back(llvm::Type::getInt8Ty(*llvm_context));
+		std::string function_name;
+		if (function->is_constructor) {
+			function_name = "_C";
+			function_name += word_table.get_word(function->name_key).c_str();
+		} else {
+			function_name = word_table.get_word(function->name_key).c_str();
 		}
-		nmodule->sym_module->ll_struct_type->setBody(ll_struct_types);
+
+		// Mangling the name by parameter types
+		if (!function->is_main_function && !function->is_external()) {
+			function_name += "_";
+			if (function->sym_function->is_member_function()) {
+				function_name += "M";
+			}
+			function_name += ".";
+			function_name += file_name;
+			function_name += ".";
+			function_name += std::to_string(num_functions++);
+		}
+		function->sym_function->ll_name = function_name;
+	};
+
+	for (nyla::amodule* nmodule : sym_table->get_file_unit()->modules) {
+		for (nyla::avariable_decl* global : nmodule->globals) {
+			std::string global_name = "g_";
+			global_name += word_table.get_word(global->sym_variable->name_key).c_str();
+			global_name += ".";
+			global_name += file_name;
+			global_name += ".";
+			global_name += std::to_string(num_globals++);
+			global->sym_variable->ll_name = global_name;
+		}
+
+		for (nyla::afunction* constructor : nmodule->constructors) {
+			name_function(constructor);
+		}
+		for (nyla::afunction* function : nmodule->functions) {
+			name_function(function);
+		}
+	}
+}
+
+void nyla::llvm_generator::gen_body_declarations() {
+	for (nyla::amodule* nmodule : m_file_unit->modules) {
+
+		llvm::StructType* ll_struct_type = m_ll_struct_types[nmodule->sym_module];
+		gen_struct_body(nmodule->sym_module, ll_struct_type);
 		
 		if (m_print) {
-			nmodule->sym_module->ll_struct_type->setName(get_word(nmodule->name_key).c_str());
-			nmodule->sym_module->ll_struct_type->print(llvm::outs());
+			ll_struct_type->print(llvm::outs());
 			std::cout << "\n\n";
 		}
 
@@ -83,24 +156,29 @@ void nyla::llvm_generator::gen_body_declarations() {
 	}
 }
 
-void nyla::llvm_generator::gen_global_initializers(sym_function* sym_main_function,
-	                                               const std::vector<nyla::avariable_decl*>& initializer_expressions) {
+void nyla::llvm_generator::gen_init_function(const std::vector<nyla::avariable_decl*>& initializer_expressions,
+	                                         const std::vector<sym_function*>& startup_functions) {
+	m_ll_function = llvm::Function::Create(
+		llvm::FunctionType::get(llvm::Type::getVoidTy(m_llvm_context), false),
+		llvm::Function::ExternalLinkage,
+		init_function_name,
+		*m_llvm_module
+	);
+	m_llvm_builder->SetInsertPoint(llvm::BasicBlock::Create(m_llvm_context, "entry block", m_ll_function));
+
 	m_initializing_globals = true;
-	llvm::BasicBlock* ll_main_bb = &sym_main_function->ll_function->getEntryBlock();
-	m_llvm_builder->SetInsertPoint(&ll_main_bb->front());
 	for (nyla::avariable_decl* global_initializer : initializer_expressions) {
 		// Need to GEP into parts of the structure!
 
 		gen_variable_decl(global_initializer);
 	}
 	m_initializing_globals = false;
-}
 
-void nyla::llvm_generator::gen_startup_function_calls(sym_function* sym_main_function,
-	                                                  const std::vector<llvm::Function*>& ll_startup_functions) {
-	for (llvm::Function* ll_startup_function : ll_startup_functions) {
-		m_llvm_builder->CreateCall(ll_startup_function);
+	for (sym_function* startup_function : startup_functions) {
+		m_llvm_builder->CreateCall(get_ll_function(startup_function));
 	}
+
+	m_llvm_builder->CreateRetVoid();
 }
 
 void nyla::llvm_generator::gen_module(nyla::amodule* nmodule) {
@@ -112,22 +190,43 @@ void nyla::llvm_generator::gen_module(nyla::amodule* nmodule) {
 	// memory somewhere or add it to the global initializer
 	// list of expressions, and for some variables of some
 	// types it must do both
+	gen_module_globals(nmodule);
+
+	for (nyla::afunction* constructor : nmodule->constructors) {
+		gen_reachable_function_body(constructor);
+	}
+	for (nyla::afunction* function : nmodule->functions) {
+		gen_reachable_function_body(function);
+	}
+}
 
+void nyla::llvm_generator::gen_reachable_function_body(nyla::afunction* function) {
+	if (function->sym_function->reachable) {
+		nyla::tracer* tracer = m_compiler.get_tracer();
+		std::string trace_name;
+		if (tracer) {
+			trace_name  = get_word(function->sym_function->sym_module->name_key).c_str();
+			trace_name += ".";
+			trace_name += get_word(function->name_key).c_str();
+		}
+		nyla::trace_span span(tracer, "function", std::move(trace_name), m_file_name);
+		gen_function_body(function);
+	} else if (!function->is_external() && !function->sym_function->is_memcpy) {
+		// Leaving only the declaration
+		m_ll_functions[function->sym_function]->deleteBody();
+	}
+}
+
+void nyla::llvm_generator::gen_module_globals(nyla::amodule* nmodule) {
 	for (nyla::avariable_decl* global : nmodule->globals) {
-		global->sym_variable->ll_alloc = gen_global_variable(global);
+		llvm::Value* ll_gvar = gen_global_variable(global);
+		m_ll_allocs[global->sym_variable] = ll_gvar;
 
 		if (m_print) {
-			global->sym_variable->ll_alloc->print(llvm::outs());
+			ll_gvar->print(llvm::outs());
 			std::cout << '\n';
 		}
 	}
-
-	for (nyla::afunction* constructor : nmodule->constructors) {
-		gen_function_body(constructor);
-	}
-	for (nyla::afunction* function : nmodule->functions) {
-		gen_function_body(function);
-	}
 }
 
 void nyla::llvm_generator::gen_function_declaration(nyla::afunction* function) {
@@ -137,48 +236,12 @@ void nyla::llvm_generator::gen_function_declaration(nyla::afunction* function) {
 		return;
 	}
 
-	llvm::Type* ll_return_type = gen_type(function->return_type);
-	std::vector<llvm::Type*> ll_parameter_types;
-
-	// First parameter of member functions are is the pointer to the object
-	if (function->sym_function->is_member_function()) {
-		ll_parameter_types.push_back(
-			llvm::PointerType::get(function->sym_function
-				                           ->sym_module
-				                           ->ll_struct_type, 0));
-	}
-
-	for (nyla::avariable_decl* param : function->parameters) {
-		ll_parameter_types.push_back(gen_type(param->type));
-	}
-
-	bool is_var_args = false;
-	llvm::FunctionType* ll_function_type =
-		llvm::FunctionType::get(ll_return_type, ll_parameter_types, is_var_args);
-
-	std::string function_name;
-	
-	if (function->is_constructor) {
-		function_name = "_C";
-		function_name += get_word(function->name_key).c_str();
-	} else {
-		function_name = get_word(function->name_key).c_str();
-	}
-
-	// Mangling the name by parameter types
-	if (!function->is_main_function && !function->is_external()) {
-		function_name += "_";
-		if (function->sym_function->is_member_function()) {
-			function_name += "M";
-		}
-		function_name += ".";
-		function_name += std::to_string(m_compiler.get_num_functions_count());
-	}
+	llvm::FunctionType* ll_function_type = gen_function_type(function->sym_function);
 
 	llvm::Function* ll_function = llvm::Function::Create(
 		ll_function_type,
 		llvm::Function::ExternalLinkage, // publically visible
-		function_name.c_str(),
+		function->sym_function->ll_name,
 		*m_llvm_module
 	);
 
@@ -203,11 +266,18 @@ void nyla::llvm_generator::gen_function_declaration(nyla::afunction* function) {
 		ll_function->setCallingConv(llvm::CallingConv::X86_StdCall); // TODO Windows only!
 	}
 
-	if (!function->is_external()) {
+	if (!function->is_external() && !m_declarations_only) {
 
 		// Entry block for the function.
-		llvm::BasicBlock* ll_basic_block = llvm::BasicBlock::Create(*nyla::llvm_context, "entry block", ll_function);
+		llvm::BasicBlock* ll_basic_block = llvm::BasicBlock::Create(m_llvm_context, "entry block", ll_function);
 		m_llvm_builder->SetInsertPoint(ll_basic_block);
+
+		if (function->is_main_function) {
+			// Globals are initialized by a function generated
+			// once every file has been compiled
+			m_llvm_builder->CreateCall(m_llvm_module->getOrInsertFunction(
+				init_function_name, llvm::Type::getVoidTy(m_llvm_context)));
+		}
 	
 		// Allocating memory for the parameters
 		u32 param_index = 0;
@@ -227,10 +297,10 @@ void nyla::llvm_generator::gen_function_declaration(nyla::afunction* function) {
 	}
 
 	if (function->sym_function->call_at_startup) {
-		m_compiler.add_startup_function(ll_function);
+		m_sym_table->m_startup_functions.push_back(function->sym_function);
 	}
 
-	function->sym_function->ll_function = ll_function;
+	m_ll_functions[function->sym_function] = ll_function;
 }
 
 llvm::Value* nyla::llvm_generator::gen_global_variable(nyla::avariable_decl* global) {
@@ -239,16 +309,13 @@ llvm::Value* nyla::llvm_generator::gen_global_variable(nyla::avariable_decl* glo
 	// If it is static then it becomes a global variable
 	nyla::sym_variable* sym_variable = global->sym_variable;
 
-	std::string global_name = "g_";
-	global_name += get_word(sym_variable->name_key).c_str();
-	global_name += ".";
-	global_name += std::to_string(m_compiler.get_num_global_variable_count());
-
+	// Functions generated before the global may have
+	// already declared it
 	m_llvm_module->getOrInsertGlobal(
-		global_name.c_str(), gen_type(global->type));
+		sym_variable->ll_name, gen_type(global->type));
 
 	llvm::GlobalVariable* ll_gvar =
-		m_llvm_module->getNamedGlobal(global_name);
+		m_llvm_module->getNamedGlobal(sym_variable->ll_name);
 
 	nyla::type* type = global->type;
 	switch (type->tag) {
@@ -259,7 +326,7 @@ llvm::Value* nyla::llvm_generator::gen_global_variable(nyla::avariable_decl* glo
 		
 		// Even if there is no assignment there still may be
 		// array size allocation
-		m_compiler.add_global_initialize_expr(global);
+		add_global_initialize_expr(global);
 		break;
 	}
 	case TYPE_MODULE: {
@@ -267,7 +334,7 @@ llvm::Value* nyla::llvm_generator::gen_global_variable(nyla::avariable_decl* glo
 		ll_gvar->setInitializer(gen_global_module(global));
 		// Some fields may not be able to be fully generated during it's
 		// declaration so must be handled later
-		m_compiler.add_global_initialize_expr(global);
+		add_global_initialize_expr(global);
 		break;
 	}
 	default: {
@@ -281,7 +348,7 @@ llvm::Value* nyla::llvm_generator::gen_global_variable(nyla::avariable_decl* glo
 					));
 			} else {
 				ll_gvar->setInitializer(gen_default_value(type));
-				m_compiler.add_global_initialize_expr(global);
+				add_global_initialize_expr(global);
 			}
 		}
 		break;
@@ -345,7 +412,7 @@ llvm::Constant* nyla::llvm_generator::gen_global_module(nyla::avariable_decl* st
 
 void nyla::llvm_generator::gen_function_body(nyla::afunction* function) {
 	m_function = function;
-	llvm::Function* ll_function = function->sym_function->ll_function;
+	llvm::Function* ll_function = m_ll_functions[function->sym_function];
 	if (!function->is_external()) {
 
 		m_llvm_builder->SetInsertPoint(&ll_function->getEntryBlock());
@@ -409,7 +476,7 @@ llvm::Value* nyla::llvm_generator::gen_expression(nyla::aexpr* expr) {
 		return gen_type_cast(dynamic_cast<nyla::atype_cast*>(expr));
 	case AST_ARRAY_ACCESS: {
 		nyla::aarray_access* array_access = dynamic_cast<nyla::aarray_access*>(expr);
-		return gen_array_access(array_access->ident->sym_variable->ll_alloc, array_access);
+		return gen_array_access(get_ll_alloc(array_access->ident->sym_variable), array_access);
 	}
 	case AST_FOR_LOOP:
 		return gen_for_loop(dynamic_cast<nyla::afor_loop*>(expr));
@@ -468,7 +535,7 @@ llvm::Value* nyla::llvm_generator::gen_variable_decl(nyla::avariable_decl* varia
 	}
 	
 	sym_variable* sym_variable = variable_decl->sym_variable;
-	llvm::Value* ll_alloca = sym_variable->ll_alloc;
+	llvm::Value* ll_alloca = get_ll_alloc(sym_variable);
 	if (variable_decl->assignment != nullptr) {
 		gen_expression(variable_decl->assignment);
 	} else {
@@ -496,25 +563,25 @@ llvm::Value* nyla::llvm_generator::gen_number(nyla::anumber* number) {
 	case AST_VALUE_UBYTE:
 	case AST_VALUE_CHAR8:
 		return llvm::ConstantInt::get(
-			llvm::IntegerType::getInt8Ty(*nyla::llvm_context), number->value_int, is_signed);
+			llvm::IntegerType::getInt8Ty(m_llvm_context), number->value_int, is_signed);
 	case AST_VALUE_SHORT:
 	case AST_VALUE_USHORT:
 	case AST_VALUE_CHAR16:
 		return llvm::ConstantInt::get(
-			llvm::IntegerType::getInt16Ty(*nyla::llvm_context), number->value_int, is_signed);
+			llvm::IntegerType::getInt16Ty(m_llvm_context), number->value_int, is_signed);
 	case AST_VALUE_INT:
 	case AST_VALUE_UINT:
 	case AST_VALUE_CHAR32:
 		return llvm::ConstantInt::get(
-			llvm::IntegerType::getInt32Ty(*nyla::llvm_context), number->value_int, is_signed);
+			llvm::IntegerType::getInt32Ty(m_llvm_context), number->value_int, is_signed);
 	case AST_VALUE_LONG:
 	case AST_VALUE_ULONG:
 		return llvm::ConstantInt::get(
-			llvm::IntegerType::getInt64Ty(*nyla::llvm_context), number->value_int, is_signed);
+			llvm::IntegerType::getInt64Ty(m_llvm_context), number->value_int, is_signed);
 	case AST_VALUE_FLOAT:
-		return llvm::ConstantFP::get(*nyla::llvm_context, llvm::APFloat(number->value_float));
+		return llvm::ConstantFP::get(m_llvm_context, llvm::APFloat(number->value_float));
 	case AST_VALUE_DOUBLE:
-		return llvm::ConstantFP::get(*nyla::llvm_context, llvm::APFloat(number->value_double));
+		return llvm::ConstantFP::get(m_llvm_context, llvm::APFloat(number->value_double));
 	default:
 		assert(!"Unimplemented number generation");
 		return nullptr;
@@ -756,7 +823,7 @@ llvm::Value* nyla::llvm_generator::gen_ident(nyla::aident* ident) {
 		llvm::Value* ll_this = m_ll_function->getArg(0); // First argument is "this"
 		return m_llvm_builder->CreateStructGEP(ll_this, sym_variable->field_index);
 	} else {
-		return sym_variable->ll_alloc;
+		return get_ll_alloc(sym_variable);
 	}
 }
 
@@ -771,7 +838,7 @@ llvm::Value* nyla::llvm_generator::gen_function_call(llvm::Value* ptr_to_struct,
 	}
 	
 	
-	llvm::Function* ll_called_function = function_call->called_function->ll_function;
+	llvm::Function* ll_called_function = get_ll_function(function_call->called_function);
 	std::vector<llvm::Value*> ll_parameter_values;
 	if (function_call->called_function->is_member_function()) {
 		ll_parameter_values.push_back(ptr_to_struct);
@@ -821,18 +888,12 @@ llvm::Value* nyla::llvm_generator::gen_array(nyla::aarray* arr) {
 }
 
 template<typename char_type, typename to_type>
-void str_to_const_array(const std::basic_string<char_type>& str,
+void str_to_const_array(llvm::LLVMContext& ll_context,
+	                    const std::basic_string<char_type>& str,
 	                    std::vector<llvm::Constant*>& ll_element_values) {
+	llvm::IntegerType* ll_element_type = llvm::IntegerType::get(ll_context, sizeof(to_type) * 8);
 	for (const char_type& c : str) {
-		if constexpr (sizeof(to_type) == 1) {
-			ll_element_values.push_back(nyla::get_ll_int8(c));
-		}
-		if constexpr (sizeof(to_type) == 2) {
-			ll_element_values.push_back(nyla::get_ll_int16(c));
-		}
-		if constexpr (sizeof(to_type) == 4) {
-			ll_element_values.push_back(nyla::get_ll_int32(c));
-		}
+		ll_element_values.push_back(llvm::ConstantInt::get(ll_element_type, (s32)c, true));
 	}
 }
 
@@ -847,13 +908,13 @@ llvm::Value* nyla::llvm_generator::gen_string(nyla::astring* str) {
 		array_size = str->lit8.length();
 		switch (str->type->element_type->tag) {
 		case TYPE_CHAR8:
-			str_to_const_array<c8, s8>(str->lit8, ll_element_values);
+			str_to_const_array<c8, s8>(m_llvm_context, str->lit8, ll_element_values);
 			break;
 		case TYPE_CHAR16:
-			str_to_const_array<c8, s16>(str->lit8, ll_element_values);
+			str_to_const_array<c8, s16>(m_llvm_context, str->lit8, ll_element_values);
 			break;
 		case TYPE_CHAR32:
-			str_to_const_array<c8, s32>(str->lit8, ll_element_values);
+			str_to_const_array<c8, s32>(m_llvm_context, str->lit8, ll_element_values);
 			break;
 		}
 		break;
@@ -862,13 +923,13 @@ llvm::Value* nyla::llvm_generator::gen_string(nyla::astring* str) {
 		array_size = str->lit16.length();
 		switch (str->type->element_type->tag) {
 		case TYPE_CHAR8:
-			str_to_const_array<c16, s8>(str->lit16, ll_element_values);
+			str_to_const_array<c16, s8>(m_llvm_context, str->lit16, ll_element_values);
 			break;
 		case TYPE_CHAR16:
-			str_to_const_array<c16, s16>(str->lit16, ll_element_values);
+			str_to_const_array<c16, s16>(m_llvm_context, str->lit16, ll_element_values);
 			break;
 		case TYPE_CHAR32:
-			str_to_const_array<c16, s32>(str->lit16, ll_element_values);
+			str_to_const_array<c16, s32>(m_llvm_context, str->lit16, ll_element_values);
 			break;
 		}
 		break;
@@ -877,13 +938,13 @@ llvm::Value* nyla::llvm_generator::gen_string(nyla::astring* str) {
 		array_size = str->lit32.length();
 		switch (str->type->element_type->tag) {
 		case TYPE_CHAR8:
-			str_to_const_array<c32, s8>(str->lit32, ll_element_values);
+			str_to_const_array<c32, s8>(m_llvm_context, str->lit32, ll_element_values);
 			break;
 		case TYPE_CHAR16:
-			str_to_const_array<c32, s16>(str->lit32, ll_element_values);
+			str_to_const_array<c32, s16>(m_llvm_context, str->lit32, ll_element_values);
 			break;
 		case TYPE_CHAR32:
-			str_to_const_array<c32, s32>(str->lit32, ll_element_values);
+			str_to_const_array<c32, s32>(m_llvm_context, str->lit32, ll_element_values);
 			break;
 		}
 		break;
@@ -913,12 +974,14 @@ void nyla::llvm_generator::gen_global_const_array(nyla::type* element_type,
 	llvm::ArrayType* ll_array_type =
 		llvm::ArrayType::get(gen_type(element_type), ll_element_values.size());
 	std::string global_name = "__gA.";
-	global_name += std::to_string(m_compiler.get_num_global_const_array_count());
+	global_name += std::to_string(m_num_global_const_arrays++);
 
 	m_llvm_module->getOrInsertGlobal(global_name, ll_array_type);
 
 	llvm::GlobalVariable* ll_gvar =
 		m_llvm_module->getNamedGlobal(global_name);
+	// Only used by this module
+	ll_gvar->setLinkage(llvm::GlobalValue::PrivateLinkage);
 
 	ll_gvar->setInitializer(
 		llvm::ConstantArray::get(ll_array_type, ll_element_values));
@@ -1096,14 +1159,15 @@ llvm::Value* nyla::llvm_generator::gen_object(llvm::Value* ptr_to_struct, nyla::
 
 			sym_variable* sym_variable = field->sym_variable;
 
-			sym_variable->ll_alloc = m_llvm_builder->CreateStructGEP(ptr_to_struct, field_index);
+			llvm::Value* ll_field = m_llvm_builder->CreateStructGEP(ptr_to_struct, field_index);
+			m_ll_allocs[sym_variable] = ll_field;
 			if (field->assignment) {
 				gen_expression(field->assignment);
 			} else {
 				if (!sym_variable->computed_arr_dim_sizes.empty()) {
 					// Allocating space for the array
 					llvm::Value* arr_alloca = gen_precomputed_array_alloca(sym_variable->type, sym_variable->computed_arr_dim_sizes);
-					m_llvm_builder->CreateStore(arr_alloca, sym_variable->ll_alloc);
+					m_llvm_builder->CreateStore(arr_alloca, ll_field);
 				}
 				gen_default_value(field->sym_variable, field->type, field->default_initialize);
 			}
@@ -1134,7 +1198,7 @@ llvm::Value* nyla::llvm_generator::gen_while_loop(nyla::awhile_loop* while_loop)
 llvm::Value* nyla::llvm_generator::gen_loop(nyla::aloop_expr* loop_expr) {
 
 	// The block that tells weather or not to continue looping
-	llvm::BasicBlock* ll_cond_bb = llvm::BasicBlock::Create(*llvm_context, "loopcond", m_ll_function);
+	llvm::BasicBlock* ll_cond_bb = llvm::BasicBlock::Create(m_llvm_context, "loopcond", m_ll_function);
 
 	// Jumping directly into the loop condition
 	m_llvm_builder->CreateBr(ll_cond_bb);
@@ -1144,7 +1208,7 @@ llvm::Value* nyla::llvm_generator::gen_loop(nyla::aloop_expr* loop_expr) {
 	// conditional block
 	llvm::BasicBlock* ll_post_stmts_bb = nullptr;
 	if (!loop_expr->post_exprs.empty()) {
-		ll_post_stmts_bb = llvm::BasicBlock::Create(*llvm_context, "poststmts", m_ll_function);
+		ll_post_stmts_bb = llvm::BasicBlock::Create(m_llvm_context, "poststmts", m_ll_function);
 		
 		// Telling llvm we want to put code into the post stmts block
 		m_llvm_builder->SetInsertPoint(ll_post_stmts_bb);
@@ -1160,11 +1224,11 @@ llvm::Value* nyla::llvm_generator::gen_loop(nyla::aloop_expr* loop_expr) {
 	// Telling llvm we want to put code into the loop condition block
 	m_llvm_builder->SetInsertPoint(ll_cond_bb);
 
-	llvm::BasicBlock* ll_loop_body_bb = llvm::BasicBlock::Create(*llvm_context, "loopbody", m_ll_function);
+	llvm::BasicBlock* ll_loop_body_bb = llvm::BasicBlock::Create(m_llvm_context, "loopbody", m_ll_function);
 
 	// Generating the condition and telling it to jump to the body or the finish point
 	llvm::Value* ll_cond = gen_expr_rvalue(loop_expr->cond);
-	llvm::BasicBlock* ll_finish_bb = llvm::BasicBlock::Create(*llvm_context, "finishloop", m_ll_function);
+	llvm::BasicBlock* ll_finish_bb = llvm::BasicBlock::Create(m_llvm_context, "finishloop", m_ll_function);
 	m_llvm_builder->CreateCondBr(ll_cond, ll_loop_body_bb, ll_finish_bb);
 	m_ll_loop_exit = ll_finish_bb;
 
@@ -1211,7 +1275,7 @@ llvm::Value* nyla::llvm_generator::gen_dot_op(nyla::adot_op* dot_op) {
 				
 				// To i32* to obtain the length
 				llvm::Value* ll_as_i32_ptr =
-					m_llvm_builder->CreateBitCast(ll_arr_alloca, llvm::Type::getInt32PtrTy(*nyla::llvm_context));
+					m_llvm_builder->CreateBitCast(ll_arr_alloca, llvm::Type::getInt32PtrTy(m_llvm_context));
 				
 				return m_llvm_builder->CreateGEP(ll_as_i32_ptr, get_ll_uint32(0));
 			}
@@ -1247,10 +1311,10 @@ llvm::Value* nyla::llvm_generator::gen_dot_op(nyla::adot_op* dot_op) {
 			nyla::aarray_access* array_access = dynamic_cast<nyla::aarray_access*>(factor);
 
 			if (!ll_location) {
-				// TODO: fix sym_variable->ll_alloc does not exist when accessing
+				// TODO: fix the allocation of sym_variable does not exist when accessing
 				// from context this.
 
-				ll_location = gen_array_access(array_access->ident->sym_variable->ll_alloc, array_access);
+				ll_location = gen_array_access(get_ll_alloc(array_access->ident->sym_variable), array_access);
 				if (array_access->ident->type->is_ptr() && !IS_LAST) {
 					ll_location = m_llvm_builder->CreateLoad(ll_location);
 				}
@@ -1298,22 +1362,22 @@ llvm::Value* nyla::llvm_generator::gen_if(nyla::aif* ifstmt) {
 
 	// Basic block after any of the if statements. All if statement body's
 	// finish by unconditionally jumping to this block.
-	llvm::BasicBlock* ll_finish_ifs = llvm::BasicBlock::Create(*llvm_context, "finishifs", m_ll_function);
+	llvm::BasicBlock* ll_finish_ifs = llvm::BasicBlock::Create(m_llvm_context, "finishifs", m_ll_function);
 
 	nyla::aif* cur_if = ifstmt;
 	while (cur_if) {
 		// Body of if statement that is ran when the statement is true
-		llvm::BasicBlock* ll_if_body_bb = llvm::BasicBlock::Create(*llvm_context, "ifbody", m_ll_function);
+		llvm::BasicBlock* ll_if_body_bb = llvm::BasicBlock::Create(m_llvm_context, "ifbody", m_ll_function);
 		// Optional else if condition block if there is an else if condition
 		llvm::BasicBlock* ll_else_if_cond_bb = nullptr;
 		if (cur_if->else_if) {
-			ll_else_if_cond_bb = llvm::BasicBlock::Create(*llvm_context, "elseif", m_ll_function);
+			ll_else_if_cond_bb = llvm::BasicBlock::Create(m_llvm_context, "elseif", m_ll_function);
 		}
 
 		// Optional else block if there is an else scope
 		llvm::BasicBlock* ll_else_bb = nullptr;
 		if (cur_if->else_sym_scope) {
-			ll_else_bb = llvm::BasicBlock::Create(*llvm_context, "elsebody", m_ll_function);
+			ll_else_bb = llvm::BasicBlock::Create(m_llvm_context, "elsebody", m_ll_function);
 		}
 
 		llvm::Value* ll_cond = gen_expr_rvalue(cur_if->cond);
@@ -1398,26 +1462,26 @@ llvm::Type* nyla::llvm_generator::gen_type(nyla::type* type) {
 	case TYPE_BYTE:
 	case TYPE_UBYTE:
 	case TYPE_CHAR8:
-		return llvm::Type::getInt8Ty(*nyla::llvm_context);
+		return llvm::Type::getInt8Ty(m_llvm_context);
 	case TYPE_SHORT:
 	case TYPE_USHORT:
 	case TYPE_CHAR16:
-		return llvm::Type::getInt16Ty(*nyla::llvm_context);
+		return llvm::Type::getInt16Ty(m_llvm_context);
 	case TYPE_INT:
 	case TYPE_UINT:
 	case TYPE_CHAR32:
-		return llvm::Type::getInt32Ty(*nyla::llvm_context);
+		return llvm::Type::getInt32Ty(m_llvm_context);
 	case TYPE_LONG:
 	case TYPE_ULONG:
-		return llvm::Type::getInt64Ty(*nyla::llvm_context);
+		return llvm::Type::getInt64Ty(m_llvm_context);
 	case TYPE_FLOAT:
-		return llvm::Type::getFloatTy(*nyla::llvm_context);
+		return llvm::Type::getFloatTy(m_llvm_context);
 	case TYPE_DOUBLE:
-		return llvm::Type::getDoubleTy(*nyla::llvm_context);
+		return llvm::Type::getDoubleTy(m_llvm_context);
 	case TYPE_BOOL:
-		return llvm::Type::getInt1Ty(*nyla::llvm_context);
+		return llvm::Type::getInt1Ty(m_llvm_context);
 	case TYPE_VOID:
-		return llvm::Type::getVoidTy(*nyla::llvm_context);
+		return llvm::Type::getVoidTy(m_llvm_context);
 	case TYPE_PTR:
 		// Arrays are just pointers
 	case TYPE_ARR: {
@@ -1427,30 +1491,30 @@ llvm::Type* nyla::llvm_generator::gen_type(nyla::type* type) {
 		case TYPE_BYTE:
 		case TYPE_UBYTE:
 		case TYPE_CHAR8:
-			return llvm::Type::getInt8PtrTy(*nyla::llvm_context);
+			return llvm::Type::getInt8PtrTy(m_llvm_context);
 		case TYPE_SHORT:
 		case TYPE_USHORT:
 		case TYPE_CHAR16:
-			return llvm::Type::getInt16PtrTy(*nyla::llvm_context);
+			return llvm::Type::getInt16PtrTy(m_llvm_context);
 		case TYPE_INT:
 		case TYPE_UINT:
 		case TYPE_CHAR32:
-			return llvm::Type::getInt32PtrTy(*nyla::llvm_context);
+			return llvm::Type::getInt32PtrTy(m_llvm_context);
 		case TYPE_LONG:
 		case TYPE_ULONG:
-			return llvm::Type::getInt64PtrTy(*nyla::llvm_context);
+			return llvm::Type::getInt64PtrTy(m_llvm_context);
 		case TYPE_FLOAT:
-			return llvm::Type::getFloatPtrTy(*nyla::llvm_context);
+			return llvm::Type::getFloatPtrTy(m_llvm_context);
 		case TYPE_DOUBLE:
-			return llvm::Type::getDoublePtrTy(*nyla::llvm_context);
+			return llvm::Type::getDoublePtrTy(m_llvm_context);
 		case TYPE_BOOL:
-			return llvm::Type::getInt8PtrTy(*nyla::llvm_context);
+			return llvm::Type::getInt8PtrTy(m_llvm_context);
 		default:
 			return llvm::PointerType::get(gen_type(type->element_type), 0);
 		}
 	}
 	case TYPE_MODULE:
-		return type->sym_module->ll_struct_type;
+		return get_ll_struct_type(type->sym_module);
 	default:
 		assert(!"Unimplemented type generator");
 		return nullptr;
@@ -1459,7 +1523,7 @@ llvm::Type* nyla::llvm_generator::gen_type(nyla::type* type) {
 
 llvm::Value* nyla::llvm_generator::gen_allocation(sym_variable* sym_variable) {
 	llvm::Value* ll_alloca = m_llvm_builder->CreateAlloca(gen_type(sym_variable->type), nullptr);
-	sym_variable->ll_alloc = ll_alloca;
+	m_ll_allocs[sym_variable] = ll_alloca;
 	return ll_alloca;
 }
 
@@ -1500,7 +1564,7 @@ llvm::Value* nyla::llvm_generator::gen_array_alloca(nyla::type* element_type, u3
 
 	// To i32* to store the length
 	llvm::Value* ll_as_i32_ptr =
-		m_llvm_builder->CreateBitCast(ll_alloca, llvm::Type::getInt32PtrTy(*nyla::llvm_context));
+		m_llvm_builder->CreateBitCast(ll_alloca, llvm::Type::getInt32PtrTy(m_llvm_context));
 
 	// Storing the size at zero
 	m_llvm_builder->CreateStore(get_ll_uint32(num_elements), ll_as_i32_ptr);
@@ -1521,18 +1585,111 @@ llvm::Value* nyla::llvm_generator::get_arr_ptr(nyla::type* element_type, llvm::V
 }
 
 nyla::word nyla::llvm_generator::get_word(u32 word_key) {
-	return nyla::g_word_table->get_word(word_key);
+	return m_compiler.get_context().get_word_table().get_word(word_key);
+}
+
+llvm::Function* nyla::llvm_generator::get_ll_function(sym_function* sym_function) {
+	auto it = m_ll_functions.find(sym_function);
+	if (it != m_ll_functions.end()) {
+		return it->second;
+	}
+
+	// Declared by another file so it has to be declared
+	// in this module and resolved when linking
+	assert(!sym_function->ll_name.empty());
+	llvm::Function* ll_declaration = m_llvm_module->getFunction(sym_function->ll_name);
+	if (!ll_declaration) {
+		ll_declaration = llvm::Function::Create(
+			gen_function_type(sym_function),
+			llvm::Function::ExternalLinkage,
+			sym_function->ll_name,
+			*m_llvm_module
+		);
+		if (sym_function->mods & MOD_EXTERNAL) {
+			ll_declaration->setDLLStorageClass(llvm::GlobalValue::DLLImportStorageClass);
+			ll_declaration->setCallingConv(llvm::CallingConv::X86_StdCall); // TODO Windows only!
+		}
+	}
+	m_ll_functions[sym_function] = ll_declaration;
+	return ll_declaration;
+}
+
+llvm::Value* nyla::llvm_generator::get_ll_alloc(sym_variable* sym_variable) {
+	auto it = m_ll_allocs.find(sym_variable);
+	if (it != m_ll_allocs.end()) {
+		return it->second;
+	}
+
+	// Global of another file or one this file generates later.
+	// Declaring it without an initializer so it gets resolved
+	// when linking
+	assert(!sym_variable->ll_name.empty());
+	llvm::Value* ll_gvar = m_llvm_module->getOrInsertGlobal(sym_variable->ll_name, gen_type(sym_variable->type));
+	m_ll_allocs[sym_variable] = ll_gvar;
+	return ll_gvar;
+}
+
+llvm::StructType* nyla::llvm_generator::get_ll_struct_type(sym_module* sym_module) {
+	auto it = m_ll_struct_types.find(sym_module);
+	if (it != m_ll_struct_types.end()) {
+		return it->second;
+	}
+
+	// Module of another file. Entered before the body is set
+	// since the fields may point back to the module
+	std::string struct_name = get_word(sym_module->name_key).c_str();
+	struct_name += ".";
+	struct_name += nyla::replace(sym_module->internal_path, "/", ".");
+	llvm::StructType* ll_struct_type = llvm::StructType::create(m_llvm_context, struct_name);
+	m_ll_struct_types[sym_module] = ll_struct_type;
+	gen_struct_body(sym_module, ll_struct_type);
+	return ll_struct_type;
+}
+
+llvm::FunctionType* nyla::llvm_generator::gen_function_type(sym_function* sym_function) {
+	llvm::Type* ll_return_type = gen_type(sym_function->return_type);
+	std::vector<llvm::Type*> ll_parameter_types;
+
+	// First parameter of member functions are is the pointer to the object
+	if (sym_function->is_member_function()) {
+		ll_parameter_types.push_back(
+			llvm::PointerType::get(get_ll_struct_type(sym_function->sym_module), 0));
+	}
+
+	for (nyla::type* param_type : sym_function->param_types) {
+		ll_parameter_types.push_back(gen_type(param_type));
+	}
+
+	bool is_var_args = false;
+	return llvm::FunctionType::get(ll_return_type, ll_parameter_types, is_var_args);
+}
+
+void nyla::llvm_generator::gen_struct_body(sym_module* sym_module, llvm::StructType* ll_struct_type) {
+	std::vector<llvm::Type*> ll_struct_types;
+	for (nyla::avariable_decl* field : sym_module->fields) {
+		ll_struct_types.push_back(gen_type(field->type));
+	}
+
+	if (ll_struct_types.empty()) {
+		ll_struct_types.push_back(llvm::Type::getInt8Ty(m_llvm_context));
+	}
+	ll_struct_type->setBody(ll_struct_types);
+}
+
+void nyla::llvm_generator::add_global_initialize_expr(nyla::avariable_decl* global) {
+	global->global_initializer_expr = true;
+	m_sym_table->m_global_initializer_exprs.push_back(global);
 }
 
 void nyla::llvm_generator::gen_default_value(sym_variable* sym_variable, nyla::type* type, bool default_initialize) {
 	if (!type->is_arr()) {
 		if (default_initialize) {
 			llvm::Value* default_value = gen_default_value(type);
-			m_llvm_builder->CreateStore(default_value, sym_variable->ll_alloc);
+			m_llvm_builder->CreateStore(default_value, get_ll_alloc(sym_variable));
 		}
 	} else {
 		if (default_initialize) {
-			gen_default_array(sym_variable, type, m_llvm_builder->CreateLoad(sym_variable->ll_alloc));
+			gen_default_array(sym_variable, type, m_llvm_builder->CreateLoad(get_ll_alloc(sym_variable)));
 		}
 	}
 }
@@ -1554,9 +1711,9 @@ llvm::Constant* nyla::llvm_generator::gen_default_value(nyla::type* type) {
 	case TYPE_LONG:                    return get_ll_int64(0);
 	case TYPE_ULONG:                   return get_ll_uint64(0);
 	case TYPE_FLOAT:
-		return llvm::ConstantFP::get(*nyla::llvm_context, llvm::APFloat((float) 0.0F));
+		return llvm::ConstantFP::get(m_llvm_context, llvm::APFloat((float) 0.0F));
 	case TYPE_DOUBLE:
-		return llvm::ConstantFP::get(*nyla::llvm_context, llvm::APFloat((double) 0.0));
+		return llvm::ConstantFP::get(m_llvm_context, llvm::APFloat((double) 0.0));
 	default:
 		assert(!"Failed to implement default value for type");
 		return nullptr;
@@ -1599,7 +1756,7 @@ llvm::Value* nyla::llvm_generator::gen_malloc(llvm::Type* ll_type_to_alloc,
 	
 	llvm::Value* ll_malloc = llvm::CallInst::CreateMalloc(
 		m_llvm_builder->GetInsertBlock(),      // BasicBlock *InsertAtEnd
-		llvm::Type::getInt64Ty(*llvm_context), // Type *IntPtrTy
+		llvm::Type::getInt64Ty(m_llvm_context), // Type *IntPtrTy
 		ll_type_to_alloc,                      // Type *AllocTy
 		get_ll_int64(total_mem_size),          // Value *AllocSize
 		ll_array_size,
@@ -1610,47 +1767,47 @@ llvm::Value* nyla::llvm_generator::gen_malloc(llvm::Type* ll_type_to_alloc,
 	return ll_malloc;
 }
 
-llvm::Constant* nyla::get_ll_int1(bool tof) {
+llvm::Constant* nyla::llvm_generator::get_ll_int1(bool tof) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt1Ty(*nyla::llvm_context), tof ? 1 : 0, true);
+		llvm::IntegerType::getInt1Ty(m_llvm_context), tof ? 1 : 0, true);
 }
-llvm::Constant* nyla::get_ll_int8(s32 value) {
+llvm::Constant* nyla::llvm_generator::get_ll_int8(s32 value) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt8Ty(*nyla::llvm_context), value, true);
+		llvm::IntegerType::getInt8Ty(m_llvm_context), value, true);
 }
-llvm::Constant* nyla::get_ll_uint8(u32 value) {
+llvm::Constant* nyla::llvm_generator::get_ll_uint8(u32 value) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt8Ty(*nyla::llvm_context), value, false);
+		llvm::IntegerType::getInt8Ty(m_llvm_context), value, false);
 }
-llvm::Constant* nyla::get_ll_int16(s32 value) {
+llvm::Constant* nyla::llvm_generator::get_ll_int16(s32 value) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt16Ty(*nyla::llvm_context), value, true);
+		llvm::IntegerType::getInt16Ty(m_llvm_context), value, true);
 }
-llvm::Constant* nyla::get_ll_uint16(u32 value) {
+llvm::Constant* nyla::llvm_generator::get_ll_uint16(u32 value) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt16Ty(*nyla::llvm_context), value, false);
+		llvm::IntegerType::getInt16Ty(m_llvm_context), value, false);
 }
-llvm::Constant* nyla::get_ll_int32(s32 value) {
+llvm::Constant* nyla::llvm_generator::get_ll_int32(s32 value) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt32Ty(*nyla::llvm_context), value, true);
+		llvm::IntegerType::getInt32Ty(m_llvm_context), value, true);
 }
-llvm::Constant* nyla::get_ll_uint32(u32 value) {
+llvm::Constant* nyla::llvm_generator::get_ll_uint32(u32 value) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt32Ty(*nyla::llvm_context), value, false);;
+		llvm::IntegerType::getInt32Ty(m_llvm_context), value, false);;
 }
-llvm::Constant* nyla::get_ll_int64(s64 value) {
+llvm::Constant* nyla::llvm_generator::get_ll_int64(s64 value) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt64Ty(*nyla::llvm_context), value, true);
+		llvm::IntegerType::getInt64Ty(m_llvm_context), value, true);
 }
-llvm::Constant* nyla::get_ll_uint64(u64 value) {
+llvm::Constant* nyla::llvm_generator::get_ll_uint64(u64 value) {
 	return llvm::ConstantInt::get(
-		llvm::IntegerType::getInt64Ty(*nyla::llvm_context), value, false);
+		llvm::IntegerType::getInt64Ty(m_llvm_context), value, false);
 }
 
 void nyla::llvm_generator::branch_if_not_term(llvm::BasicBlock* ll_bb) {
-	// Avoiding back-to-back branching
-	llvm::Instruction* instruction = &m_llvm_builder->GetInsertBlock()->back();
-	if (!instruction->isTerminator()) {
+	// Avoiding back-to-back branching. The block may
+	// also be empty such as after a nested loop
+	if (!m_llvm_builder->GetInsertBlock()->getTerminator()) {
 		// Unconditional branch
 		m_llvm_builder->CreateBr(ll_bb);
 	}
@@ -4,6 +4,7 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/IRBuilder.h>
 #include <functional>
+#include <unordered_map>
 
 #include "compiler.h"
 #include "ast.h"
@@ -11,41 +12,56 @@
 
 namespace nyla {
 
-	llvm::Constant* get_ll_int1(bool tof);
-	llvm::Constant* get_ll_int8(s32 value);
-	llvm::Constant* get_ll_uint8(u32 value);
-	llvm::Constant* get_ll_int16(s32 value);
-	llvm::Constant* get_ll_uint16(u32 value);
-	llvm::Constant* get_ll_int32(s32 value);
-	llvm::Constant* get_ll_uint32(u32 value);
-	llvm::Constant* get_ll_int64(s64 value);
-	llvm::Constant* get_ll_uint64(u64 value);
-
+	/*
+	 * Generates the LLVM IR of a file into the file's module.
+	 *
+	 * Every module has an LLVMContext of its own so files are
+	 * generated on different threads at the same time. Types,
+	 * functions and globals of other files are declared in the
+	 * module by name and resolved when linking.
+	 */
 	class llvm_generator {
 	public:
 
 		~llvm_generator();
 
 		llvm_generator(nyla::compiler& compiler, llvm::Module* llvm_module,
-			           nyla::afile_unit* file_unit, bool print);
+			           nyla::sym_table* sym_table, bool print);
 
 		void gen_file_unit();
 
+		// Generates only the globals of the file. Used instead of
+		// gen_file_unit when the object code of the file comes from
+		// the object cache so importers can still refer to them
+		void gen_file_unit_globals();
+
+		// Functions are declared without generating their entry
+		// blocks so the module only holds declarations
+		void set_declarations_only(bool declarations_only);
+
+		// Names the functions and globals of an analyzed file. The
+		// names are written to the interface of the file so files
+		// loaded from their interface can be called by name
+		static void name_symbols(nyla::compiler& compiler, nyla::sym_table* sym_table);
+
 		void gen_type_declarations();
 		void gen_body_declarations();
 
-		void gen_global_initializers(sym_function* sym_main_function,
-			                         const std::vector<nyla::avariable_decl*>& initializer_expressions);
-		void gen_startup_function_calls(sym_function* sym_main_function,
-			                            const std::vector<llvm::Function*>& ll_startup_functions);
+		// Generates the function main calls before anything else
+		// to initialize globals and call the startup functions
+		void gen_init_function(const std::vector<nyla::avariable_decl*>& initializer_expressions,
+			                   const std::vector<sym_function*>& startup_functions);
 
 		void gen_module(nyla::amodule* nmodule);
+		void gen_module_globals(nyla::amodule* nmodule);
 
 		void gen_function_declaration(nyla::afunction* function);
 		llvm::Value* gen_global_variable(nyla::avariable_decl* global);
 		llvm::Constant* gen_global_module(nyla::avariable_decl* static_module);
 
 		void gen_function_body(nyla::afunction* function);
+		// Functions the program never calls are left as declarations
+		void gen_reachable_function_body(nyla::afunction* function);
 
 		llvm::Value* gen_expression(nyla::aexpr* expr);
 		// Since gen_expression returns lvalues for variables
@@ -106,6 +122,32 @@ namespace nyla {
 
 		nyla::word get_word(u32 word_key);
 
+		// Constants within the LLVM context of the compiler
+		llvm::Constant* get_ll_int1(bool tof);
+		llvm::Constant* get_ll_int8(s32 value);
+		llvm::Constant* get_ll_uint8(u32 value);
+		llvm::Constant* get_ll_int16(s32 value);
+		llvm::Constant* get_ll_uint16(u32 value);
+		llvm::Constant* get_ll_int32(s32 value);
+		llvm::Constant* get_ll_uint32(u32 value);
+		llvm::Constant* get_ll_int64(s64 value);
+		llvm::Constant* get_ll_uint64(u64 value);
+
+		// Each file has its own module so functions, globals and
+		// module types from other files have to be declared in
+		// this module before they can be used
+		llvm::Function* get_ll_function(sym_function* sym_function);
+		llvm::Value* get_ll_alloc(sym_variable* sym_variable);
+		llvm::StructType* get_ll_struct_type(sym_module* sym_module);
+
+		llvm::FunctionType* gen_function_type(sym_function* sym_function);
+
+		// Sets the fields of the module as the body of its struct
+		void gen_struct_body(sym_module* sym_module, llvm::StructType* ll_struct_type);
+
+		// The global is initialized by the init function
+		void add_global_initialize_expr(nyla::avariable_decl* global);
+
 		void gen_default_value(sym_variable* sym_variable, nyla::type* type, bool default_initialize);
 		llvm::Constant* gen_default_value(nyla::type* type);
 		void gen_default_array(sym_variable* sym_variable,
@@ -122,9 +164,18 @@ namespace nyla {
 		// was not also a branch
 		void branch_if_not_term(llvm::BasicBlock* ll_bb);
 
+		nyla::sym_table*  m_sym_table = nullptr;
 		nyla::afile_unit* m_file_unit = nullptr;
 
+		// llvm values of the symbols within this module
+		std::unordered_map<sym_module*, llvm::StructType*> m_ll_struct_types;
+		std::unordered_map<sym_function*, llvm::Function*> m_ll_functions;
+		   // Allocations of local variables, globals and the
+		   // fields of the module being initialized
+		std::unordered_map<sym_variable*, llvm::Value*>    m_ll_allocs;
+
 		nyla::compiler&    m_compiler;
+		llvm::LLVMContext& m_llvm_context;
 		llvm::Module*      m_llvm_module;
 		llvm::IRBuilder<>* m_llvm_builder;
 		nyla::afunction*   m_function = nullptr;
@@ -144,6 +195,12 @@ namespace nyla {
 		// Print the IR to console or not
 		bool m_print;
 
+		bool m_declarations_only = false;
+
+		// Types are named after the file
+		std::string m_file_name;
+		u32         m_num_global_const_arrays = 0;
+
 	};
 }
 
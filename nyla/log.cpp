@@ -6,6 +6,7 @@
 #include "ast.h"
 
 #include <iostream>
+#include <mutex>
 
 std::string replace_tabs_with_spaces(std::string& s) {
 	std::string no_tabs;
@@ -24,6 +25,7 @@ void nyla::log::global_error(error_tag error_tag) {
 }
 
 void nyla::log::global_error(error_tag tag, const error_payload& payload) {
+	std::lock_guard<std::mutex> lock(m_context->get_print_mutex());
 	set_console_color(console_color_red);
 	std::cerr << "error: ";
 	set_console_color(console_color_default);
@@ -60,6 +62,14 @@ void nyla::log::global_error(error_tag tag, const error_payload& payload) {
 		std::cerr << "The entry point file was empty";
 		break;
 	}
+	case ERR_FAILED_TO_LINK: {
+		std::cerr << "Failed to link the executable: \"" << payload.d_string->str << "\"";
+		break;
+	}
+	case ERR_FAILED_TO_LOAD_INTERFACE: {
+		std::cerr << "Failed to load the interface of: \"" << payload.d_string->str << "\"";
+		break;
+	}
 	}
 	std::cerr << ".\n";
 }
@@ -68,6 +78,7 @@ void nyla::log::err(error_tag tag, const error_payload& payload,
 	                u32 line_num,
 	                u32 spos,
 	                u32 epos) {
+	std::lock_guard<std::mutex> lock(m_context->get_print_mutex());
 	if (!m_file_path.empty()) {
 		std::cerr << m_file_path << ":";
 	}
@@ -114,10 +125,15 @@ void nyla::log::err(error_tag tag, const error_payload& payload,
 	}
 	case ERR_EXPECTED_TOKEN: {
 		err_expected_token* expected_token = payload.d_expected_token;
+		const nyla::token& found_token = expected_token->found_token;
+		// String literals are shown as they were written
+		// since the token does not hold the characters
+		std::string found = found_token.tag == TK_VALUE_STRING8 && m_source
+			                    ? m_source->from_range({ found_token.spos, found_token.epos })
+			                    : found_token.to_string(*m_context);
 		std::cerr << "Expected Token '"
-			      << nyla::token_tag_to_string(expected_token->expected_tag) << "'"
-			      << " but found '"
-			      << expected_token->found_token.to_string() << "'";
+			      << nyla::token_tag_to_string(expected_token->expected_tag, *m_context) << "'"
+			      << " but found '" << found << "'";
 		break;
 	}
 	case ERR_CANNOT_FIND_IMPORT: {
@@ -219,17 +235,17 @@ void nyla::log::err(error_tag tag, const error_payload& payload,
 	}
 	case ERR_CANNOT_ASSIGN: {
 		std::cerr << "Cannot assign value of type '"
-			      << payload.d_types->t1->to_string()
+			      << payload.d_types->t1->to_string(m_context->get_word_table())
 			      << "' to variable of type '"
-			      << payload.d_types->t2->to_string()
+			      << payload.d_types->t2->to_string(m_context->get_word_table())
 			      << "'";
 		break;
 	}
 	case ERR_RETURN_VALUE_NOT_COMPATIBLE_WITH_RETURN_TYPE: {
 		std::cerr << "Return value of type '"
-			      << payload.d_types->t1->to_string()
+			      << payload.d_types->t1->to_string(m_context->get_word_table())
 			      << "' not compatible with return type '"
-			      << payload.d_types->t2->to_string()
+			      << payload.d_types->t2->to_string(m_context->get_word_table())
 			      << "'";
 		break;
 	}
@@ -246,9 +262,9 @@ void nyla::log::err(error_tag tag, const error_payload& payload,
 	}
 	case ERR_OP_CANNOT_APPLY_TO: {
 		err_op_cannot_apply* op_cannot_apply = payload.d_op_cannot_apply;
-		std::cerr << "Operator '" << nyla::token_tag_to_string(op_cannot_apply->op)
+		std::cerr << "Operator '" << nyla::token_tag_to_string(op_cannot_apply->op, *m_context)
 			      << "' cannot apply to type '"
-			      << op_cannot_apply->type->to_string() << "'";
+			      << op_cannot_apply->type->to_string(m_context->get_word_table()) << "'";
 		break;
 	}
 	case ERR_EXPECTED_BOOL_COND: {
@@ -260,7 +276,7 @@ void nyla::log::err(error_tag tag, const error_payload& payload,
 		std::cerr << "Could not find overloaded function match for function type: "
 			      << word_as_string(function_call->name_key) << "(";
 		for (u32 i = 0; i < function_call->arguments.size(); i++) {
-			std::cerr << function_call->arguments[i]->type->to_string();
+			std::cerr << function_call->arguments[i]->type->to_string(m_context->get_word_table());
 			if (i + 1 != function_call->arguments.size()) std::cerr << ", ";
 		}
 		std::cerr << ")";
@@ -271,7 +287,7 @@ void nyla::log::err(error_tag tag, const error_payload& payload,
 		std::cerr << "Could not find overloaded constructor match constructor type: "
 			      << word_as_string(function_call->name_key) << "(";
 		for (u32 i = 0; i < function_call->arguments.size(); i++) {
-			std::cerr << function_call->arguments[i]->type->to_string();
+			std::cerr << function_call->arguments[i]->type->to_string(m_context->get_word_table());
 			if (i + 1 != function_call->arguments.size()) std::cerr << ", ";
 		}
 		std::cerr << ")";
@@ -282,9 +298,9 @@ void nyla::log::err(error_tag tag, const error_payload& payload,
 		break;
 	}
 	case ERR_ELEMENT_OF_ARRAY_NOT_COMPATIBLE_WITH_ARRAY: {
-		std::cerr << "Element of type '" << payload.d_types->t2->to_string()
+		std::cerr << "Element of type '" << payload.d_types->t2->to_string(m_context->get_word_table())
 			      << "' is not compatible with the array's element type '"
-			      << payload.d_types->t1->to_string() << "'";
+			      << payload.d_types->t1->to_string(m_context->get_word_table()) << "'";
 		break;
 	}
 	case ERR_COULD_NOT_FIND_MODULE_TYPE: {
@@ -449,7 +465,7 @@ void nyla::log::err(error_tag tag, const error_payload& payload,
 }
 
 std::string nyla::log::word_as_string(u32 word_key) {
-	return g_word_table->get_word(word_key).c_str();
+	return m_context->get_word_table().get_word(word_key).c_str();
 }
 
 std::string nyla::log::header_spaces(u32 line_num) {
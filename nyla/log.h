@@ -16,6 +16,8 @@ namespace nyla {
 		ERR_MAIN_FUNCTION_NOT_FOUND,
 		ERR_FILE_WITH_MAIN_FUNCTION_DOES_NOT_EXIST,
 		ERR_FILE_WITH_MAIN_FUNCTION_EMPTY,
+		ERR_FAILED_TO_LINK,
+		ERR_FAILED_TO_LOAD_INTERFACE,
 
 		// Lexer Errors
 		ERR_UNKNOWN_CHARACTER,
@@ -231,10 +233,11 @@ namespace nyla {
 	class log {
 	public:
 
-		log() {}
+		log(nyla::compilation_context& context)
+			: m_context(&context) {}
 
-		log(nyla::source& source)
-			: m_source(&source) {}
+		log(nyla::source& source, nyla::compilation_context& context)
+			: m_source(&source), m_context(&context) {}
 
 		void global_error(error_tag tag);
 
@@ -284,9 +287,10 @@ namespace nyla {
 		// Spaces of: "path:number error: "
 		std::string header_spaces(u32 line_num);
 
-		std::string   m_file_path;
-		nyla::source* m_source     = nullptr;
-		u32           m_num_errors = 0;
+		std::string                m_file_path;
+		nyla::source*              m_source     = nullptr;
+		nyla::compilation_context* m_context    = nullptr;
+		u32                        m_num_errors = 0;
 	};
 
 }
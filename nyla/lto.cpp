@@ -0,0 +1,87 @@
+#include "lto.h"
+
+#include <llvm/LTO/LTO.h>
+
+#include <memory>
+
+// Level of the optimizations ran by LTO
+static unsigned get_lto_opt_level(nyla::opt_level opt_level) {
+	switch (opt_level) {
+	case nyla::OPT_LEVEL_O0: return 0;
+	case nyla::OPT_LEVEL_O1: return 1;
+	case nyla::OPT_LEVEL_O3: return 3;
+	default:                 return 2;
+	}
+}
+
+bool nyla::run_lto(const std::vector<obj_file>& bitcode_files,
+	               std::vector<obj_file>& obj_files,
+	               llvm::TargetMachine* target_machine,
+	               nyla::opt_level opt_level, nyla::lto_mode lto_mode,
+	               u32 num_jobs, const std::string& obj_name) {
+	llvm::lto::Config config;
+	config.CPU           = target_machine->getTargetCPU().str();
+	config.MAttrs.push_back(target_machine->getTargetFeatureString().str());
+	config.Options       = target_machine->Options;
+	config.RelocModel    = target_machine->getRelocationModel();
+	config.CodeModel     = target_machine->getCodeModel();
+	config.DefaultTriple = target_machine->getTargetTriple().str();
+	config.CGOptLevel    = get_codegen_opt_level(opt_level);
+	config.OptLevel      = get_lto_opt_level(opt_level);
+	// The pipelines of the new pass manager require optimizations
+	config.UseNewPM      = opt_level != OPT_LEVEL_O0;
+
+	llvm::lto::ThinBackend thin_backend = nullptr;
+	if (lto_mode == LTO_THIN) {
+		thin_backend = llvm::lto::createInProcessThinBackend(num_jobs);
+	}
+	llvm::lto::LTO lto(std::move(config), std::move(thin_backend));
+
+	for (const obj_file& bitcode_file : bitcode_files) {
+		llvm::MemoryBufferRef buffer(
+			llvm::StringRef(bitcode_file.buffer.data(), bitcode_file.buffer.size()), bitcode_file.name);
+		llvm::Expected<std::unique_ptr<llvm::lto::InputFile>> input = llvm::lto::InputFile::create(buffer);
+		if (!input) {
+			llvm::errs() << "Failed to read bitcode of: " << bitcode_file.name << '\n';
+			llvm::consumeError(input.takeError());
+			return false;
+		}
+
+		// Every file of the program is part of LTO so only main has
+		// to stay visible for the C runtime which calls it. Everything
+		// else may be internalized and removed once inlined
+		std::vector<llvm::lto::SymbolResolution> resolutions;
+		for (const llvm::lto::InputFile::Symbol& symbol : (*input)->symbols()) {
+			llvm::lto::SymbolResolution resolution;
+			resolution.Prevailing                   = !symbol.isUndefined();
+			resolution.FinalDefinitionInLinkageUnit = !symbol.isUndefined();
+			resolution.VisibleToRegularObj          = symbol.getName() == "main";
+			resolutions.push_back(resolution);
+		}
+
+		if (llvm::Error err = lto.add(std::move(*input), resolutions)) {
+			llvm::errs() << "Failed to add bitcode of: " << bitcode_file.name << '\n';
+			llvm::consumeError(std::move(err));
+			return false;
+		}
+	}
+
+	// Each task of LTO writes object code to its own buffer
+	std::vector<llvm::SmallVector<char, 0>> buffers(lto.getMaxTasks());
+	auto add_stream = [&buffers](unsigned task) {
+		return std::make_unique<llvm::lto::NativeObjectStream>(
+			std::make_unique<llvm::raw_svector_ostream>(buffers[task]));
+	};
+	if (llvm::Error err = lto.run(add_stream)) {
+		llvm::errs() << "LTO failed: " << llvm::toString(std::move(err)) << '\n';
+		return false;
+	}
+
+	for (ulen task = 0; task < buffers.size(); task++) {
+		if (buffers[task].empty()) continue;
+		obj_files.emplace_back();
+		obj_files.back().name   = obj_name + "." + std::to_string(task) + ".o";
+		obj_files.back().buffer = std::move(buffers[task]);
+	}
+	return true;
+}
@@ -0,0 +1,21 @@
+#ifndef NYLA_LTO_H
+#define NYLA_LTO_H
+
+#include "code_gen.h"
+
+namespace nyla {
+
+	// Optimizes the bitcode of every file together and generates
+	// the object code of the program into obj_files. With ThinLTO
+	// functions are imported across files and the files are then
+	// optimized and compiled in parallel on num_jobs threads.
+	// The object files are named obj_name.<task>.o
+	bool run_lto(const std::vector<obj_file>& bitcode_files,
+		         std::vector<obj_file>& obj_files,
+		         llvm::TargetMachine* target_machine,
+		         nyla::opt_level opt_level, nyla::lto_mode lto_mode,
+		         u32 num_jobs, const std::string& obj_name);
+
+}
+
+#endif
@@ -41,9 +41,13 @@ case TK_CONST:
 nyla::parser::parser(nyla::compiler& compiler, nyla::lexer& lexer,
 	                 nyla::log& log, nyla::sym_table* sym_table,
 	                 nyla::afile_unit* file_unit)
-	: m_compiler(compiler), m_lexer(lexer), m_log(log), m_sym_table(sym_table), m_file_unit(file_unit) {
+	: m_compiler(compiler), m_lexer(lexer), m_log(log), m_sym_table(sym_table),
+	  m_context(compiler.get_context()),
+	  m_types(m_context.get_builtin_types()),
+	  m_reserved_words(m_context.get_reserved_words()),
+	  m_file_unit(file_unit) {
 	// Read first token to get things started.
-	next_token();
+	m_current = get_token(m_token_index);
 }
 
 void nyla::parser::parse_imports() {
@@ -80,7 +84,7 @@ bool nyla::parser::parse_import() {
 	std::string file_path = "";
 	do {
 		u32 ident_key = parse_identifier();
-		if (ident_key == nyla::unidentified_ident) {
+		if (ident_key == m_reserved_words.unidentified_ident) {
 			skip_recovery();
 			return false; // Not continuing due to an error
 		}
@@ -89,7 +93,7 @@ bool nyla::parser::parse_import() {
 			file_path += "/";
 		}
 
-		file_path += g_word_table->get_word(ident_key).c_str();
+		file_path += m_context.get_word_table().get_word(ident_key).c_str();
 
 		more_dots = m_current.tag == '.';
 		if (more_dots) {
@@ -105,14 +109,14 @@ bool nyla::parser::parse_import() {
 		do {
 			nyla::token alias_st = m_current;
 			u32 original_module_name_key = parse_identifier();
-			if (original_module_name_key == nyla::unidentified_ident) {
+			if (original_module_name_key == m_reserved_words.unidentified_ident) {
 				return false;
 			}
 			if (!match(TK_MINUS_GT)) {
 				return false;
 			}
 			u32 alias_module_name_key = parse_identifier();
-			if (alias_module_name_key == nyla::unidentified_ident) {
+			if (alias_module_name_key == m_reserved_words.unidentified_ident) {
 				return false;
 			}
 			auto it = nimport->module_aliases.find(original_module_name_key);
@@ -238,6 +242,9 @@ void nyla::parser::resolve_imports() {
 
 void nyla::parser::parse_file_unit() {
 
+	// Lexing the rest of the file in one pass
+	m_lexer.lex_file();
+
 	// Parsing modules
 	while (m_current.tag != TK_EOF) {
 		switch (m_current.tag) {
@@ -269,7 +276,7 @@ nyla::amodule* nyla::parser::parse_module() {
 	nmodule->name_key      = parse_identifier();
 	m_module = nmodule;
 	
-	if (nmodule->name_key == nyla::unidentified_ident) {
+	if (nmodule->name_key == m_reserved_words.unidentified_ident) {
 		return nullptr;
 	}
 
@@ -292,7 +299,7 @@ nyla::amodule* nyla::parser::parse_module() {
 
 
 	// Entering in the module type
-	nyla::type* module_type = nyla::type::get_or_enter_module(nmodule->sym_module);
+	nyla::type* module_type = m_context.get_type_table().get_or_enter_module(nmodule->sym_module);
 
 	// Checking for forward declared types
 	auto it = m_forward_declared_types.find(nmodule->name_key);
@@ -439,24 +446,24 @@ nyla::type_info nyla::parser::parse_type() {
 	nyla::type* base_type = nullptr;
 	switch (m_current.tag) {
 		// Integers
-	case TK_TYPE_BYTE:   base_type = nyla::types::type_byte;   next_token(); break;
-	case TK_TYPE_SHORT:  base_type = nyla::types::type_short;  next_token(); break;
-	case TK_TYPE_INT:    base_type = nyla::types::type_int;    next_token(); break;
-	case TK_TYPE_LONG:   base_type = nyla::types::type_long;   next_token(); break;
-	case TK_TYPE_UBYTE:  base_type = nyla::types::type_ubyte;  next_token(); break;
-	case TK_TYPE_USHORT: base_type = nyla::types::type_ushort; next_token(); break;
-	case TK_TYPE_UINT:   base_type = nyla::types::type_uint;   next_token(); break;
-	case TK_TYPE_ULONG:  base_type = nyla::types::type_ulong;  next_token(); break;
+	case TK_TYPE_BYTE:   base_type = m_types.type_byte;   next_token(); break;
+	case TK_TYPE_SHORT:  base_type = m_types.type_short;  next_token(); break;
+	case TK_TYPE_INT:    base_type = m_types.type_int;    next_token(); break;
+	case TK_TYPE_LONG:   base_type = m_types.type_long;   next_token(); break;
+	case TK_TYPE_UBYTE:  base_type = m_types.type_ubyte;  next_token(); break;
+	case TK_TYPE_USHORT: base_type = m_types.type_ushort; next_token(); break;
+	case TK_TYPE_UINT:   base_type = m_types.type_uint;   next_token(); break;
+	case TK_TYPE_ULONG:  base_type = m_types.type_ulong;  next_token(); break;
 		// Characters
-	case TK_TYPE_CHAR8:   base_type = nyla::types::type_char8;   next_token(); break;
-	case TK_TYPE_CHAR16:  base_type = nyla::types::type_char16;  next_token(); break;
-	case TK_TYPE_CHAR32:  base_type = nyla::types::type_char32;  next_token(); break;
+	case TK_TYPE_CHAR8:   base_type = m_types.type_char8;   next_token(); break;
+	case TK_TYPE_CHAR16:  base_type = m_types.type_char16;  next_token(); break;
+	case TK_TYPE_CHAR32:  base_type = m_types.type_char32;  next_token(); break;
 		// Floats
-	case TK_TYPE_FLOAT:  base_type = nyla::types::type_float;  next_token(); break;
-	case TK_TYPE_DOUBLE: base_type = nyla::types::type_double; next_token(); break;
+	case TK_TYPE_FLOAT:  base_type = m_types.type_float;  next_token(); break;
+	case TK_TYPE_DOUBLE: base_type = m_types.type_double; next_token(); break;
 		// Other
-	case TK_TYPE_BOOL:   base_type = nyla::types::type_bool; next_token(); break;
-	case TK_TYPE_VOID:   base_type = nyla::types::type_void; next_token(); break;
+	case TK_TYPE_BOOL:   base_type = m_types.type_bool; next_token(); break;
+	case TK_TYPE_VOID:   base_type = m_types.type_void; next_token(); break;
 		// Module
 	case TK_IDENTIFIER: {
 		sym_module* sym_module = m_file_unit->find_module(m_current.word_key);
@@ -467,7 +474,7 @@ nyla::type_info nyla::parser::parse_type() {
 		// file and is resolved after parsing
 
 		if (!sym_module) {
-			base_type = nyla::type::get_fd_module(&m_fd_type_table, m_current.word_key);
+			base_type = m_fd_type_table.get_fd_module(m_current.word_key);
 
 			// Storing information about the forward declaration to ensure it's
 			// resolution later
@@ -486,14 +493,14 @@ nyla::type_info nyla::parser::parse_type() {
 			forward_declared_type.debug_locations.push_back(forward_declared_debug);
 		} else {
 			// Not forward declared so using the type
-			base_type = nyla::type::get_or_enter_module(sym_module);
+			base_type = m_context.get_type_table().get_or_enter_module(sym_module);
 		}
 
 		next_token();
 		break;
 	}
 	default: {
-		info.type = nyla::types::type_error;
+		info.type = m_types.type_error;
 		m_log.err(ERR_EXPECTED_VALID_TYPE, m_current);
 		skip_recovery();
 		return info;
@@ -507,9 +514,9 @@ nyla::type_info nyla::parser::parse_type() {
 			next_token(); // Consuming *
 			++num_stars;
 		}
-		base_type = nyla::type::get_ptr(base_type);
+		base_type = m_context.get_type_table().get_ptr(base_type);
 		for (u32 i = 1; i < num_stars; i++) {
-			base_type = nyla::type::get_ptr(base_type);
+			base_type = m_context.get_type_table().get_ptr(base_type);
 		}
 
 		if (num_stars > nyla::MAX_SUBSCRIPTS) {
@@ -539,9 +546,9 @@ nyla::type_info nyla::parser::parse_type() {
 		}
 
 		u32 num_brackets = dim_sizes.size();
-		base_type = nyla::type::get_arr(base_type);
+		base_type = m_context.get_type_table().get_arr(base_type);
 		for (u32 i = 1; i < num_brackets; i++) {
-			base_type = nyla::type::get_arr(base_type);
+			base_type = m_context.get_type_table().get_arr(base_type);
 		}
 		info.dim_sizes = dim_sizes;
 
@@ -564,7 +571,7 @@ nyla::afunction* nyla::parser::parse_function(bool is_constructor, nyla::aannota
 	// TODO: prevent the return type from having dimensional info in it's
 	// array types
 	if (is_constructor) {
-		function->return_type = nyla::types::type_void;
+		function->return_type = m_types.type_void;
 	} else {
 		function->return_type = return_type.type;
 	}
@@ -627,13 +634,13 @@ nyla::afunction* nyla::parser::parse_function(bool is_constructor, nyla::aannota
 	function->sym_function->param_types = param_types;
 
 	if (annotation) {
-		if (annotation->ident_key == nyla::startup_ident) {
+		if (annotation->ident_key == m_reserved_words.startup_ident) {
 			if (is_constructor) {
 				m_log.err(ERR_CONSTRUCTOR_MARKED_STARTUP, function);
 			} else {
 				// Functions with the @StartUp annotation must have
 				// no parameters and must return void
-				if (function->return_type != nyla::types::type_void) {
+				if (function->return_type != m_types.type_void) {
 					m_log.err(ERR_FUNCTION_MARKED_STARTUP_NOT_VOID_RETURN, function);
 				}
 				if (!function->parameters.empty()) {
@@ -656,7 +663,7 @@ nyla::afunction* nyla::parser::parse_function(bool is_constructor, nyla::aannota
 	if (m_sym_table->m_search_for_main_function) {
 		if (!function->sym_function->is_member_function()) {
 			if (!function->is_external() && !(function->sym_function->mods & nyla::ACCESS_MODS)) {
-				if (function->name_key == nyla::main_ident) {
+				if (function->name_key == m_reserved_words.main_ident) {
 					// Canidate function for "main"
 					// TODO: need to also check for program arguments
 					if (function->parameters.size() == 0) {
@@ -694,11 +701,11 @@ nyla::avariable_decl* nyla::parser::parse_variable_decl(u32 mods,
 	variable_decl->name_key = ident->ident_key;
 	variable_decl->type = type;
 
-	if (variable_decl->name_key == nyla::unidentified_ident) {
+	if (variable_decl->name_key == m_reserved_words.unidentified_ident) {
 		// TODO
 	}
 
-	if (type == nyla::types::type_void) {
+	if (type == m_types.type_void) {
 		m_log.err(ERR_VARIABLE_HAS_VOID_TYPE,
 			error_payload::word(variable_decl->name_key),
 			variable_decl);
@@ -888,7 +895,7 @@ nyla::aannotation* nyla::parser::parse_annotation() {
 	next_token(); // Consuming '@'
 	
 	u32 ident_key = parse_identifier();
-	if (ident_key == nyla::unidentified_ident) {
+	if (ident_key == m_reserved_words.unidentified_ident) {
 		// Returning since annotations expect an identifier
 		return annotation;
 	}
@@ -1101,7 +1108,7 @@ nyla::aexpr* nyla::parser::parse_expression(nyla::aexpr* lhs) {
 
 nyla::aexpr* nyla::parser::on_binary_op(const nyla::token& op_token, nyla::aexpr* lhs, nyla::aexpr* rhs) {
 	// Subdivides an equal and operator into seperate nodes.
-	static auto equal_and_op_apply =
+	auto equal_and_op_apply =
 		[this, op_token](u32 op, nyla::aexpr* lhs, nyla::aexpr* rhs) -> nyla::abinary_op* {
 		nyla::abinary_op* eq_op = make<nyla::abinary_op>(AST_BINARY_OP, op_token);
 		nyla::abinary_op* op_op = make<nyla::abinary_op>(AST_BINARY_OP, op_token);
@@ -1244,7 +1251,7 @@ nyla::aexpr* nyla::parser::parse_factor() {
 			// TODO: produce error
 		}
 		type_cast->type = type_info.type;
-		if (type_cast->type == nyla::types::type_error) {
+		if (type_cast->type == m_types.type_error) {
 			return type_cast;
 		}
 		match(')');
@@ -1253,7 +1260,7 @@ nyla::aexpr* nyla::parser::parse_factor() {
 	}
 	case TK_VALUE_STRING8: {
 		nyla::astring* str = make<nyla::astring>(AST_STRING8, m_current);
-		str->lit8 = m_current.value_string8;
+		str->lit8 = m_lexer.get_tokens().get_string(m_current.value_string8);
 		str->dim_size = str->lit8.size();
 		next_token(); // Consuming the string
 		return str;
@@ -1299,7 +1306,7 @@ nyla::aexpr* nyla::parser::parse_factor() {
 		next_token(); // Consuming 'var' or 'new' token
 		nyla::token identifier_token = m_current;
 		u32 ident_key = parse_identifier();
-		if (ident_key == nyla::unidentified_ident) {
+		if (ident_key == m_reserved_words.unidentified_ident) {
 			skip_recovery();
 			return make<nyla::err_expr>(AST_ERROR, m_current);
 		}
@@ -1482,22 +1489,20 @@ void nyla::parser::parse_semis() {
 
 void nyla::parser::next_token() {
 	m_prev_token = m_current;
-	if (!m_saved_tokens.empty()) {
-		m_current = m_saved_tokens.front();
-		m_saved_tokens.pop();
-	} else {
-		m_current = m_lexer.next_token();
-	}
+	m_current    = get_token(++m_token_index);
 }
 
 nyla::token nyla::parser::peek_token(u32 n) {
 	if (n == 0) {
 		assert(!"There is no reason to peek zero tokens");
 	}
-	for (u32 i = m_saved_tokens.size(); i < n; i++) {
-		m_saved_tokens.push(m_lexer.next_token());
-	}
-	return m_saved_tokens.back();
+	return get_token(m_token_index + n);
+}
+
+nyla::token nyla::parser::get_token(u32 index) {
+	const nyla::token_stream& tokens = m_lexer.get_tokens();
+	while (index >= tokens.size() && m_lexer.lex_token());
+	return tokens.get(index);
 }
 
 u32 nyla::parser::parse_identifier() {
@@ -1507,7 +1512,7 @@ u32 nyla::parser::parse_identifier() {
 		return word_key;
 	}
 	m_log.err(ERR_EXPECTED_IDENTIFIER, m_current);
-	return nyla::unidentified_ident;
+	return m_reserved_words.unidentified_ident;
 }
 
 void nyla::parser::skip_recovery() {
@@ -7,7 +7,6 @@
 #include "sym_table.h"
 #include "type.h"
 
-#include <queue>
 
 namespace nyla {
 
@@ -27,6 +26,9 @@ namespace nyla {
 		// file_unit := module*
 		void parse_file_unit();
 
+		// Bytes allocated for the nodes of the AST
+		ulen get_ast_bytes() const { return m_ast_bytes; }
+
 	private:
 
 		// import := import (ident '.')* ident
@@ -122,17 +124,19 @@ namespace nyla {
 		 * Utilities
 		 */
 
-		// Retreives the next token from either
-		// the lexer or the m_saved_tokens and
-		// stores it in m_current.
+		// Moves to the next token of the lexer's
+		// token stream and stores it in m_current.
 		void next_token();
 
-		// Looks ahead n tokens and saves the tokens 
-		// skipped into m_saved_tokens.
+		// Looks ahead n tokens without consuming them.
 		// @param n The lookahead number to peek
 		// @return  The token to peek at
 		nyla::token peek_token(u32 n);
 
+		// Token at the index of the token stream. Lexes
+		// up to the token if it has not been lexed yet
+		nyla::token get_token(u32 index);
+
 		// returns the word_key of the
 		// word_table of the identifier
 		// token.
@@ -169,6 +173,7 @@ namespace nyla {
 		template<typename node>
 		node* make(ast_tag tag, u32 line_num, u32 spos, u32 epos) {
 			node* n = new node;
+			m_ast_bytes += sizeof(node);
 			n->tag      = tag;
 			n->line_num = line_num;
 			n->spos     = spos;
@@ -181,8 +186,12 @@ namespace nyla {
 		nyla::log&       m_log;
 		nyla::sym_table* m_sym_table;
 
-		   // Tokens saved during peeking
-		std::queue<nyla::token> m_saved_tokens;
+		nyla::compilation_context&  m_context;
+		const nyla::builtin_types&  m_types;
+		const nyla::reserved_words& m_reserved_words;
+
+		   // Index of m_current in the token stream
+		u32 m_token_index = 0;
 		   // Last token processed
 		nyla::token m_prev_token;
 		   // Currrent token being examined
@@ -219,6 +228,8 @@ namespace nyla {
 		// True when parsing fields of a module
 		bool m_field_mode = false;
 
+		ulen m_ast_bytes = 0;
+
 	};
 
 }
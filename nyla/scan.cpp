@@ -0,0 +1,448 @@
+#include "scan.h"
+
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NYLA_SCAN_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC lets AVX2 intrinsics be used anywhere while GCC and
+// Clang only allow them in functions marked for AVX2
+#if defined(_MSC_VER) && !defined(__clang__)
+#define NYLA_AVX2_TARGET
+#else
+#define NYLA_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+/*
+ * Scalar. Used when there are no vector instructions
+ * and as the reference the vector kernels are tested
+ * against
+ */
+
+static inline bool is_blank(c8 ch) {
+	return (ch >= 8 && ch <= 13) || ch == ' ';
+}
+
+static inline bool is_digit(c8 ch) {
+	return ch >= '0' && ch <= '9';
+}
+
+static inline bool is_identifier(c8 ch) {
+	return is_digit(ch) || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+}
+
+// A "\r\n" pair is a single new line
+static inline bool is_new_line(const c8* ptr) {
+	return *ptr == '\n' || (*ptr == '\r' && *(ptr + 1) != '\n');
+}
+
+static const c8* scalar_skip_blank(const c8* ptr, u32& num_lines) {
+	while (is_blank(*ptr)) {
+		if (is_new_line(ptr)) ++num_lines;
+		++ptr;
+	}
+	return ptr;
+}
+
+static const c8* scalar_find_line_end(const c8* ptr) {
+	while (*ptr != '\n' && *ptr != '\r' && *ptr != '\0') ++ptr;
+	return ptr;
+}
+
+static const c8* scalar_find_block_comment_end(const c8* ptr, u32& num_lines) {
+	while (!(*ptr == '*' && *(ptr + 1) == '/') && *ptr != '\0') {
+		if (is_new_line(ptr)) ++num_lines;
+		++ptr;
+	}
+	return ptr;
+}
+
+static const c8* scalar_find_identifier_end(const c8* ptr) {
+	while (is_identifier(*ptr)) ++ptr;
+	return ptr;
+}
+
+static const c8* scalar_find_digits_end(const c8* ptr) {
+	while (is_digit(*ptr)) ++ptr;
+	return ptr;
+}
+
+static const c8* scalar_find_string_special(const c8* ptr) {
+	while (*ptr != '"' && *ptr != '\\' && *ptr != '\n' && *ptr != '\r' && *ptr != '\0') ++ptr;
+	return ptr;
+}
+
+#ifdef NYLA_SCAN_X86
+
+static inline u32 count_bits(u32 bits) {
+	bits = bits - ((bits >> 1) & 0x55555555);
+	bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+	return (((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+// Index of the lowest set bit. The bits must not be 0
+static inline u32 lowest_bit(u32 bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return index;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+
+// Adds the new lines in line_mask before the stopping
+// character at index and returns the stopping character
+static inline const c8* stop_at(const c8* ptr, u32 index, u32 line_mask, u32& num_lines) {
+	num_lines += count_bits(line_mask & ((1u << index) - 1));
+	return ptr + index;
+}
+
+/*
+ * SSE2. Always available on x86-64
+ */
+
+// Marks the characters within [lo, hi]
+static inline __m128i sse2_in_range(__m128i chars, c8 lo, c8 hi) {
+	// Moving lo to -128 turns the unsigned range check
+	// into a single signed comparison
+	__m128i shifted = _mm_add_epi8(chars, _mm_set1_epi8((s8)(-128 - lo)));
+	return _mm_cmplt_epi8(shifted, _mm_set1_epi8((s8)(-128 + (hi - lo + 1))));
+}
+
+static inline __m128i sse2_is(__m128i chars, c8 ch) {
+	return _mm_cmpeq_epi8(chars, _mm_set1_epi8(ch));
+}
+
+static inline u32 sse2_mask(__m128i marked) {
+	return (u32)_mm_movemask_epi8(marked);
+}
+
+// New lines within the chars where next holds the
+// characters one position ahead
+static inline u32 sse2_line_mask(__m128i chars, __m128i next) {
+	__m128i lone_cr = _mm_andnot_si128(sse2_is(next, '\n'), sse2_is(chars, '\r'));
+	return sse2_mask(_mm_or_si128(sse2_is(chars, '\n'), lone_cr));
+}
+
+static const c8* sse2_skip_blank(const c8* ptr, u32& num_lines) {
+	while (true) {
+		__m128i chars = _mm_loadu_si128((const __m128i*)ptr);
+		__m128i next  = _mm_loadu_si128((const __m128i*)(ptr + 1));
+		__m128i blank = _mm_or_si128(sse2_in_range(chars, 8, 13), sse2_is(chars, ' '));
+		u32 line_mask = sse2_line_mask(chars, next);
+		u32 stop_mask = ~sse2_mask(blank) & 0xFFFF;
+		if (stop_mask) {
+			return stop_at(ptr, lowest_bit(stop_mask), line_mask, num_lines);
+		}
+		num_lines += count_bits(line_mask);
+		ptr += 16;
+	}
+}
+
+static const c8* sse2_find_line_end(const c8* ptr) {
+	while (true) {
+		__m128i chars = _mm_loadu_si128((const __m128i*)ptr);
+		__m128i stop  = _mm_or_si128(_mm_or_si128(sse2_is(chars, '\n'), sse2_is(chars, '\r')),
+			                         sse2_is(chars, '\0'));
+		u32 stop_mask = sse2_mask(stop);
+		if (stop_mask) {
+			return ptr + lowest_bit(stop_mask);
+		}
+		ptr += 16;
+	}
+}
+
+static const c8* sse2_find_block_comment_end(const c8* ptr, u32& num_lines) {
+	while (true) {
+		__m128i chars = _mm_loadu_si128((const __m128i*)ptr);
+		__m128i next  = _mm_loadu_si128((const __m128i*)(ptr + 1));
+		__m128i close = _mm_and_si128(sse2_is(chars, '*'), sse2_is(next, '/'));
+		u32 line_mask = sse2_line_mask(chars, next);
+		u32 stop_mask = sse2_mask(_mm_or_si128(close, sse2_is(chars, '\0')));
+		if (stop_mask) {
+			return stop_at(ptr, lowest_bit(stop_mask), line_mask, num_lines);
+		}
+		num_lines += count_bits(line_mask);
+		ptr += 16;
+	}
+}
+
+static const c8* sse2_find_identifier_end(const c8* ptr) {
+	while (true) {
+		__m128i chars = _mm_loadu_si128((const __m128i*)ptr);
+		// Setting 0x20 lowercases letters without making
+		// any other character a lowercase letter
+		__m128i letter     = sse2_in_range(_mm_or_si128(chars, _mm_set1_epi8(0x20)), 'a', 'z');
+		__m128i identifier = _mm_or_si128(_mm_or_si128(letter, sse2_in_range(chars, '0', '9')),
+			                              sse2_is(chars, '_'));
+		u32 stop_mask = ~sse2_mask(identifier) & 0xFFFF;
+		if (stop_mask) {
+			return ptr + lowest_bit(stop_mask);
+		}
+		ptr += 16;
+	}
+}
+
+static const c8* sse2_find_digits_end(const c8* ptr) {
+	while (true) {
+		__m128i chars = _mm_loadu_si128((const __m128i*)ptr);
+		u32 stop_mask = ~sse2_mask(sse2_in_range(chars, '0', '9')) & 0xFFFF;
+		if (stop_mask) {
+			return ptr + lowest_bit(stop_mask);
+		}
+		ptr += 16;
+	}
+}
+
+static const c8* sse2_find_string_special(const c8* ptr) {
+	while (true) {
+		__m128i chars = _mm_loadu_si128((const __m128i*)ptr);
+		__m128i quote = _mm_or_si128(sse2_is(chars, '"'), sse2_is(chars, '\\'));
+		__m128i end   = _mm_or_si128(_mm_or_si128(sse2_is(chars, '\n'), sse2_is(chars, '\r')),
+			                         sse2_is(chars, '\0'));
+		u32 stop_mask = sse2_mask(_mm_or_si128(quote, end));
+		if (stop_mask) {
+			return ptr + lowest_bit(stop_mask);
+		}
+		ptr += 16;
+	}
+}
+
+/*
+ * AVX2. The same kernels as SSE2 over 32 characters
+ */
+
+NYLA_AVX2_TARGET
+static inline __m256i avx2_in_range(__m256i chars, c8 lo, c8 hi) {
+	__m256i shifted = _mm256_add_epi8(chars, _mm256_set1_epi8((s8)(-128 - lo)));
+	return _mm256_cmpgt_epi8(_mm256_set1_epi8((s8)(-128 + (hi - lo + 1))), shifted);
+}
+
+NYLA_AVX2_TARGET
+static inline __m256i avx2_is(__m256i chars, c8 ch) {
+	return _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(ch));
+}
+
+NYLA_AVX2_TARGET
+static inline u32 avx2_mask(__m256i marked) {
+	return (u32)_mm256_movemask_epi8(marked);
+}
+
+NYLA_AVX2_TARGET
+static inline u32 avx2_line_mask(__m256i chars, __m256i next) {
+	__m256i lone_cr = _mm256_andnot_si256(avx2_is(next, '\n'), avx2_is(chars, '\r'));
+	return avx2_mask(_mm256_or_si256(avx2_is(chars, '\n'), lone_cr));
+}
+
+NYLA_AVX2_TARGET
+static const c8* avx2_skip_blank(const c8* ptr, u32& num_lines) {
+	while (true) {
+		__m256i chars = _mm256_loadu_si256((const __m256i*)ptr);
+		__m256i next  = _mm256_loadu_si256((const __m256i*)(ptr + 1));
+		__m256i blank = _mm256_or_si256(avx2_in_range(chars, 8, 13), avx2_is(chars, ' '));
+		u32 line_mask = avx2_line_mask(chars, next);
+		u32 stop_mask = ~avx2_mask(blank);
+		if (stop_mask) {
+			return stop_at(ptr, lowest_bit(stop_mask), line_mask, num_lines);
+		}
+		num_lines += count_bits(line_mask);
+		ptr += 32;
+	}
+}
+
+NYLA_AVX2_TARGET
+static const c8* avx2_find_line_end(const c8* ptr) {
+	while (true) {
+		__m256i chars = _mm256_loadu_si256((const __m256i*)ptr);
+		__m256i stop  = _mm256_or_si256(_mm256_or_si256(avx2_is(chars, '\n'), avx2_is(chars, '\r')),
+			                            avx2_is(chars, '\0'));
+		u32 stop_mask = avx2_mask(stop);
+		if (stop_mask) {
+			return ptr + lowest_bit(stop_mask);
+		}
+		ptr += 32;
+	}
+}
+
+NYLA_AVX2_TARGET
+static const c8* avx2_find_block_comment_end(const c8* ptr, u32& num_lines) {
+	while (true) {
+		__m256i chars = _mm256_loadu_si256((const __m256i*)ptr);
+		__m256i next  = _mm256_loadu_si256((const __m256i*)(ptr + 1));
+		__m256i close = _mm256_and_si256(avx2_is(chars, '*'), avx2_is(next, '/'));
+		u32 line_mask = avx2_line_mask(chars, next);
+		u32 stop_mask = avx2_mask(_mm256_or_si256(close, avx2_is(chars, '\0')));
+		if (stop_mask) {
+			return stop_at(ptr, lowest_bit(stop_mask), line_mask, num_lines);
+		}
+		num_lines += count_bits(line_mask);
+		ptr += 32;
+	}
+}
+
+NYLA_AVX2_TARGET
+static const c8* avx2_find_identifier_end(const c8* ptr) {
+	while (true) {
+		__m256i chars      = _mm256_loadu_si256((const __m256i*)ptr);
+		__m256i letter     = avx2_in_range(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), 'a', 'z');
+		__m256i identifier = _mm256_or_si256(_mm256_or_si256(letter, avx2_in_range(chars, '0', '9')),
+			                                 avx2_is(chars, '_'));
+		u32 stop_mask = ~avx2_mask(identifier);
+		if (stop_mask) {
+			return ptr + lowest_bit(stop_mask);
+		}
+		ptr += 32;
+	}
+}
+
+NYLA_AVX2_TARGET
+static const c8* avx2_find_digits_end(const c8* ptr) {
+	while (true) {
+		__m256i chars = _mm256_loadu_si256((const __m256i*)ptr);
+		u32 stop_mask = ~avx2_mask(avx2_in_range(chars, '0', '9'));
+		if (stop_mask) {
+			return ptr + lowest_bit(stop_mask);
+		}
+		ptr += 32;
+	}
+}
+
+NYLA_AVX2_TARGET
+static const c8* avx2_find_string_special(const c8* ptr) {
+	while (true) {
+		__m256i chars = _mm256_loadu_si256((const __m256i*)ptr);
+		__m256i quote = _mm256_or_si256(avx2_is(chars, '"'), avx2_is(chars, '\\'));
+		__m256i end   = _mm256_or_si256(_mm256_or_si256(avx2_is(chars, '\n'), avx2_is(chars, '\r')),
+			                            avx2_is(chars, '\0'));
+		u32 stop_mask = avx2_mask(_mm256_or_si256(quote, end));
+		if (stop_mask) {
+			return ptr + lowest_bit(stop_mask);
+		}
+		ptr += 32;
+	}
+}
+
+static bool cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	s32 info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	// The OS must save the AVX registers
+	bool has_osxsave = (info[2] & (1 << 27)) != 0;
+	if (!has_osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+/*
+ * Selecting the kernels
+ */
+
+using nyla::scan_kernels;
+
+static const scan_kernels scalar_kernels = {
+	scalar_skip_blank,
+	scalar_find_line_end,
+	scalar_find_block_comment_end,
+	scalar_find_identifier_end,
+	scalar_find_digits_end,
+	scalar_find_string_special,
+	"Scalar"
+};
+
+#ifdef NYLA_SCAN_X86
+static const scan_kernels sse2_kernels = {
+	sse2_skip_blank,
+	sse2_find_line_end,
+	sse2_find_block_comment_end,
+	sse2_find_identifier_end,
+	sse2_find_digits_end,
+	sse2_find_string_special,
+	"SSE2"
+};
+
+static const scan_kernels avx2_kernels = {
+	avx2_skip_blank,
+	avx2_find_line_end,
+	avx2_find_block_comment_end,
+	avx2_find_identifier_end,
+	avx2_find_digits_end,
+	avx2_find_string_special,
+	"AVX2"
+};
+#endif
+
+static const scan_kernels& select_kernels() {
+#ifdef NYLA_SCAN_X86
+	if (cpu_has_avx2()) {
+		return avx2_kernels;
+	}
+	return sse2_kernels;
+#else
+	return scalar_kernels;
+#endif
+}
+
+// Picked once for the process and never changed so
+// every compiler may scan at the same time
+static const scan_kernels& get_kernels() {
+	static const scan_kernels& kernels = select_kernels();
+	return kernels;
+}
+
+const c8* nyla::skip_blank(const c8* ptr, u32& num_lines) {
+	return get_kernels().skip_blank(ptr, num_lines);
+}
+
+const c8* nyla::find_line_end(const c8* ptr) {
+	return get_kernels().find_line_end(ptr);
+}
+
+const c8* nyla::find_block_comment_end(const c8* ptr, u32& num_lines) {
+	return get_kernels().find_block_comment_end(ptr, num_lines);
+}
+
+const c8* nyla::find_identifier_end(const c8* ptr) {
+	return get_kernels().find_identifier_end(ptr);
+}
+
+const c8* nyla::find_digits_end(const c8* ptr) {
+	return get_kernels().find_digits_end(ptr);
+}
+
+const c8* nyla::find_string_special(const c8* ptr) {
+	return get_kernels().find_string_special(ptr);
+}
+
+c_string nyla::get_scan_instructions() {
+	return get_kernels().instructions;
+}
+
+const scan_kernels* nyla::find_scan_kernels(c_string instructions) {
+	std::string name = instructions;
+	if (name == "Scalar") {
+		return &scalar_kernels;
+	}
+#ifdef NYLA_SCAN_X86
+	if (name == "SSE2") {
+		return &sse2_kernels;
+	}
+	if (name == "AVX2" && cpu_has_avx2()) {
+		return &avx2_kernels;
+	}
+#endif
+	return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef NYLA_SCAN_H
+#define NYLA_SCAN_H
+
+#include "types_ext.h"
+
+namespace nyla {
+
+	/*
+	 * Kernels which look through the source 16 or 32
+	 * characters at a time for the end of a run of
+	 * characters. They read past the character they stop
+	 * on so the source must be followed by source_padding
+	 * zeroed bytes. Every kernel stops on a '\0'.
+	 *
+	 * The widest instructions the processor supports are
+	 * picked the first time a kernel is called.
+	 */
+
+	// First character which is not whitespace or a new line.
+	// Adds the number of new lines skipped to num_lines
+	const c8* skip_blank(const c8* ptr, u32& num_lines);
+
+	// First '\n', '\r' or '\0'
+	const c8* find_line_end(const c8* ptr);
+
+	// First "*/" or '\0'. Adds the number of new lines
+	// before it to num_lines
+	const c8* find_block_comment_end(const c8* ptr, u32& num_lines);
+
+	// First character which is not a letter, digit or underscore
+	const c8* find_identifier_end(const c8* ptr);
+
+	// First character which is not a digit
+	const c8* find_digits_end(const c8* ptr);
+
+	// First '"', '\\', '\n', '\r' or '\0'
+	const c8* find_string_special(const c8* ptr);
+
+	// Name of the instructions the kernels use. Either
+	// "AVX2", "SSE2" or "Scalar"
+	c_string get_scan_instructions();
+
+	// The kernels written with one set of instructions
+	struct scan_kernels {
+		const c8* (*skip_blank)(const c8* ptr, u32& num_lines);
+		const c8* (*find_line_end)(const c8* ptr);
+		const c8* (*find_block_comment_end)(const c8* ptr, u32& num_lines);
+		const c8* (*find_identifier_end)(const c8* ptr);
+		const c8* (*find_digits_end)(const c8* ptr);
+		const c8* (*find_string_special)(const c8* ptr);
+		c_string  instructions;
+	};
+
+	// The kernels which use the given instructions so each
+	// set can be checked. nullptr if the processor does not
+	// support them. The kernels used when scanning stay the
+	// same
+	const scan_kernels* find_scan_kernels(c_string instructions);
+
+}
+
+#endif
\ No newline at end of file
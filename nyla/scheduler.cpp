@@ -0,0 +1,123 @@
+#include "scheduler.h"
+
+#include <thread>
+#include <assert.h>
+
+nyla::scheduler::scheduler(u32 num_workers)
+	: m_num_workers(num_workers == 0 ? 1 : num_workers) {
+}
+
+u32 nyla::scheduler::add_task(const std::function<void()>& func) {
+	task new_task;
+	new_task.func = func;
+	m_tasks.push_back(new_task);
+	return m_tasks.size() - 1;
+}
+
+void nyla::scheduler::add_dependency(u32 task, u32 depends_on) {
+	assert(task != depends_on && "A task cannot depend on itself");
+	m_tasks[depends_on].dependents.push_back(task);
+	++m_tasks[task].num_dependencies;
+}
+
+void nyla::scheduler::run() {
+	if (m_tasks.empty()) return;
+
+	m_unfinished_dependencies.reset(new std::atomic<u32>[m_tasks.size()]);
+	m_queues.clear();
+	for (u32 i = 0; i < m_num_workers; i++) {
+		m_queues.emplace_back(new worker_queue);
+	}
+
+	m_num_remaining = m_tasks.size();
+	m_num_queued    = 0;
+
+	// Spreading the tasks which are ready from the
+	// start evenly accross the workers
+	u32 next_worker = 0;
+	for (u32 i = 0; i < m_tasks.size(); i++) {
+		m_unfinished_dependencies[i] = m_tasks[i].num_dependencies;
+		if (m_tasks[i].num_dependencies == 0) {
+			m_queues[next_worker]->tasks.push_back(i);
+			++m_num_queued;
+			next_worker = (next_worker + 1) % m_num_workers;
+		}
+	}
+
+	std::vector<std::thread> threads;
+	for (u32 i = 1; i < m_num_workers; i++) {
+		threads.emplace_back(&scheduler::worker_loop, this, i);
+	}
+	worker_loop(0);
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	m_tasks.clear();
+}
+
+void nyla::scheduler::worker_loop(u32 worker_index) {
+	while (m_num_remaining != 0) {
+		u32 task_index;
+		if (pop_or_steal(worker_index, task_index)) {
+			m_tasks[task_index].func();
+			finish_task(worker_index, task_index);
+		} else {
+			std::unique_lock<std::mutex> lock(m_sleep_mutex);
+			m_sleep_cv.wait(lock, [this]() {
+				return m_num_queued != 0 || m_num_remaining == 0;
+			});
+		}
+	}
+}
+
+void nyla::scheduler::push_ready(u32 worker_index, u32 task_index) {
+	{
+		worker_queue& queue = *m_queues[worker_index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(task_index);
+		++m_num_queued;
+	}
+	{
+		// Locking so a worker cannot miss the wake up
+		// between checking for tasks and going to sleep
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+	}
+	m_sleep_cv.notify_one();
+}
+
+bool nyla::scheduler::pop_or_steal(u32 worker_index, u32& task_index) {
+	{
+		worker_queue& queue = *m_queues[worker_index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task_index = queue.tasks.back();
+			queue.tasks.pop_back();
+			--m_num_queued;
+			return true;
+		}
+	}
+	for (u32 i = 1; i < m_num_workers; i++) {
+		worker_queue& victim = *m_queues[(worker_index + i) % m_num_workers];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task_index = victim.tasks.front();
+			victim.tasks.pop_front();
+			--m_num_queued;
+			return true;
+		}
+	}
+	return false;
+}
+
+void nyla::scheduler::finish_task(u32 worker_index, u32 task_index) {
+	for (u32 dependent : m_tasks[task_index].dependents) {
+		if (--m_unfinished_dependencies[dependent] == 0) {
+			push_ready(worker_index, dependent);
+		}
+	}
+	if (--m_num_remaining == 0) {
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		m_sleep_cv.notify_all();
+	}
+}
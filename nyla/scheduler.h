@@ -0,0 +1,83 @@
+#ifndef NYLA_SCHEDULER_H
+#define NYLA_SCHEDULER_H
+
+#include "types_ext.h"
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+
+namespace nyla {
+
+	/*
+	 * Runs a graph of tasks on a pool of worker threads.
+	 *
+	 * A task becomes ready once every task it depends on
+	 * has finished. Each worker keeps its own queue of ready
+	 * tasks and steals from the other workers when its queue
+	 * runs dry. Nothing recurses so the depth of the graph is
+	 * not limited by the call stack.
+	 */
+	class scheduler {
+	public:
+
+		explicit scheduler(u32 num_workers);
+
+		// Adds a new task to the graph and returns its id
+		u32 add_task(const std::function<void()>& func);
+
+		// The task will not start until depends_on has finished.
+		// The dependencies must not form a cycle.
+		void add_dependency(u32 task, u32 depends_on);
+
+		// Runs every task and returns once they have all
+		// finished. The calling thread is one of the workers
+		void run();
+
+	private:
+
+		struct task {
+			std::function<void()> func;
+			std::vector<u32>      dependents;
+			u32                   num_dependencies = 0;
+		};
+
+		struct worker_queue {
+			std::mutex      mutex;
+			std::deque<u32> tasks;
+		};
+
+		void worker_loop(u32 worker_index);
+
+		// Pushes a ready task onto the worker's queue
+		void push_ready(u32 worker_index, u32 task_index);
+
+		// Takes the newest task from the worker's own queue or
+		// the oldest task from another worker's queue
+		bool pop_or_steal(u32 worker_index, u32& task_index);
+
+		void finish_task(u32 worker_index, u32 task_index);
+
+		u32 m_num_workers;
+
+		std::vector<task>                          m_tasks;
+		std::unique_ptr<std::atomic<u32>[]>        m_unfinished_dependencies;
+		std::vector<std::unique_ptr<worker_queue>> m_queues;
+
+		std::atomic<u32> m_num_remaining{ 0 };
+		std::atomic<u32> m_num_queued{ 0 };
+
+		// Idle workers sleep until a task is queued or
+		// every task has finished
+		std::mutex              m_sleep_mutex;
+		std::condition_variable m_sleep_cv;
+
+	};
+
+}
+
+#endif
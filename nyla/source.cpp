@@ -1,34 +1,13 @@
 #include "source.h"
 
-c8 nyla::source::cur_char() {
-	if (m_ptr >= m_length) return '\0';
-	return m_buffer[m_ptr];
-}
-
-c8 nyla::source::next_char() {
-	++m_ptr;
-	return cur_char();
-}
-
-c8 nyla::source::peek_char() {
-	++m_ptr;
-	c8 ch = cur_char();
-	--m_ptr;
-	return ch;
-}
-
-c8 nyla::source::operator[](u32 i) const {
-	return m_buffer[i];
-}
-
-std::string nyla::source::from_range(const range& range) {
+std::string nyla::source::from_range(const range& range) const {
 	std::string str;
 	str.resize(range.length());
 	memcpy(&str[0], &m_buffer[range.start], range.length());
 	return str;
 }
 
-std::string nyla::source::from_window_till_nl(u32 start_pos, s32 direction) {
+std::string nyla::source::from_window_till_nl(u32 start_pos, s32 direction) const {
 	s32 index = start_pos;
 	std::string s;
 	s32 move = 0;
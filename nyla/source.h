@@ -19,42 +19,40 @@ namespace nyla {
 		inline u32 length() const { return end - start; }
 	};
 
+	// Number of zeroed bytes which must follow the buffer
+	// of a source so reading past the end is safe
+	constexpr ulen source_padding = 64;
+
 	/*
-	 * Allows traversing over a buffer by
-	 * keeeping an internal pointer.
+	 * Buffer of a source file. The buffer is followed by
+	 * source_padding zeroed bytes so reading ahead of any
+	 * character never needs to check the length. The end
+	 * of the source is found by reading a '\0'.
 	 */
 	class source {
 	public:
+		// The buffer must be followed by source_padding zeroed bytes
 		explicit source(c_string buffer, ulen length)
 			: m_buffer(buffer), m_length(length)
 		{ }
 
-		// Current character at the buffer's position.
-		c8 cur_char();
-
-		// Moves the buffer's position forward by one and returns
-		// the character
-		c8 next_char();
-
-		// Views the next character without moving the buffer's position
-		// forward
-		c8 peek_char();
+		// First character of the buffer
+		const c8* begin() const { return m_buffer; }
 
-		// The current position in the buffer
-		u32 position() const { return m_ptr; }
+		// One past the last character of the buffer
+		const c8* end() const { return m_buffer + m_length; }
 
 		// Character at index i
-		c8 operator[](u32 i) const;
+		c8 operator[](u32 i) const { return m_buffer[i]; }
 
 		// Gets the string from within the range
-		std::string from_range(const range& range);
+		std::string from_range(const range& range) const;
 
-		std::string from_window_till_nl(u32 start_pos, s32 direction);
+		std::string from_window_till_nl(u32 start_pos, s32 direction) const;
 
 	private:
-		u32      m_length;
 		c_string m_buffer;
-		u32      m_ptr = 0;
+		u32      m_length;
 	};
 
 }
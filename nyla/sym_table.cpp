@@ -1,8 +1,32 @@
 #include "sym_table.h"
 
+#include <algorithm>
+
+const c8* nyla::get_file_state_name(file_state state) {
+	switch (state) {
+	case FS_PARSED:          return "Parse";
+	case FS_IMPORT_RESOLVED: return "Resolve imports";
+	case FS_ANALYZED:        return "Analyze";
+	case FS_TYPE_DECL_GEN:   return "Type declarations";
+	case FS_BODY_DECL_GEN:   return "Body declarations";
+	case FS_LLVM_IR_GEN:     return "LLVM IR";
+	default:                 return "Unknown";
+	}
+}
+
 nyla::sym_module* nyla::sym_table::enter_module(u32 name_key) {
-	m_modules[name_key] = new sym_module;
-	return m_modules[name_key];
+	sym_module* sym_module = new nyla::sym_module;
+	m_symbol_bytes += sizeof(nyla::sym_module);
+	auto it = m_modules.find(name_key);
+	if (it != m_modules.end()) {
+		// Redeclared modules take the place of the first declaration
+		std::replace(m_ordered_modules.begin(), m_ordered_modules.end(), it->second, sym_module);
+		it->second = sym_module;
+	} else {
+		m_modules[name_key] = sym_module;
+		m_ordered_modules.push_back(sym_module);
+	}
+	return sym_module;
 }
 
 nyla::sym_module* nyla::sym_table::find_module(u32 name_key) {
@@ -44,12 +68,14 @@ s32 nyla::sym_table::function_search(const std::vector<sym_function*>& functions
 nyla::sym_function* nyla::sym_table::enter_function(sym_module* sym_module, u32 name_key) {
 	std::vector<sym_function*>& functions = sym_module->functions[name_key];
 	functions.push_back(new sym_function);
+	m_symbol_bytes += sizeof(sym_function);
 	return functions.back();
 }
 
 nyla::sym_function* nyla::sym_table::enter_constructor(sym_module* sym_module, u32 name_key) {
 	std::vector<sym_function*>& constructors = sym_module->constructors[name_key];
 	constructors.push_back(new sym_function);
+	m_symbol_bytes += sizeof(sym_function);
 	return constructors.back();
 }
 
@@ -68,6 +94,7 @@ bool nyla::sym_table::has_variable_been_declared(u32 name_key, bool check_module
 nyla::sym_variable* nyla::sym_table::enter_variable(u32 name_key) {
 	assert(m_scope && "Cannot enter a variable into an empty scope!");
 	m_scope->variables[name_key] = new sym_variable;
+	m_symbol_bytes += sizeof(sym_variable);
 	return m_scope->variables[name_key];
 }
 
@@ -84,15 +111,12 @@ nyla::sym_variable* nyla::sym_table::find_variable(sym_scope* scope, u32 name_ke
 }
 
 std::vector<nyla::sym_module*> nyla::sym_table::get_modules() {
-	std::vector<nyla::sym_module*> modules;
-	for (auto& pair : m_modules) {
-		modules.push_back(pair.second);
-	}
-	return modules;
+	return m_ordered_modules;
 }
 
 nyla::sym_scope* nyla::sym_table::push_scope() {
 	nyla::sym_scope* scope = new nyla::sym_scope;
+	m_symbol_bytes += sizeof(sym_scope);
 	if (m_scope) {
 		scope->parent = m_scope;
 	}
@@ -2,6 +2,7 @@
 #define NYLA_SYM_TABLE_H
 
 #include <unordered_map>
+#include <atomic>
 
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Instructions.h>
@@ -16,12 +17,17 @@ namespace nyla {
 	struct sym_function;
 	struct sym_variable;
 	struct sym_scope;
+	struct source;
+	struct log;
+	struct lexer;
+	struct afile_unit;
 	struct parser;
 	struct analysis;
 	struct llvm_generator;
 	struct avariable_decl;
 	struct aannotation;
 	struct aimport;
+	class interface_file;
 
 	struct sym_module {
 		u32         name_key;
@@ -31,9 +37,10 @@ namespace nyla {
 		std::unordered_map<u32, std::vector<sym_function*>> functions;
 		std::unordered_map<u32, std::vector<sym_function*>> constructors;
 		std::vector<nyla::avariable_decl*>                  fields;
+		// Functions called by the initializers of the
+		// fields and global variables
+		std::vector<sym_function*>                          init_called_functions;
 
-
-		llvm::StructType* ll_struct_type = nullptr;
 		// TODO change name to "unique_module_key"
 		u32 unique_module_id;
 
@@ -54,12 +61,20 @@ namespace nyla {
 		nyla::type*              return_type;
 		u32                      name_key;
 		std::vector<nyla::type*> param_types;
-		llvm::Function*          ll_function = nullptr;
+		// Name of the llvm function. Set once the file declaring
+		// the function has generated its declaration. Other files
+		// declare the function in their own module by this name
+		std::string              ll_name;
 		sym_module*              sym_module  = nullptr;
 		u32                      line_num; // Line number in source code where it was declared
 		aannotation*             annotation = nullptr;
 		bool                     call_at_startup = false; // True if the function has @StartUp annotation
 		bool                     is_memcpy = false;
+		// Functions called within the body. Found by the analysis
+		std::vector<sym_function*> called_functions;
+		// Cleared if the program never calls the function
+		// so no body is generated for it
+		bool                     reachable = true;
 
 		bool is_member_function() {
 			return !(mods & MOD_STATIC) &&
@@ -85,40 +100,91 @@ namespace nyla {
 		std::vector<nyla::aexpr*> arr_dim_sizes;
 		std::vector<u32>          computed_arr_dim_sizes;
 
-		llvm::Value* ll_alloc;
+		// Name of the llvm global for global variables. Set once
+		// the file declaring the variable has generated its body
+		// declarations
+		std::string ll_name;
+	};
+
+	// The states a file goes through while being
+	// compiled in the order they happen
+	enum file_state {
+		FS_PARSED = 1,
+		FS_IMPORT_RESOLVED,
+		FS_ANALYZED,
+		FS_TYPE_DECL_GEN,
+		FS_BODY_DECL_GEN,
+		FS_LLVM_IR_GEN,
 	};
 
-	using import_iterator = std::unordered_map<std::string, aimport*>::iterator;
+	// Name of the state shown in traces
+	const c8* get_file_state_name(file_state state);
+
 	class sym_table {
 	public:
 
-		// Because the order in which dependency states are
-		// processed is very non-linear iterators are used to
-		// keep track how far into processing how many of
-		// the dependencies have been processed for a state
-		import_iterator m_parse_imports_iterator;
-		import_iterator m_resolve_imports_iterator;
-		import_iterator m_analyze_imports_iterator;
-		import_iterator m_gen_type_decl_iterator;
-		import_iterator m_gen_body_decl_iterator;
-		import_iterator m_imports_end;
-
-		// Flags indicating the state while processing
-		// a file
-		bool m_started_processing                = false;
-		bool m_started_parsing                   = false;
-		bool m_started_import_resolution         = false;
-		bool m_started_analysis                  = false;
-		bool m_started_ir_module_declaration_gen = false;
-		bool m_started_ir_func_declaration_gen   = false;
-		
-		bool m_found_compilation_errors  = false;
+		// Symbol tables of the files imported by this file
+		std::vector<sym_table*> m_dependencies;
+
+		// Files whose imports form a cycle share the same
+		// component. Files in the same component cannot wait
+		// on each other to finish a state so they only wait
+		// for the previous state instead
+		u32 m_import_component = 0;
+
+		// How far the file gets processed
+		file_state m_final_state = FS_PARSED;
+
+		std::atomic<bool> m_found_compilation_errors{ false };
 
 		// If set to false the main function will be ignored
 		bool m_search_for_main_function;
+
+		// Set if the main file depends on the file so its
+		// code is part of the program
+		bool m_linked = false;
+
+		// Set when the symbol table was kept from a previous
+		// compile so the file does not need to be processed
+		bool m_reused = false;
+
+		// Set when nothing the main file depends on imports the
+		// file so only the imports of the file are parsed
+		bool m_skipped = false;
+
+		// Set when the symbols of the file are loaded from its
+		// interface rather than by parsing and analyzing it
+		bool m_from_interface = false;
+
+		// Hash of the contents of the file. The symbol table
+		// is reused by later compiles while the hash is the same
+		u64 m_source_hash = 0;
+
+		// Set when the object code of the file was found in the
+		// object cache so no code has to be generated for it
+		bool m_obj_cache_hit = false;
+		// Key of the object code in the object cache
+		u64  m_obj_cache_key = 0;
+
+		// Bytes allocated for the modules, functions,
+		// variables and scopes entered into the table
+		ulen m_symbol_bytes = 0;
+
+		// Some global variables must be initialized by function
+		// so the expressions are stored for computation at a later
+		// time.
+		std::vector<nyla::avariable_decl*> m_global_initializer_exprs;
+
+		// Functions that need to be called at startup
+		std::vector<sym_function*> m_startup_functions;
 		
 	public:
 
+		// Reused files and files loaded from their interface already
+		// have everything their importers need. Skipped files have
+		// no importers
+		bool needs_processing() const { return !m_reused && !m_from_interface && !m_skipped; }
+
 		// Creates a new module entry in the symbol table
 		sym_module* enter_module(u32 name_key);
 
@@ -154,7 +220,8 @@ namespace nyla {
 		// Finds a variable within the scope or parent scopes by it's name key
 		sym_variable* find_variable(sym_scope* scope, u32 name_key);
 
-		// Gets all the modules declared in the file
+		// Gets all the modules declared in the file in the
+		// order they were declared
 		std::vector<sym_module*> get_modules();
 
 		// Get a functions in the module based on it's name.
@@ -169,6 +236,24 @@ namespace nyla {
 		void set_file_location(file_location file_location) { m_file_location = file_location; }
 		file_location get_file_location() { return m_file_location; }
 
+		void set_source_buffer(c8* buffer) { m_source_buffer = buffer; }
+		c8* get_source_buffer() { return m_source_buffer; }
+
+		void set_source_buffer_length(ulen length) { m_source_buffer_length = length; }
+		ulen get_source_buffer_length() { return m_source_buffer_length; }
+
+		void set_source(nyla::source* source) { m_source = source; }
+		nyla::source* get_source() { return m_source; }
+
+		void set_log(nyla::log* log) { m_log = log; }
+		nyla::log* get_log() { return m_log; }
+
+		void set_lexer(nyla::lexer* lexer) { m_lexer = lexer; }
+		nyla::lexer* get_lexer() { return m_lexer; }
+
+		void set_file_unit(nyla::afile_unit* file_unit) { m_file_unit = file_unit; }
+		nyla::afile_unit* get_file_unit() { return m_file_unit; }
+
 		void set_parser(nyla::parser* parser) { m_parser = parser; }
 		nyla::parser* get_parser() { return m_parser; };
 
@@ -178,10 +263,22 @@ namespace nyla {
 		void set_llvm_generator(nyla::llvm_generator* llvm_generator) { m_llvm_generator = llvm_generator; }
 		nyla::llvm_generator* get_llvm_generator() { return m_llvm_generator; }
 
+		void set_interface(nyla::interface_file* interface_file) { m_interface = interface_file; }
+		nyla::interface_file* get_interface() { return m_interface; }
+
+		void set_llvm_context(llvm::LLVMContext* llvm_context) { m_llvm_context = llvm_context; }
+		llvm::LLVMContext* get_llvm_context() { return m_llvm_context; }
+
+		void set_llvm_module(llvm::Module* llvm_module) { m_llvm_module = llvm_module; }
+		llvm::Module* get_llvm_module() { return m_llvm_module; }
+
 	private:
 		// Maps between a module's name_key and the symbol
 		// for the module
 		std::unordered_map<u32, sym_module*> m_modules;
+		// Word keys depend on the order files are parsed in so
+		// the modules are also kept in declaration order
+		std::vector<sym_module*>             m_ordered_modules;
 
 		s32 function_search(const std::vector<sym_function*>& functions, u32 name_key,
 			                std::vector<nyla::type*> param_types);
@@ -191,10 +288,26 @@ namespace nyla {
 
 		file_location m_file_location;
 
-		nyla::parser*         m_parser;
-		nyla::analysis*       m_analysis;
-		nyla::llvm_generator* m_llvm_generator;
-
+		// Everything needed to process the file. Allocated
+		// when the file is loaded and freed once the file
+		// has been processed
+		c8*                   m_source_buffer  = nullptr;
+		ulen                  m_source_buffer_length = 0;
+		nyla::source*         m_source         = nullptr;
+		nyla::log*            m_log            = nullptr;
+		nyla::lexer*          m_lexer          = nullptr;
+		nyla::afile_unit*     m_file_unit      = nullptr;
+		nyla::parser*         m_parser         = nullptr;
+		nyla::analysis*       m_analysis       = nullptr;
+		nyla::llvm_generator* m_llvm_generator = nullptr;
+		nyla::interface_file* m_interface      = nullptr;
+
+		// The llvm IR of the file. Kept around after the file
+		// is processed since objects are written at the end.
+		// Every file has a context of its own so files generate
+		// their IR on different threads at the same time
+		llvm::LLVMContext* m_llvm_context = nullptr;
+		llvm::Module*      m_llvm_module  = nullptr;
 
 	};
 }
@@ -0,0 +1,69 @@
+#include "token_stream.h"
+
+#include <assert.h>
+#include <cstring>
+
+static_assert(nyla::TK_EOF <= 0xFFFF, "token tags must fit in the tag array");
+
+// Tokens whose union holds a value
+static bool has_payload(u32 tag) {
+	return tag == nyla::TK_IDENTIFIER ||
+		   (tag >= nyla::TK_VALUE_INT && tag <= nyla::TK_VALUE_CHAR8);
+}
+
+void nyla::token_stream::add(const nyla::token& token) {
+	m_tags.push_back((u16)token.tag);
+	m_line_nums.push_back(token.line_num);
+	m_start_positions.push_back(token.spos);
+	m_end_positions.push_back(token.epos);
+	if (has_payload(token.tag)) {
+		u64 payload;
+		static_assert(sizeof(payload) == sizeof(token.value_ulong), "payload must hold the token's value");
+		memcpy(&payload, &token.value_ulong, sizeof(payload));
+		m_payload_indexes.push_back((u32)m_payloads.size());
+		m_payloads.push_back(payload);
+	} else {
+		m_payload_indexes.push_back(0);
+	}
+}
+
+nyla::string_ref nyla::token_stream::add_string(const c8* chars, ulen length) {
+	nyla::string_ref ref;
+	ref.offset = (u32)m_strings.size();
+	ref.length = (u32)length;
+	m_strings.append(chars, length);
+	return ref;
+}
+
+nyla::token nyla::token_stream::get(u32 index) const {
+	assert(!m_tags.empty());
+	if (index >= m_tags.size()) {
+		index = (u32)m_tags.size() - 1;
+	}
+
+	nyla::token token;
+	token.tag         = m_tags[index];
+	token.line_num    = m_line_nums[index];
+	token.spos        = m_start_positions[index];
+	token.epos        = m_end_positions[index];
+	token.value_ulong = 0;
+	if (has_payload(token.tag)) {
+		memcpy(&token.value_ulong, &m_payloads[m_payload_indexes[index]], sizeof(u64));
+	}
+	return token;
+}
+
+std::string nyla::token_stream::get_string(const nyla::string_ref& ref) const {
+	assert(ref.offset + ref.length <= m_strings.size());
+	return m_strings.substr(ref.offset, ref.length);
+}
+
+ulen nyla::token_stream::get_memory_usage() const {
+	return m_tags.capacity()            * sizeof(u16) +
+		   m_line_nums.capacity()       * sizeof(u32) +
+		   m_start_positions.capacity() * sizeof(u32) +
+		   m_end_positions.capacity()   * sizeof(u32) +
+		   m_payload_indexes.capacity() * sizeof(u32) +
+		   m_payloads.capacity()        * sizeof(u64) +
+		   m_strings.capacity();
+}
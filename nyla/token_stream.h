@@ -0,0 +1,58 @@
+#ifndef NYLA_TOKEN_STREAM_H
+#define NYLA_TOKEN_STREAM_H
+
+#include "tokens.h"
+#include <vector>
+
+namespace nyla {
+
+	/*
+	 * Every token of a file stored as parallel arrays so
+	 * the parser reaches any token by its index. Tokens
+	 * with a value keep an index into the payloads and
+	 * the characters of string literals are kept together
+	 * in one buffer.
+	 *
+	 * The last token of a finished stream is TK_EOF.
+	 */
+	class token_stream {
+	public:
+
+		// Appends the token to the end of the stream
+		void add(const nyla::token& token);
+
+		// Copies the characters of a string literal into
+		// the stream's string buffer
+		nyla::string_ref add_string(const c8* chars, ulen length);
+
+		// Token at the index. Indexes past the end give the
+		// last token
+		nyla::token get(u32 index) const;
+
+		u32 get_tag(u32 index) const { return m_tags[index]; }
+
+		// Characters of a string literal of the stream
+		std::string get_string(const nyla::string_ref& ref) const;
+
+		u32 size() const { return (u32)m_tags.size(); }
+
+		// The TK_EOF token was added
+		bool is_finished() const { return !m_tags.empty() && m_tags.back() == TK_EOF; }
+
+		// Bytes reserved for the tokens and their payloads
+		ulen get_memory_usage() const;
+
+	private:
+		std::vector<u16> m_tags;
+		std::vector<u32> m_line_nums;
+		std::vector<u32> m_start_positions;
+		std::vector<u32> m_end_positions;
+		// Index into m_payloads for tokens with a value
+		std::vector<u32> m_payload_indexes;
+		std::vector<u64> m_payloads;
+		std::string      m_strings;
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -1,74 +1,134 @@
 #include "tokens.h"
 
 #include "words.h"
+#include "compilation_context.h"
 
-std::unordered_map<u32, nyla::token_tag> nyla::reserved_words;
-std::unordered_map<u32, u32> nyla::reserved_tag_to_words;
-u32 nyla::unidentified_ident;
-u32 nyla::main_ident;
-u32 nyla::length_ident;
-u32 nyla::startup_ident;
-u32 nyla::memcpy_ident;
-
-void nyla::setup_tokens() {
-	reserved_words = {
-		// Types
-		{ nyla::word::make("byte")     , nyla::TK_TYPE_BYTE   },
-		{ nyla::word::make("short")    , nyla::TK_TYPE_SHORT  },
-		{ nyla::word::make("int")      , nyla::TK_TYPE_INT    },
-		{ nyla::word::make("long")     , nyla::TK_TYPE_LONG   },
-		{ nyla::word::make("ubyte")    , nyla::TK_TYPE_UBYTE  },
-		{ nyla::word::make("ushort")   , nyla::TK_TYPE_USHORT },
-		{ nyla::word::make("uint")     , nyla::TK_TYPE_UINT   },
-		{ nyla::word::make("ulong")    , nyla::TK_TYPE_ULONG  },
-		{ nyla::word::make("float")    , nyla::TK_TYPE_FLOAT  },
-		{ nyla::word::make("double")   , nyla::TK_TYPE_DOUBLE },
-		{ nyla::word::make("bool")     , nyla::TK_TYPE_BOOL   },
-		{ nyla::word::make("void")     , nyla::TK_TYPE_VOID   },
-		{ nyla::word::make("char")     , nyla::TK_TYPE_CHAR8  },
-		{ nyla::word::make("char16")   , nyla::TK_TYPE_CHAR16 },
-		{ nyla::word::make("char32")   , nyla::TK_TYPE_CHAR32 },
-		// True/False
-		{ nyla::word::make("true")     , nyla::TK_TRUE        },
-		{ nyla::word::make("false")    , nyla::TK_FALSE       },
-		// Control Flow
-		{ nyla::word::make("for")      , nyla::TK_FOR         },
-		{ nyla::word::make("while")    , nyla::TK_WHILE       },
-		{ nyla::word::make("do")       , nyla::TK_DO          },
-		{ nyla::word::make("if")       , nyla::TK_IF          },
-		{ nyla::word::make("else")     , nyla::TK_ELSE        },
-		{ nyla::word::make("switch")   , nyla::TK_SWITCH      },
-		{ nyla::word::make("return")   , nyla::TK_RETURN      },
-		{ nyla::word::make("continue") , nyla::TK_CONTINUE    },
-		{ nyla::word::make("break")    , nyla::TK_BREAK       },
-		// Other
-		{ nyla::word::make("module")   , nyla::TK_MODULE      },
-		{ nyla::word::make("static")   , nyla::TK_STATIC      },
-		{ nyla::word::make("private")  , nyla::TK_PRIVATE     },
-		{ nyla::word::make("protected"), nyla::TK_PROTECTED   },
-		{ nyla::word::make("external") , nyla::TK_EXTERNAL    },
-		{ nyla::word::make("const")    , nyla::TK_CONST       },
-		{ nyla::word::make("comptime") , nyla::TK_COMPTIME    },
-		{ nyla::word::make("cast")     , nyla::TK_CAST        },
-		{ nyla::word::make("null")     , nyla::TK_NULL        },
-		{ nyla::word::make("new")      , nyla::TK_NEW         },
-		{ nyla::word::make("var")      , nyla::TK_VAR         },
-		{ nyla::word::make("import")   , nyla::TK_IMPORT      },
-		{ nyla::word::make("this")     , nyla::TK_THIS        },
-	};
-
-	unidentified_ident  = nyla::word::make("__unidentified_ident");
-	main_ident          = nyla::word::make("main");
-	length_ident        = nyla::word::make("length");
-	nyla::startup_ident = nyla::word::make("StartUp");
-	nyla::memcpy_ident  = nyla::word::make("memcpy");
-
-	for (auto it = reserved_words.begin(); it != reserved_words.end(); it++) {
-		reserved_tag_to_words[it->second] = it->first;
+/*
+ * Keywords are found with a perfect hash of their first
+ * character, second to last character and length. The
+ * table is built at compile time and checked so that no
+ * two keywords share a slot.
+ */
+
+struct keyword {
+	c_string        spelling;
+	ulen            length;
+	nyla::token_tag tag;
+};
+
+#define KEYWORD(spelling, tag) { spelling, sizeof(spelling) - 1, tag }
+
+constexpr keyword keywords[] = {
+	// Types
+	KEYWORD("byte"     , nyla::TK_TYPE_BYTE  ),
+	KEYWORD("short"    , nyla::TK_TYPE_SHORT ),
+	KEYWORD("int"      , nyla::TK_TYPE_INT   ),
+	KEYWORD("long"     , nyla::TK_TYPE_LONG  ),
+	KEYWORD("ubyte"    , nyla::TK_TYPE_UBYTE ),
+	KEYWORD("ushort"   , nyla::TK_TYPE_USHORT),
+	KEYWORD("uint"     , nyla::TK_TYPE_UINT  ),
+	KEYWORD("ulong"    , nyla::TK_TYPE_ULONG ),
+	KEYWORD("float"    , nyla::TK_TYPE_FLOAT ),
+	KEYWORD("double"   , nyla::TK_TYPE_DOUBLE),
+	KEYWORD("bool"     , nyla::TK_TYPE_BOOL  ),
+	KEYWORD("void"     , nyla::TK_TYPE_VOID  ),
+	KEYWORD("char"     , nyla::TK_TYPE_CHAR8 ),
+	KEYWORD("char16"   , nyla::TK_TYPE_CHAR16),
+	KEYWORD("char32"   , nyla::TK_TYPE_CHAR32),
+	// True/False
+	KEYWORD("true"     , nyla::TK_TRUE       ),
+	KEYWORD("false"    , nyla::TK_FALSE      ),
+	// Control Flow
+	KEYWORD("for"      , nyla::TK_FOR        ),
+	KEYWORD("while"    , nyla::TK_WHILE      ),
+	KEYWORD("do"       , nyla::TK_DO         ),
+	KEYWORD("if"       , nyla::TK_IF         ),
+	KEYWORD("else"     , nyla::TK_ELSE       ),
+	KEYWORD("switch"   , nyla::TK_SWITCH     ),
+	KEYWORD("return"   , nyla::TK_RETURN     ),
+	KEYWORD("continue" , nyla::TK_CONTINUE   ),
+	KEYWORD("break"    , nyla::TK_BREAK      ),
+	// Other
+	KEYWORD("module"   , nyla::TK_MODULE     ),
+	KEYWORD("static"   , nyla::TK_STATIC     ),
+	KEYWORD("private"  , nyla::TK_PRIVATE    ),
+	KEYWORD("protected", nyla::TK_PROTECTED  ),
+	KEYWORD("external" , nyla::TK_EXTERNAL   ),
+	KEYWORD("const"    , nyla::TK_CONST      ),
+	KEYWORD("comptime" , nyla::TK_COMPTIME   ),
+	KEYWORD("cast"     , nyla::TK_CAST       ),
+	KEYWORD("null"     , nyla::TK_NULL       ),
+	KEYWORD("new"      , nyla::TK_NEW        ),
+	KEYWORD("var"      , nyla::TK_VAR        ),
+	KEYWORD("import"   , nyla::TK_IMPORT     ),
+	KEYWORD("this"     , nyla::TK_THIS       ),
+};
+
+#undef KEYWORD
+
+constexpr u32 num_keywords      = sizeof(keywords) / sizeof(keywords[0]);
+constexpr u32 num_keyword_slots = 128;
+
+// Every keyword has at least 2 characters
+constexpr u32 hash_keyword(c8 first, c8 second_last, ulen length) {
+	return ((u8)first * 3 + (u8)second_last + (u32)length * 10) & (num_keyword_slots - 1);
+}
+
+struct keyword_slots {
+	// One more than the index into keywords or
+	// 0 if no keyword hashes to the slot
+	u8   indexes[num_keyword_slots];
+	bool has_collision;
+};
+
+constexpr keyword_slots make_keyword_slots() {
+	keyword_slots slots = {};
+	for (u32 i = 0; i < num_keywords; i++) {
+		const keyword& kw = keywords[i];
+		u32 slot = hash_keyword(kw.spelling[0], kw.spelling[kw.length - 2], kw.length);
+		if (slots.indexes[slot] != 0) {
+			slots.has_collision = true;
+		}
+		slots.indexes[slot] = (u8)(i + 1);
 	}
+	return slots;
 }
 
-std::string nyla::token_tag_to_string(u32 tag) {
+constexpr keyword_slots keyword_slots_table = make_keyword_slots();
+static_assert(!keyword_slots_table.has_collision,
+	          "Keywords must hash to different slots. Change the constants of hash_keyword");
+
+u32 nyla::get_keyword_tag(const c8* chars, ulen length) {
+	if (length < 2) {
+		return TK_IDENTIFIER;
+	}
+	u8 index = keyword_slots_table.indexes[hash_keyword(chars[0], chars[length - 2], length)];
+	if (index == 0) {
+		return TK_IDENTIFIER;
+	}
+	const keyword& kw = keywords[index - 1];
+	if (kw.length != length || memcmp(kw.spelling, chars, length) != 0) {
+		return TK_IDENTIFIER;
+	}
+	return kw.tag;
+}
+
+c_string nyla::get_keyword_spelling(u32 tag) {
+	for (const keyword& kw : keywords) {
+		if (kw.tag == tag) return kw.spelling;
+	}
+	return nullptr;
+}
+
+void nyla::setup_tokens(nyla::word_table& word_table, nyla::reserved_words& reserved_words) {
+	reserved_words.unidentified_ident = word_table.get_key("__unidentified_ident");
+	reserved_words.main_ident         = word_table.get_key("main");
+	reserved_words.length_ident       = word_table.get_key("length");
+	reserved_words.startup_ident      = word_table.get_key("StartUp");
+	reserved_words.memcpy_ident       = word_table.get_key("memcpy");
+}
+
+std::string nyla::token_tag_to_string(u32 tag, nyla::compilation_context& context) {
 	switch (tag) {
 	case TK_PLUS_EQ:      return "+=";
 	case TK_MINUS_EQ:     return "-=";
@@ -100,20 +160,20 @@ std::string nyla::token_tag_to_string(u32 tag) {
 	default:
 		if (tag < TK_UNKNOWN)
 			return std::string(1, tag);
-		if (tag >= __TK_START_OF_KEYWORDS && tag <= __TK_END_OF_KEYWORDS) {
-			return std::string(g_word_table->get_word(reserved_tag_to_words[tag]).c_str());
+		if (c_string spelling = get_keyword_spelling(tag)) {
+			return spelling;
 		}
 	}
 	return "";
 }
 
-std::string nyla::token::to_string() const {
+std::string nyla::token::to_string(nyla::compilation_context& context) const {
 	switch (tag) {
 	case TK_UNKNOWN:      return "unknown";
 	case TK_EOF:          return "eof";
 	case TK_IDENTIFIER: {
 		// TODO: special cases for escapes
-		return g_word_table->get_word(word_key).c_str();
+		return context.get_word_table().get_word(word_key).c_str();
 	}
 	case TK_VALUE_INT:    return std::to_string(value_int);
 	case TK_VALUE_UINT:   return std::to_string(value_uint);
@@ -125,27 +185,17 @@ std::string nyla::token::to_string() const {
 		// TODO: special cases for escapes
 		return "(char)" + value_char8;
 	}
-	case TK_VALUE_STRING8: {
-		std::string out_string;
-		for (u32 i = 0; i < value_string8.size(); i++) {
-			c8 ch = value_string8[i];
-			if (ch == '\\') {
-				ch = value_string8[i];
-				out_string += "\\" + ch;
-			} else {
-				out_string += ch;
-			}
-		}
-		return std::string("\"") + out_string + "\"";
-	}
+	case TK_VALUE_STRING8:
+		// The characters are kept by the token stream
+		return token_tag_to_string(tag, context);
 	default: {
 		if (tag < TK_UNKNOWN)
 			return std::string(1, tag);
-		if (tag >= __TK_START_OF_KEYWORDS && tag <= __TK_END_OF_KEYWORDS) {
-			return std::string(g_word_table->get_word(word_key).c_str());
+		if (c_string spelling = get_keyword_spelling(tag)) {
+			return spelling;
 		}
 		if (tag >= __TK_START_OF_SYMBOLS && tag <= __TK_END_OF_SYMBOLS) {
-			return token_tag_to_string(tag);
+			return token_tag_to_string(tag, context);
 		}
 		return std::string(1, tag);
 	}
@@ -3,7 +3,6 @@
 
 #include "types_ext.h"
 #include <string>
-#include <unordered_map>
 
 namespace nyla {
 
@@ -120,35 +119,57 @@ namespace nyla {
 
 	};
 
-	// Maps between word's keys and the token_tag of
-	// a reserved word.
-	extern std::unordered_map<u32, nyla::token_tag> reserved_words;
+	class word_table;
+	class compilation_context;
 
-	// Maps reseved token_tag numbers to the key indexes.
-	extern std::unordered_map<u32, u32> reserved_tag_to_words;
+	/*
+	 * Keys of the words the compiler looks for within
+	 * a word table. Keywords are not entered into the
+	 * word table.
+	 */
+	struct reserved_words {
+		// Reserved word "__unidentified_ident" in cases
+		// where an identifier cannot be found during parsing.
+		u32 unidentified_ident;
 
-	// Reserved word "__unidentified_ident" in cases
-	// where an identifier cannot be found during parsing.
-	extern u32 unidentified_ident;
+		// The word "main" for identifying main functions for entry
+		// points into the program.
+		u32 main_ident;
 
-	// The word "main" for identifying main functions for entry
-	// points into the program.
-	extern u32 main_ident;
+		// The word "length" for identifying array lengths.
+		u32 length_ident;
 
-	// The word "length" for identifying array lengths.
-	extern u32 length_ident;
+		// The word "StatUp" for identifying @StartUp annotations
+		u32 startup_ident;
 
-	// The word "StatUp" for identifying @StartUp annotations
-	extern u32 startup_ident;
+		// The word "memcpy" for external memcpy function
+		u32 memcpy_ident;
+	};
+
+	// token_tag of the keyword spelled by the characters or
+	// TK_IDENTIFIER if they do not spell a keyword
+	u32 get_keyword_tag(const c8* chars, ulen length);
 
-	// The word "memcpy" for external memcpy function
-	extern u32 memcpy_ident;
+	// Spelling of the keyword with the token_tag or nullptr
+	// if the tag is not a keyword
+	c_string get_keyword_spelling(u32 tag);
 
-	// Initialize the reserved_words set
-	void setup_tokens();
+	// Enters the reserved words into the word table
+	void setup_tokens(nyla::word_table& word_table, nyla::reserved_words& reserved_words);
 
-	std::string token_tag_to_string(u32 tag);
+	std::string token_tag_to_string(u32 tag, nyla::compilation_context& context);
 
+	// Characters of a string literal within
+	// a token_stream's string buffer
+	struct string_ref {
+		u32 offset;
+		u32 length;
+	};
+
+	/*
+	 * Trivially copyable so tokens are cheap to pass around
+	 * and may be stored in a token_stream.
+	 */
 	struct token {
 		u32 tag;
 		u32 line_num;   // The line the token first appeard on
@@ -157,7 +178,7 @@ namespace nyla {
 		                // If the range is 0-1 then it encompesses only character
 		                // at index 0.
 		
-		std::string to_string() const;
+		std::string to_string(nyla::compilation_context& context) const;
 
 		union {
 			s32    value_int;
@@ -168,9 +189,8 @@ namespace nyla {
 			float  value_float;
 			double value_double;
 			u32    word_key;    // Key into the word table.
+			nyla::string_ref value_string8;
 		};
-		std::string  value_string8;
-		
 	};
 
 }
@@ -0,0 +1,112 @@
+#include "trace.h"
+#include "utils.h"
+
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+
+// Small ids for the threads since the ids given by
+// the standard library are not readable in a trace
+static std::atomic<u32> next_thread_id{ 1 };
+
+static u32 get_thread_id() {
+	static thread_local u32 thread_id = next_thread_id++;
+	return thread_id;
+}
+
+static void write_json_string(std::ofstream& out, const std::string& str) {
+	out << '"';
+	for (c8 ch : str) {
+		switch (ch) {
+		case '"':  out << "\\\""; break;
+		case '\\': out << "\\\\"; break;
+		case '\n': out << "\\n";  break;
+		case '\r': out << "\\r";  break;
+		case '\t': out << "\\t";  break;
+		default:
+			if ((u8)ch < 0x20) {
+				c8 escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", (u8)ch);
+				out << escaped;
+			} else {
+				out << ch;
+			}
+			break;
+		}
+	}
+	out << '"';
+}
+
+// Trace times are in microseconds
+static void write_microseconds(std::ofstream& out, u64 time_in_nanoseconds) {
+	c8 buffer[32];
+	snprintf(buffer, sizeof(buffer), "%llu.%03llu",
+		     (unsigned long long)(time_in_nanoseconds / 1000),
+		     (unsigned long long)(time_in_nanoseconds % 1000));
+	out << buffer;
+}
+
+nyla::tracer::tracer()
+	: m_start_time(nyla::get_time_in_nanoseconds()) {
+}
+
+void nyla::tracer::add_span(const c8* category, const std::string& name, const std::string& detail,
+	                        u64 start_time_in_nanoseconds, u64 end_time_in_nanoseconds) {
+	span new_span;
+	new_span.category   = category;
+	new_span.name       = name;
+	new_span.detail     = detail;
+	new_span.start_time = start_time_in_nanoseconds - m_start_time;
+	new_span.duration   = end_time_in_nanoseconds - start_time_in_nanoseconds;
+	new_span.thread_id  = get_thread_id();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_spans.push_back(std::move(new_span));
+}
+
+bool nyla::tracer::write(const std::string& path) {
+	std::ofstream out(path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!out.good()) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	out << "{\"traceEvents\":[\n";
+	for (ulen i = 0; i < m_spans.size(); i++) {
+		const span& span = m_spans[i];
+		out << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread_id;
+		out << ",\"cat\":";
+		write_json_string(out, span.category);
+		out << ",\"name\":";
+		write_json_string(out, span.name);
+		out << ",\"ts\":";
+		write_microseconds(out, span.start_time);
+		out << ",\"dur\":";
+		write_microseconds(out, span.duration);
+		if (!span.detail.empty()) {
+			out << ",\"args\":{\"detail\":";
+			write_json_string(out, span.detail);
+			out << '}';
+		}
+		out << '}';
+		if (i + 1 != m_spans.size()) out << ',';
+		out << '\n';
+	}
+	out << "],\"displayTimeUnit\":\"ns\"}\n";
+	return out.good();
+}
+
+nyla::trace_span::trace_span(nyla::tracer* tracer, const c8* category, std::string name, std::string detail)
+	: m_tracer(tracer), m_category(category) {
+	if (m_tracer) {
+		m_name       = std::move(name);
+		m_detail     = std::move(detail);
+		m_start_time = nyla::get_time_in_nanoseconds();
+	}
+}
+
+nyla::trace_span::~trace_span() {
+	if (m_tracer) {
+		m_tracer->add_span(m_category, m_name, m_detail, m_start_time, nyla::get_time_in_nanoseconds());
+	}
+}
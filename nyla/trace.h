@@ -0,0 +1,69 @@
+#ifndef NYLA_TRACE_H
+#define NYLA_TRACE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "types_ext.h"
+
+namespace nyla {
+
+	/*
+	 * Records spans of time spent in the compiler from any
+	 * thread and writes them in the Chrome trace event format
+	 * so they can be viewed by chrome://tracing or Perfetto.
+	 */
+	class tracer {
+	public:
+
+		tracer();
+
+		// Records a span between the two times given by
+		// get_time_in_nanoseconds. The detail is shown as
+		// an argument of the span when it is not empty
+		void add_span(const c8* category, const std::string& name, const std::string& detail,
+			          u64 start_time_in_nanoseconds, u64 end_time_in_nanoseconds);
+
+		// Writes every span recorded so far. Returns false
+		// if the file could not be written
+		bool write(const std::string& path);
+
+	private:
+
+		struct span {
+			const c8*   category;
+			std::string name;
+			std::string detail;
+			u64         start_time;
+			u64         duration;
+			u32         thread_id;
+		};
+
+		std::mutex        m_mutex;
+		std::vector<span> m_spans;
+		u64               m_start_time;
+	};
+
+	/*
+	 * Records a span from construction until destruction.
+	 * Does nothing when the tracer is nullptr.
+	 */
+	class trace_span {
+	public:
+
+		trace_span(nyla::tracer* tracer, const c8* category, std::string name, std::string detail = "");
+
+		~trace_span();
+
+	private:
+		nyla::tracer* m_tracer;
+		const c8*     m_category;
+		std::string   m_name;
+		std::string   m_detail;
+		u64           m_start_time = 0;
+	};
+
+}
+
+#endif
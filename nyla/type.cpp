@@ -4,32 +4,47 @@
 #include "sym_table.h"
 #include "words.h"
 
-// Integers
-nyla::type* nyla::types::type_byte   = new nyla::type(nyla::TYPE_BYTE);
-nyla::type* nyla::types::type_short  = new nyla::type(nyla::TYPE_SHORT);
-nyla::type* nyla::types::type_int    = new nyla::type(nyla::TYPE_INT);
-nyla::type* nyla::types::type_long   = new nyla::type(nyla::TYPE_LONG);
-nyla::type* nyla::types::type_ubyte  = new nyla::type(nyla::TYPE_UBYTE);
-nyla::type* nyla::types::type_ushort = new nyla::type(nyla::TYPE_USHORT);
-nyla::type* nyla::types::type_uint   = new nyla::type(nyla::TYPE_UINT);
-nyla::type* nyla::types::type_ulong  = new nyla::type(nyla::TYPE_ULONG);
-// Characters
-nyla::type* nyla::types::type_char8  = new nyla::type(nyla::TYPE_CHAR8);
-nyla::type* nyla::types::type_char16 = new nyla::type(nyla::TYPE_CHAR16);
-nyla::type* nyla::types::type_char32 = new nyla::type(nyla::TYPE_CHAR32);
-// Floats
-nyla::type* nyla::types::type_float  = new nyla::type(nyla::TYPE_FLOAT);
-nyla::type* nyla::types::type_double = new nyla::type(nyla::TYPE_DOUBLE);
-// Other
-nyla::type* nyla::types::type_bool   = new nyla::type(nyla::TYPE_BOOL);
-nyla::type* nyla::types::type_void   = new nyla::type(nyla::TYPE_VOID);
-nyla::type* nyla::types::type_error  = new nyla::type(nyla::TYPE_ERROR);
-nyla::type* nyla::types::type_string = new nyla::type(nyla::TYPE_STRING);
-nyla::type* nyla::types::type_null   = new nyla::type(nyla::TYPE_NULL);
-nyla::type* nyla::types::type_mixed  = new nyla::type(nyla::TYPE_MIXED);
+nyla::builtin_types::builtin_types() {
+	// Integers
+	type_byte   = new nyla::type(nyla::TYPE_BYTE);
+	type_short  = new nyla::type(nyla::TYPE_SHORT);
+	type_int    = new nyla::type(nyla::TYPE_INT);
+	type_long   = new nyla::type(nyla::TYPE_LONG);
+	type_ubyte  = new nyla::type(nyla::TYPE_UBYTE);
+	type_ushort = new nyla::type(nyla::TYPE_USHORT);
+	type_uint   = new nyla::type(nyla::TYPE_UINT);
+	type_ulong  = new nyla::type(nyla::TYPE_ULONG);
+	// Characters
+	type_char8  = new nyla::type(nyla::TYPE_CHAR8);
+	type_char16 = new nyla::type(nyla::TYPE_CHAR16);
+	type_char32 = new nyla::type(nyla::TYPE_CHAR32);
+	// Floats
+	type_float  = new nyla::type(nyla::TYPE_FLOAT);
+	type_double = new nyla::type(nyla::TYPE_DOUBLE);
+	// Other
+	type_bool   = new nyla::type(nyla::TYPE_BOOL);
+	type_void   = new nyla::type(nyla::TYPE_VOID);
+	type_error  = new nyla::type(nyla::TYPE_ERROR);
+	type_string = new nyla::type(nyla::TYPE_STRING);
+	type_null   = new nyla::type(nyla::TYPE_NULL);
+	type_mixed  = new nyla::type(nyla::TYPE_MIXED);
+}
 
+nyla::builtin_types::~builtin_types() {
+	nyla::type* types[] = {
+		type_byte, type_short, type_int, type_long,
+		type_ubyte, type_ushort, type_uint, type_ulong,
+		type_char8, type_char16, type_char32,
+		type_float, type_double,
+		type_bool, type_void, type_error, type_string, type_null, type_mixed
+	};
+	for (nyla::type* type : types) {
+		delete type;
+	}
+}
 
 nyla::type* nyla::type_table::find_type(nyla::type* type) {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	auto it = table.find(*type);
 	if (it != table.end()) {
 		delete type;
@@ -40,10 +55,19 @@ nyla::type* nyla::type_table::find_type(nyla::type* type) {
 }
 
 void nyla::type_table::clear_table() {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	table.clear();
 }
 
-nyla::type_table* nyla::g_type_table = new nyla::type_table;
+void nyla::type_table::get_memory_usage(ulen& num_entries, ulen& num_bytes) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	num_entries = table.size();
+	// A copy of the type is the key of the node pointing
+	// to the type along with the bucket array of the map
+	num_bytes = table.size() * (2 * sizeof(nyla::type) + 2 * sizeof(void*)) +
+		        table.bucket_count() * sizeof(void*);
+}
+
 
 
 
@@ -67,7 +91,7 @@ bool nyla::type::equals(const nyla::type* o) const {
 	}
 }
 
-std::string nyla::type::to_string() const {
+std::string nyla::type::to_string(nyla::word_table& word_table) const {
 	switch (tag) {
 	case TYPE_BYTE:      return "byte";
 	case TYPE_SHORT:     return "short";
@@ -88,10 +112,10 @@ std::string nyla::type::to_string() const {
 	case TYPE_STRING:    return "String";
 	case TYPE_MIXED:     return "<T>";
 	case TYPE_NULL:      return "null";
-	case TYPE_FD_MODULE: return nyla::g_word_table->get_word(fd_module_name_key).c_str();
-	case TYPE_MODULE:    return nyla::g_word_table->get_word(sym_module->name_key).c_str();
-	case TYPE_PTR:       return element_type->to_string() + "*";
-	case TYPE_ARR:       return element_type->to_string() + "[]";
+	case TYPE_FD_MODULE: return word_table.get_word(fd_module_name_key).c_str();
+	case TYPE_MODULE:    return word_table.get_word(sym_module->name_key).c_str();
+	case TYPE_PTR:       return element_type->to_string(word_table) + "*";
+	case TYPE_ARR:       return element_type->to_string(word_table) + "[]";
 	}
 	assert(!"Unimplemented to_string");
 	return "";
@@ -117,66 +141,66 @@ void nyla::type::calculate_arr_depth() {
 	}
 }
 
-nyla::type* nyla::type::get_int(u32 mem_size, bool is_signed) {
+nyla::type* nyla::builtin_types::get_int(u32 mem_size, bool is_signed) const {
 	switch (mem_size) {
-	case 1: return is_signed ? types::type_byte : types::type_ubyte;
-	case 2: return is_signed ? types::type_short : types::type_ushort;
-	case 4: return is_signed ? types::type_int : types::type_uint;
-	case 8: return is_signed ? types::type_long : types::type_ulong;
+	case 1: return is_signed ? type_byte : type_ubyte;
+	case 2: return is_signed ? type_short : type_ushort;
+	case 4: return is_signed ? type_int : type_uint;
+	case 8: return is_signed ? type_long : type_ulong;
 	default:
 		assert(!"Bad memory size");
 		return nullptr;
 	}
 }
 
-nyla::type* nyla::type::get_float(u32 mem_size) {
+nyla::type* nyla::builtin_types::get_float(u32 mem_size) const {
 	switch (mem_size) {
-	case 4: return types::type_float;
-	case 8: return types::type_double;
+	case 4: return type_float;
+	case 8: return type_double;
 	default:
 		assert(!"Bad memory size");
 		return nullptr;
 	}
 }
 
-nyla::type* nyla::type::get_char(u32 mem_size) {
+nyla::type* nyla::builtin_types::get_char(u32 mem_size) const {
 	switch (mem_size) {
-	case 1: return types::type_char8;
-	case 2: return types::type_char16;
-	case 4: return types::type_char32;
+	case 1: return type_char8;
+	case 2: return type_char16;
+	case 4: return type_char32;
 	default:
 		assert(!"Bad memory size");
 		return nullptr;
 	}
 }
 
-nyla::type* nyla::type::get_ptr(nyla::type* element_type) {
+nyla::type* nyla::type_table::get_ptr(nyla::type* element_type) {
 	// TODO: optimize by only creating the type IF it does not exist in the table
 	nyla::type* ptr_t = new nyla::type(TYPE_PTR, element_type);
 	ptr_t->calculate_ptr_depth();
-    return nyla::g_type_table->find_type(ptr_t);
+    return find_type(ptr_t);
 }
 
-nyla::type* nyla::type::get_arr(nyla::type* element_type) {
+nyla::type* nyla::type_table::get_arr(nyla::type* element_type) {
 	// TODO: optimize by only creating the type IF it does not exist in the table
 	nyla::type* arr_t = new nyla::type(TYPE_ARR, element_type);
 	arr_t->calculate_arr_depth();
-	return nyla::g_type_table->find_type(arr_t);
+	return find_type(arr_t);
 }
 
-nyla::type* nyla::type::get_or_enter_module(nyla::sym_module* sym_module) {
+nyla::type* nyla::type_table::get_or_enter_module(nyla::sym_module* sym_module) {
 	assert(sym_module);
 	// TODO: optimize by only creating the type IF it does not exist in the table
 	nyla::type* type_m = new nyla::type(TYPE_MODULE);
 	type_m->unique_module_key = sym_module->unique_module_id;
 	type_m->sym_module = sym_module;
-	return nyla::g_type_table->find_type(type_m);
+	return find_type(type_m);
 }
 
-nyla::type* nyla::type::get_fd_module(nyla::type_table* local_type_table, u32 module_name_key) {
+nyla::type* nyla::type_table::get_fd_module(u32 module_name_key) {
 	nyla::type* type_m = new nyla::type(TYPE_FD_MODULE);
 	type_m->fd_module_name_key = module_name_key;
-	return local_type_table->find_type(type_m);
+	return find_type(type_m);
 }
 
 void nyla::type::resolve_fd_type(nyla::sym_module* sym_module) {
@@ -5,6 +5,7 @@
 
 #include <assert.h>
 #include <unordered_map>
+#include <mutex>
 
 namespace nyla {
 
@@ -61,36 +62,10 @@ namespace nyla {
 
 	struct aexpr;
 	struct sym_module;
-	struct type_table;
+	class type_table;
+	class word_table;
 	struct type;
 
-	namespace types {
-		// Integers
-		extern nyla::type* type_byte;
-		extern nyla::type* type_short;
-		extern nyla::type* type_int;
-		extern nyla::type* type_long;
-		extern nyla::type* type_ubyte;
-		extern nyla::type* type_ushort;
-		extern nyla::type* type_uint;
-		extern nyla::type* type_ulong;
-		// Characters
-		extern nyla::type* type_char8;
-		extern nyla::type* type_char16;
-		extern nyla::type* type_char32;
-		// Floats
-		extern nyla::type* type_float;
-		extern nyla::type* type_double;
-		// Other
-		extern nyla::type* type_bool;
-		extern nyla::type* type_void;
-		extern nyla::type* type_error;
-		extern nyla::type* type_string;
-		extern nyla::type* type_null;
-		extern nyla::type* type_mixed;
-
-	}
-
 	struct type {
 		type_tag tag;
 		nyla::type*  element_type       = nullptr;
@@ -161,7 +136,7 @@ namespace nyla {
 		// where-as the '==' only works on some
 		bool equals(const nyla::type* o) const;
 
-		std::string to_string() const;
+		std::string to_string(nyla::word_table& word_table) const;
 
 		// Recursively calculates the number of pointer '*'
 		// subscripts for the pointer and if the element_type is
@@ -173,32 +148,6 @@ namespace nyla {
 		// an array then it's array depth.
 		void calculate_arr_depth();
 
-		// Retreive an integer type based on its size in bytes
-		// and if it is signed
-		static nyla::type* get_int(u32 mem_size, bool is_signed);
-
-		// Retreive a float type based on its size in bytes
-		static nyla::type* get_float(u32 mem_size);
-
-		// Retreive a char type based on its size in bytes
-		static nyla::type* get_char(u32 mem_size);
-
-		// Get a pointer to that to the type of element_type.
-		// element_type may be another pointer causes pointers
-		// to pointers
-		static nyla::type* get_ptr(nyla::type* element_type);
-
-		// Get an array with element's of type element_type
-		static nyla::type* get_arr(nyla::type* element_type);
-
-		// Get/Enter a new module type based on the module's unique key accross
-		// the entire program
-		static nyla::type* get_or_enter_module(nyla::sym_module* sym_module);
-
-		// Get a forward declared type based on the module's name key
-		// and it's internal path
-		static nyla::type* get_fd_module(nyla::type_table* local_type_table, u32 module_name_key);
-
 		// Converts a forward declared type into a module type
 		void resolve_fd_type(nyla::sym_module* sym_module);
 
@@ -243,18 +192,87 @@ namespace nyla {
 		std::vector<nyla::aexpr*> dim_sizes;
 	};
 
+	/*
+	 * The types which are not built out of other types.
+	 * Created once for each compilation context so types
+	 * may be compared by their pointers.
+	 */
+	struct builtin_types {
+		// Integers
+		nyla::type* type_byte;
+		nyla::type* type_short;
+		nyla::type* type_int;
+		nyla::type* type_long;
+		nyla::type* type_ubyte;
+		nyla::type* type_ushort;
+		nyla::type* type_uint;
+		nyla::type* type_ulong;
+		// Characters
+		nyla::type* type_char8;
+		nyla::type* type_char16;
+		nyla::type* type_char32;
+		// Floats
+		nyla::type* type_float;
+		nyla::type* type_double;
+		// Other
+		nyla::type* type_bool;
+		nyla::type* type_void;
+		nyla::type* type_error;
+		nyla::type* type_string;
+		nyla::type* type_null;
+		nyla::type* type_mixed;
+
+		builtin_types();
+
+		~builtin_types();
+
+		builtin_types(const builtin_types&) = delete;
+		builtin_types& operator=(const builtin_types&) = delete;
+
+		// Retreive an integer type based on its size in bytes
+		// and if it is signed
+		nyla::type* get_int(u32 mem_size, bool is_signed) const;
+
+		// Retreive a float type based on its size in bytes
+		nyla::type* get_float(u32 mem_size) const;
+
+		// Retreive a char type based on its size in bytes
+		nyla::type* get_char(u32 mem_size) const;
+	};
+
+	// Safe to use from multiple threads
 	class type_table {
 	public:
 
 		nyla::type* find_type(nyla::type* type);
 
+		// Get a pointer to that to the type of element_type.
+		// element_type may be another pointer causes pointers
+		// to pointers
+		nyla::type* get_ptr(nyla::type* element_type);
+
+		// Get an array with element's of type element_type
+		nyla::type* get_arr(nyla::type* element_type);
+
+		// Get/Enter a new module type based on the module's unique key accross
+		// the entire program
+		nyla::type* get_or_enter_module(nyla::sym_module* sym_module);
+
+		// Get a forward declared type based on the module's name key.
+		// Kept in the table of the file which is parsing it
+		nyla::type* get_fd_module(u32 module_name_key);
+
 		void clear_table();
 
+		// Number of types in the table and an estimate
+		// of the bytes used to store them
+		void get_memory_usage(ulen& num_entries, ulen& num_bytes);
+
 	private:
 		std::unordered_map<nyla::type, nyla::type*,
 			               nyla::type::hash_gen> table;
+		std::mutex m_mutex;
 	};
-	extern type_table* g_type_table;
 }
 
 #endif
\ No newline at end of file
@@ -2,14 +2,32 @@
 
 #ifdef _WIN32
 #include <Windows.h>
+#include <Psapi.h>
+#include <intrin.h>
+#else
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #endif
 
 #include <locale>
 #include <codecvt>
 
 #include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
 
 #include <chrono>
+#include <thread>
+#include <functional>
 
 u64 nyla::get_time_in_milliseconds() {
 	using std::chrono::duration_cast;
@@ -20,6 +38,60 @@ u64 nyla::get_time_in_milliseconds() {
 	return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
 }
 
+u64 nyla::get_time_in_nanoseconds() {
+	using std::chrono::duration_cast;
+	using std::chrono::nanoseconds;
+	using std::chrono::steady_clock;
+
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+u64 nyla::get_memory_usage() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.WorkingSetSize;
+#elif defined(__linux__)
+	// The second field is the number of resident pages
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (!statm) {
+		return 0;
+	}
+	unsigned long long num_pages = 0, num_resident_pages = 0;
+	s32 num_read = fscanf(statm, "%llu %llu", &num_pages, &num_resident_pages);
+	fclose(statm);
+	if (num_read != 2) {
+		return 0;
+	}
+	return num_resident_pages * sysconf(_SC_PAGESIZE);
+#else
+	return 0;
+#endif
+}
+
+u64 nyla::get_peak_memory_usage() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#ifdef __APPLE__
+	return usage.ru_maxrss;
+#else
+	// Linux gives the size in kilobytes
+	return (u64)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
 void nyla::set_console_color(int color_id) {
 #ifdef _WIN32
 	SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), color_id);
@@ -49,6 +121,46 @@ std::tuple<std::vector<nyla::search_file>, bool> nyla::get_directory_files(const
 	} while (FindNextFileA(f_handle, &data) != 0);
 
 	FindClose(f_handle);
+#elif defined(__linux__)
+	int dir_fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dir_fd < 0) {
+		return std::tuple<std::vector<search_file>, bool>{ files, false };
+	}
+
+	// Reading the entries in large batches directly from the
+	// kernel rather than one readdir call per entry
+	struct linux_dirent64 {
+		u64            d_ino;
+		s64            d_off;
+		unsigned short d_reclen;
+		unsigned char  d_type;
+		c8             d_name[1];
+	};
+	alignas(linux_dirent64) c8 buffer[32 * 1024];
+	while (true) {
+		long num_read = syscall(SYS_getdents64, dir_fd, buffer, sizeof(buffer));
+		if (num_read < 0) {
+			close(dir_fd);
+			return std::tuple<std::vector<search_file>, bool>{ files, false };
+		}
+		if (num_read == 0) break;
+		for (long offset = 0; offset < num_read;) {
+			linux_dirent64* entry = (linux_dirent64*)(buffer + offset);
+			offset += entry->d_reclen;
+			const c8* name = entry->d_name;
+			if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+				continue;
+			}
+			bool is_directory = entry->d_type == DT_DIR;
+			if (entry->d_type == DT_UNKNOWN) {
+				// Some file systems do not fill in the type
+				struct stat st;
+				is_directory = fstatat(dir_fd, name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+			}
+			files.push_back(search_file{ std::string(name), is_directory });
+		}
+	}
+	close(dir_fd);
 #endif
 
 	return std::tuple<std::vector<search_file>, bool>{ files, true };
@@ -126,3 +238,244 @@ bool nyla::read_file(const std::string& path, c8*& data, ulen& size) {
 	return true;
 }
 
+#ifdef __linux__
+// Smaller files are copied since mapping them costs more than the copy
+static constexpr ulen min_mapped_file_size = 64 * 1024;
+
+static ulen get_mapping_size(ulen size, ulen padding) {
+	ulen page_size = sysconf(_SC_PAGESIZE);
+	return (size + padding + page_size - 1) & ~(page_size - 1);
+}
+#endif
+
+bool nyla::map_file(const std::string& path, ulen padding, c8*& data, ulen& size) {
+#ifdef __linux__
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		close(fd);
+		return false;
+	}
+	size = st.st_size;
+
+	if (size < min_mapped_file_size) {
+		data = new c8[size + padding];
+		ulen total_read = 0;
+		while (total_read < size) {
+			ssize_t num_read = read(fd, data + total_read, size - total_read);
+			if (num_read <= 0) {
+				if (num_read < 0 && errno == EINTR) continue;
+				break;
+			}
+			total_read += num_read;
+		}
+		close(fd);
+		// The file may have shrunk since fstat
+		size = total_read;
+		memset(data + size, 0, padding);
+		return true;
+	}
+
+	// Reserving zeroed pages for the file and its padding then
+	// mapping the file over the front of them. The rest of the
+	// file's last page is zero filled by the kernel
+	ulen mapping_size = get_mapping_size(size, padding);
+	void* base = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(base, mapping_size);
+		close(fd);
+		return false;
+	}
+	close(fd);
+	data = (c8*)base;
+	return true;
+#else
+	std::ifstream in(path, std::ios::binary | std::ios::in);
+	if (!in.good()) {
+		return false;
+	}
+	in.seekg(0, std::ios::end);
+	size = in.tellg();
+	data = new c8[size + padding];
+	in.seekg(0, std::ios::beg);
+	in.read(data, size);
+	memset(data + size, 0, padding);
+	return true;
+#endif
+}
+
+void nyla::unmap_file(c8* data, ulen size, ulen padding) {
+	if (!data) return;
+#ifdef __linux__
+	if (size >= min_mapped_file_size) {
+		munmap(data, get_mapping_size(size, padding));
+		return;
+	}
+#endif
+	delete[] data;
+}
+
+bool nyla::write_file(const std::string& path, const c8* data, ulen size) {
+	// Named by the process and thread so compilers writing
+	// the same file at the same time do not share a temporary
+#ifdef _WIN32
+	u64 process_id = GetCurrentProcessId();
+#else
+	u64 process_id = (u64)getpid();
+#endif
+	u64 thread_id = (u64)std::hash<std::thread::id>()(std::this_thread::get_id());
+	std::string temp_path = path + "." + std::to_string(process_id) +
+		                    "." + std::to_string(thread_id) + ".tmp";
+	{
+		std::ofstream out(temp_path, std::ios::binary | std::ios::out | std::ios::trunc);
+		if (!out.good()) {
+			return false;
+		}
+		out.write(data, size);
+		out.close();
+		if (!out.good()) {
+			std::remove(temp_path.c_str());
+			return false;
+		}
+	}
+#ifdef _WIN32
+	bool renamed = MoveFileExA(temp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	bool renamed = rename(temp_path.c_str(), path.c_str()) == 0;
+#endif
+	if (!renamed) {
+		std::remove(temp_path.c_str());
+	}
+	return renamed;
+}
+
+bool nyla::create_directory(const std::string& path) {
+#ifdef _WIN32
+	return CreateDirectoryA(path.c_str(), nullptr) != 0 ||
+		   GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+	return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+bool nyla::remove_directory(const std::string& path) {
+	std::tuple<std::vector<search_file>, bool> files = nyla::get_directory_files(path);
+	if (!std::get<1>(files)) return false;
+	for (const search_file& file : std::get<0>(files)) {
+		std::string file_path = path + "/" + file.path;
+		if (file.is_directory) {
+			if (!remove_directory(file_path)) return false;
+		} else if (std::remove(file_path.c_str()) != 0) {
+			return false;
+		}
+	}
+#ifdef _WIN32
+	return RemoveDirectoryA(path.c_str()) != 0;
+#else
+	return rmdir(path.c_str()) == 0;
+#endif
+}
+
+u64 nyla::hash_bytes(const c8* data, ulen size) {
+	u64 hash = 14695981039346656037ULL;
+	for (ulen i = 0; i < size; i++) {
+		hash ^= (u8)data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+// Multiplies the values into a 128 bit product and
+// returns its low and high halves in a and b
+static inline void wy_multiply(u64& a, u64& b) {
+#if defined(__SIZEOF_INT128__)
+	__uint128_t product = (__uint128_t)a * b;
+	a = (u64)product;
+	b = (u64)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	a = _umul128(a, b, &b);
+#else
+	u64 ha = a >> 32, hb = b >> 32, la = (u32)a, lb = (u32)b;
+	u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	u64 t = rl + (rm0 << 32), carry = t < rl;
+	u64 lo = t + (rm1 << 32);
+	carry += lo < t;
+	a = lo;
+	b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static inline u64 wy_mix(u64 a, u64 b) {
+	wy_multiply(a, b);
+	return a ^ b;
+}
+
+static inline u64 wy_read8(const u8* p) {
+	u64 v;
+	memcpy(&v, p, 8);
+	return v;
+}
+
+static inline u64 wy_read4(const u8* p) {
+	u32 v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+// Reads 1 to 3 bytes
+static inline u64 wy_read3(const u8* p, ulen k) {
+	return (((u64)p[0]) << 16) | (((u64)p[k >> 1]) << 8) | p[k - 1];
+}
+
+u64 nyla::wyhash(const c8* data, ulen size, u64 seed) {
+	static const u64 secret[4] = {
+		0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+		0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+	};
+	const u8* p = (const u8*)data;
+	seed ^= wy_mix(seed ^ secret[0], secret[1]);
+	u64 a, b;
+	if (size <= 16) {
+		if (size >= 4) {
+			a = (wy_read4(p) << 32) | wy_read4(p + ((size >> 3) << 2));
+			b = (wy_read4(p + size - 4) << 32) | wy_read4(p + size - 4 - ((size >> 3) << 2));
+		} else if (size > 0) {
+			a = wy_read3(p, size);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		ulen i = size;
+		if (i > 48) {
+			u64 seed1 = seed, seed2 = seed;
+			do {
+				seed  = wy_mix(wy_read8(p)      ^ secret[1], wy_read8(p + 8)  ^ seed);
+				seed1 = wy_mix(wy_read8(p + 16) ^ secret[2], wy_read8(p + 24) ^ seed1);
+				seed2 = wy_mix(wy_read8(p + 32) ^ secret[3], wy_read8(p + 40) ^ seed2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= seed1 ^ seed2;
+		}
+		while (i > 16) {
+			seed = wy_mix(wy_read8(p) ^ secret[1], wy_read8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = wy_read8(p + i - 16);
+		b = wy_read8(p + i - 8);
+	}
+	a ^= secret[1];
+	b ^= seed;
+	wy_multiply(a, b);
+	return wy_mix(a ^ secret[0] ^ size, b ^ secret[1]);
+}
+
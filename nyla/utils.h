@@ -23,6 +23,18 @@ namespace nyla {
 	// in milliseconds (time since epoch)
 	u64 get_time_in_milliseconds();
 
+	// Get the time of a steady clock in nanoseconds. Only
+	// useful for measuring the time between two points
+	u64 get_time_in_nanoseconds();
+
+	// Bytes of physical memory used by the process right now
+	// (resident set size). Returns 0 if it cannot be found
+	u64 get_memory_usage();
+
+	// Largest number of bytes of physical memory the process has
+	// used since it started. Returns 0 if it cannot be found
+	u64 get_peak_memory_usage();
+
 	// Sets the color for the console.
 	void set_console_color(int color_id);
 
@@ -47,6 +59,33 @@ namespace nyla {
 	// Read a file into a character buffer 'data'
 	bool read_file(const std::string& path, c8*& data, ulen& size);
 
+	// Loads a file into a character buffer 'data' followed by 'padding'
+	// zeroed bytes so readers may look past the end. Large files are
+	// memory mapped. The buffer must be freed with unmap_file
+	bool map_file(const std::string& path, ulen padding, c8*& data, ulen& size);
+
+	// Frees a buffer returned by map_file
+	void unmap_file(c8* data, ulen size, ulen padding);
+
+	// Writes the data to a temporary file which is then renamed
+	// so readers never see a partially written file. Each thread
+	// writes its own temporary which is removed on failure
+	bool write_file(const std::string& path, const c8* data, ulen size);
+
+	// Creates the directory if it does not already exist
+	bool create_directory(const std::string& path);
+
+	// Removes the directory along with everything under it
+	bool remove_directory(const std::string& path);
+
+	// Hashes the bytes using FNV-1a. Used to tell if the
+	// contents of a file changed
+	u64 hash_bytes(const c8* data, ulen size);
+
+	// Hashes the bytes using wyhash. Much faster than FNV-1a
+	// for the short strings of identifiers
+	u64 wyhash(const c8* data, ulen size, u64 seed = 0);
+
 	// Checks if the string ends with another string
 	template<typename T>
 	bool string_ends_with(const T& str, const T& ending) {
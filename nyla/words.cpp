@@ -1,48 +1,134 @@
 #include "words.h"
 
+#include "utils.h"
+
 #include <assert.h>
+#include <algorithm>
+
+// Size of the blocks of the arena. Longer words get
+// a block of their own
+constexpr ulen word_block_size = 64 * 1024;
+
+constexpr ulen initial_word_slots = 1024;
+
+// Words are stored in chunks of 4096 words with room
+// for 16384 chunks
+constexpr u32 word_chunk_bits = 12;
+constexpr u32 word_chunk_size = 1 << word_chunk_bits;
+constexpr u32 max_word_chunks = 1 << 14;
+
+u64 nyla::hash_word(const c8* chars, ulen length) {
+	return nyla::wyhash(chars, length);
+}
+
+nyla::word_table::word_table()
+	: m_word_chunks(new std::atomic<nyla::word*>[max_word_chunks]) {
+	for (u32 i = 0; i < max_word_chunks; i++) {
+		m_word_chunks[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+nyla::word_table::~word_table() {
+	clear_table();
+}
 
-u32 nyla::word::make(c_string buffer) {
-	nyla::word word = nyla::word(buffer);
-	return g_word_table->get_key(word);
+const c8* nyla::word_table::store_chars(const c8* chars, ulen length) {
+	ulen needed = length + 1; // Room for the null terminator
+	if (needed > m_block_left) {
+		ulen block_size = std::max(needed, word_block_size);
+		m_blocks.emplace_back(new c8[block_size]);
+		m_block_ptr    = m_blocks.back().get();
+		m_block_left   = block_size;
+		m_arena_bytes += block_size;
+	}
+	c8* stored = m_block_ptr;
+	memcpy(stored, chars, length);
+	stored[length] = '\0';
+	m_block_ptr  += needed;
+	m_block_left -= needed;
+	return stored;
+}
+
+void nyla::word_table::grow_slots() {
+	std::vector<u32> slots(std::max(initial_word_slots, m_slots.size() * 2), 0);
+	ulen mask = slots.size() - 1;
+	for (u32 key = 0; key < m_num_words; key++) {
+		ulen slot = word_at(key).hash() & mask;
+		while (slots[slot] != 0) {
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = key + 1;
+	}
+	m_slots.swap(slots);
 }
 
-void nyla::word::append(c8 ch) {
-	m_buffer[m_ptr++ & 0xFF] = ch;
+void nyla::word_table::add_word(const nyla::word& word) {
+	u32 chunk_index = m_num_words >> word_chunk_bits;
+	assert(chunk_index < max_word_chunks);
+	nyla::word* chunk = m_word_chunks[chunk_index].load(std::memory_order_relaxed);
+	if (!chunk) {
+		chunk = new nyla::word[word_chunk_size];
+		m_word_chunks[chunk_index].store(chunk, std::memory_order_release);
+	}
+	chunk[m_num_words & (word_chunk_size - 1)] = word;
+	++m_num_words;
 }
 
-void nyla::word::finalize() {
-	m_buffer[m_ptr & 0xFF] = '\0'; // Null appending
-	ulen hash = 0;
-	for (u32 i = 0; i < size(); i++)
-		hash = 31 * hash + (m_buffer[i] & 0xFF);
-	m_precomputed_hash = hash;
+nyla::word& nyla::word_table::word_at(u32 word_key) {
+	nyla::word* chunk = m_word_chunks[word_key >> word_chunk_bits].load(std::memory_order_acquire);
+	return chunk[word_key & (word_chunk_size - 1)];
 }
 
-u32 nyla::word_table::get_key(nyla::word& word) {
-	word.finalize();
+u32 nyla::word_table::get_key(const c8* chars, ulen length, u64 hash) {
+	nyla::word word(chars, (u32)length, hash);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// Keeping the slots at most three quarters full
+	if ((m_num_words + 1) * 4 > m_slots.size() * 3) {
+		grow_slots();
+	}
 
-	auto it = key_mapping.find(word);
-	if (it != key_mapping.end()) {
-		return it->second;
+	ulen mask = m_slots.size() - 1;
+	ulen slot = hash & mask;
+	while (m_slots[slot] != 0) {
+		u32 key = m_slots[slot] - 1;
+		if (word_at(key) == word) {
+			return key;
+		}
+		slot = (slot + 1) & mask;
 	}
 
-	u32 this_key_index = key_index;
-	key_mapping[word] = this_key_index;
-	m_words.push_back(word);
-	++key_index;
-	return this_key_index;
+	u32 key = m_num_words;
+	add_word(nyla::word(store_chars(chars, length), (u32)length, hash));
+	m_slots[slot] = key + 1;
+	return key;
 }
 
 nyla::word nyla::word_table::get_word(u32 word_key) {
-	assert(m_words.size() > word_key);
-	return m_words[word_key];
+	// Whoever handed out the key saw the word stored
+	// so the word is read without locking
+	return word_at(word_key);
 }
 
 void nyla::word_table::clear_table() {
-	key_mapping.clear();
-	m_words.clear();
-	key_index = 0;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_slots.clear();
+	for (u32 i = 0; i < max_word_chunks; i++) {
+		delete[] m_word_chunks[i].exchange(nullptr, std::memory_order_relaxed);
+	}
+	m_num_words = 0;
+	m_blocks.clear();
+	m_block_ptr   = nullptr;
+	m_block_left  = 0;
+	m_arena_bytes = 0;
 }
 
-nyla::word_table* nyla::g_word_table = new nyla::word_table;
\ No newline at end of file
+void nyla::word_table::get_memory_usage(ulen& num_entries, ulen& num_bytes) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	ulen num_chunks = (m_num_words + word_chunk_size - 1) >> word_chunk_bits;
+	num_entries = m_num_words;
+	num_bytes   = num_chunks * word_chunk_size * sizeof(nyla::word) +
+		          max_word_chunks * sizeof(std::atomic<nyla::word*>) +
+		          m_slots.capacity() * sizeof(u32) +
+		          m_arena_bytes;
+}
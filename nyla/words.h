@@ -3,83 +3,124 @@
 
 #include "types_ext.h"
 #include <vector>
-#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstring>
 
 namespace nyla {
 
+	/*
+	 * View of the characters of a word. Words handed out
+	 * by the word table point into the table's arena and
+	 * stay valid until the table is cleared. Copying a
+	 * word never copies the characters.
+	 */
 	class word {
-		word(c_string buffer) {
-			m_ptr = strlen(buffer);
-			memcpy(m_buffer, buffer, m_ptr);
-		}
 	public:
 		word() {}
 
-		struct hash_gen {
-			ulen operator()(const nyla::word& word) const {
-				return word.m_precomputed_hash;
-			}
-		};
+		word(const c8* chars, u32 length, u64 hash)
+			: m_chars(chars), m_length(length), m_hash(hash) {}
 
 		bool operator!=(const nyla::word& o) const {
 			return !(*this == o);
 		}
 
 		bool operator==(const nyla::word& o) const {
-			if (o.m_ptr != m_ptr) return false;
-			for (u32 i = 0; i < (m_ptr & 0xFF); i++) {
-				if (m_buffer[i] != o.m_buffer[i]) return false;
-			}
-			return true;
+			return m_hash == o.m_hash && m_length == o.m_length &&
+				   memcmp(m_chars, o.m_chars, m_length) == 0;
 		}
 
-		static u32 make(c_string buffer);
-
-		// Appends a character onto the buffer
-		void append(c8 ch);
-
-		// Null terminate and compute the hash
-		void finalize();
+		// Word as a C-Style string. Only words from
+		// the word table are null terminated
+		c_string c_str() const { return m_chars; }
 
-		// Word as a C-Style string
-		c_string c_str() const { return m_buffer; }
+		u32 size() const { return m_length; }
 
-		u32 size() const { return m_ptr; }
+		u64 hash() const { return m_hash; }
 
 	private:
-		ulen m_precomputed_hash;
-
-		ulen m_ptr = 0;
-		c8   m_buffer[257]; // Character buffer
+		const c8* m_chars  = "";
+		u32       m_length = 0;
+		u64       m_hash   = 0;
 	};
 
+	// Hash of a word's characters given to the word table
+	u64 hash_word(const c8* chars, ulen length);
+
 	/*
 	 * Converts words into unsigned integers
 	 * to save time comparing words.
+	 *
+	 * The characters of every word are stored once
+	 * in an arena. Safe to use from multiple threads.
+	 * Words are kept in chunks which never move once
+	 * published so only get_key takes the lock.
 	 */
 	class word_table {
 	public:
 
-		u32 get_key(nyla::word& word);
+		word_table();
+
+		~word_table();
+
+		// Key of the word made of the characters where the
+		// hash came from hash_word
+		u32 get_key(const c8* chars, ulen length, u64 hash);
+
+		u32 get_key(const c8* chars, ulen length) {
+			return get_key(chars, length, nyla::hash_word(chars, length));
+		}
+
+		// Key of the word given as a C-Style string
+		u32 get_key(c_string buffer) {
+			return get_key(buffer, strlen(buffer));
+		}
 
+		// The key must have come from get_key. Does not
+		// lock so may run alongside get_key
 		nyla::word get_word(u32 word_key);
 
 		void clear_table();
 
+		// Number of words in the table and an estimate
+		// of the bytes used to store them
+		void get_memory_usage(ulen& num_entries, ulen& num_bytes);
+
 	private:
 
-		// Map between words and their keys
-		std::unordered_map<nyla::word, u32,
-			               nyla::word::hash_gen> key_mapping;
+		// Copies the characters into the arena followed
+		// by a null terminator
+		const c8* store_chars(const c8* chars, ulen length);
 
-		std::vector<nyla::word> m_words; // Index into the vector
-										 // is a word's key
+		// Doubles the number of slots and enters the words again
+		void grow_slots();
 
-		u32 key_index = 0;
+		// Stores the word under the next key
+		void add_word(const nyla::word& word);
 
-	};
+		nyla::word& word_at(u32 word_key);
 
-	extern nyla::word_table* g_word_table;
+		// Open addressed slots holding one more than the key
+		// of a word or 0 when the slot is empty
+		std::vector<u32> m_slots;
+
+		// Chunks of words indexed by the upper bits of a
+		// word's key. The directory has a fixed size so
+		// readers never see it move
+		std::unique_ptr<std::atomic<nyla::word*>[]> m_word_chunks;
+		u32                                         m_num_words = 0;
+
+		// Blocks of the arena and the space left in the last block
+		std::vector<std::unique_ptr<c8[]>> m_blocks;
+		c8*                                m_block_ptr   = nullptr;
+		ulen                               m_block_left  = 0;
+		ulen                               m_arena_bytes = 0;
+
+		std::mutex m_mutex;
+
+	};
 
 }
 
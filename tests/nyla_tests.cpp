@@ -2,31 +2,682 @@
 
 #include "test_suite.h"
 #include "words.h"
+#include "scan.h"
+#include "source.h"
+#include "server.h"
 
 #include <iostream>
+#include <thread>
+#include <functional>
+#include <cctype>
+#include <chrono>
 
-void test_program(const std::string& sub_project, const std::string& main_function_file, int test_error_code, u32 extra_flags = 0) {
-	nyla::compiler compiler;
-	compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION | extra_flags);
-	std::vector<std::string> src_directories;
-	src_directories.push_back("resources/" + sub_project);
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+// Removes the files within the directory, creating it
+// if it does not exist yet
+void clear_directory(const std::string& directory) {
+	nyla::create_directory(directory);
+	std::vector<nyla::search_file> files = std::get<0>(nyla::get_directory_files(directory));
+	for (const nyla::search_file& file : files) {
+		std::remove((directory + "/" + file.path).c_str());
+	}
+}
+
+// Runs the executable the tests compile and checks its exit code
+void check_program_exit_code(int test_error_code, const std::string& executable_name = "nyla_test_project.exe") {
+	int return_code = system(executable_name.c_str());
+	check_eq(return_code, test_error_code);
+}
 
+// Compiles the project with a compiler set up by configure.
+// The compiler is handed to check if the project compiled.
+// Returns false if there were compile errors
+bool compile_test_project(const std::vector<std::string>& src_directories, const std::string& main_function_file,
+	                      const std::function<void(nyla::compiler&)>& configure,
+	                      const std::function<void(nyla::compiler&)>& check) {
+	nyla::compiler compiler;
+	compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION);
 	compiler.set_executable_name("nyla_test_project.exe");
+	configure(compiler);
 	compiler.compile(src_directories, main_function_file);
 
-	if (!compiler.get_found_compilation_errors()) {
-		int return_code = system("nyla_test_project.exe");
-		check_eq(return_code, test_error_code);
+	bool compiled = !compiler.get_found_compilation_errors();
+	if (compiled) {
+		check(compiler);
 	} else {
 		check_tof(false, "Compile Errors");
 	}
 	compiler.completely_cleanup();
+	return compiled;
+}
+
+bool compile_test_project(const std::string& sub_project, const std::string& main_function_file,
+	                      const std::function<void(nyla::compiler&)>& configure,
+	                      const std::function<void(nyla::compiler&)>& check) {
+	std::vector<std::string> src_directories;
+	src_directories.push_back("resources/" + sub_project);
+	return compile_test_project(src_directories, main_function_file, configure, check);
+}
+
+void test_program(const std::string& sub_project, const std::string& main_function_file, int test_error_code, u32 extra_flags = 0) {
+	compile_test_project(sub_project, main_function_file, [extra_flags](nyla::compiler& compiler) {
+		compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION | extra_flags);
+	}, [test_error_code](nyla::compiler&) {
+		check_program_exit_code(test_error_code);
+	});
 }
 
 void test_program(const std::string& sub_project, int test_error_code, u32 extra_flags = 0) {
 	test_program(sub_project, sub_project, test_error_code, extra_flags);
 }
 
+// Compiles the project in memory and runs it with the JIT
+// rather than linking an executable
+void test_run(const std::string& sub_project, const std::string& main_function_file, int test_error_code, u32 extra_flags = 0) {
+	compile_test_project(sub_project, main_function_file, [extra_flags](nyla::compiler& compiler) {
+		compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION | nyla::COMPFLAG_RUN | extra_flags);
+	}, [test_error_code](nyla::compiler& compiler) {
+		check_eq(compiler.get_run_exit_code(), test_error_code);
+	});
+}
+
+// Analyzes the project once to write the interfaces of its
+// files and again to load the imported file from its interface.
+// The program is then compiled with the interfaces present
+void test_interfaces(const std::string& sub_project, const std::string& main_function_file,
+	                 const std::string& imported_file, int test_error_code) {
+	std::string interface_directory = "nyla_test_interfaces";
+	clear_directory(interface_directory);
+	auto configure = [&interface_directory](nyla::compiler& compiler) {
+		compiler.set_flags(nyla::COMPFLAG_ONLY_PARSE_AND_ANALYZE);
+		compiler.set_interface_directory(interface_directory);
+	};
+
+	for (u32 i = 0; i < 2; i++) {
+		bool compiled = compile_test_project(sub_project, main_function_file, configure,
+			[&imported_file, i](nyla::compiler& compiler) {
+			nyla::sym_table* imported_sym_table = compiler.find_sym_table(imported_file);
+			bool from_interface = imported_sym_table && imported_sym_table->m_from_interface;
+			check_tof(from_interface == (i == 1), i == 0 ? "Interfaces Written" : "Interfaces Loaded");
+		});
+		if (!compiled) return;
+	}
+
+	compile_test_project(sub_project, main_function_file, [&interface_directory](nyla::compiler& compiler) {
+		compiler.set_interface_directory(interface_directory);
+	}, [test_error_code](nyla::compiler&) {
+		check_program_exit_code(test_error_code);
+	});
+}
+
+// Compiles the project twice with compilers which keep every
+// function body so the objects do not depend on the functions
+// the program calls. The second compile takes the imported file
+// from its interface and links its cached object. With LTO the
+// cached object is bitcode which is optimized with the rest
+void test_interfaces_with_object_cache(const std::string& sub_project, const std::string& main_function_file,
+	                                   const std::string& imported_file, int test_error_code,
+	                                   u32 extra_flags = 0) {
+	std::string interface_directory = "nyla_test_interfaces";
+	std::string cache_directory     = "nyla_test_cache";
+	clear_directory(interface_directory);
+	clear_directory(cache_directory);
+	auto configure = [&interface_directory, &cache_directory, extra_flags](nyla::compiler& compiler) {
+		compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION | extra_flags);
+		compiler.set_reuse_sym_tables(true);
+		compiler.set_interface_directory(interface_directory);
+		compiler.set_object_cache_directory(cache_directory);
+	};
+
+	for (u32 i = 0; i < 2; i++) {
+		compile_test_project(sub_project, main_function_file, configure,
+			[&imported_file, test_error_code, i](nyla::compiler& compiler) {
+			nyla::sym_table* imported_sym_table = compiler.find_sym_table(imported_file);
+			bool from_interface = imported_sym_table && imported_sym_table->m_from_interface;
+			check_tof(from_interface == (i == 1), i == 0 ? "Interfaces Written" : "Interfaces Linked");
+			check_program_exit_code(test_error_code);
+		});
+	}
+}
+
+// Compiles the project twice against an empty object cache.
+// The first compile fills the cache and the second takes the
+// object code of the files from it
+void test_object_cache(const std::string& sub_project, const std::string& main_function_file, int test_error_code) {
+	std::string cache_directory = "nyla_test_cache";
+	clear_directory(cache_directory);
+	auto configure = [&cache_directory](nyla::compiler& compiler) {
+		compiler.set_object_cache_directory(cache_directory);
+	};
+
+	for (u32 i = 0; i < 2; i++) {
+		compile_test_project(sub_project, main_function_file, configure,
+			[&main_function_file, test_error_code, i](nyla::compiler& compiler) {
+			nyla::sym_table* main_sym_table = compiler.find_sym_table(main_function_file);
+			bool cache_hit = main_sym_table && main_sym_table->m_obj_cache_hit;
+			check_tof(cache_hit == (i == 1), i == 0 ? "Cache Filled" : "Cache Hit");
+			check_program_exit_code(test_error_code);
+		});
+	}
+}
+
+// Builds two programs which call different functions of a shared
+// file. The shared file only has bodies for the functions each
+// program calls so its cached object is not shared between them
+void test_object_cache_reachability(const std::string& sub_project, const std::string& shared_file,
+	                                const std::string& first_main_file, int first_error_code,
+	                                const std::string& second_main_file, int second_error_code) {
+	std::string cache_directory = "nyla_test_cache";
+	clear_directory(cache_directory);
+	auto configure = [&cache_directory](nyla::compiler& compiler) {
+		compiler.set_object_cache_directory(cache_directory);
+	};
+
+	const std::string main_function_files[] = { first_main_file, second_main_file, first_main_file };
+	const int         test_error_codes[]    = { first_error_code, second_error_code, first_error_code };
+	for (u32 i = 0; i < 3; i++) {
+		compile_test_project(sub_project, main_function_files[i], configure,
+			[&shared_file, &test_error_codes, i](nyla::compiler& compiler) {
+			nyla::sym_table* shared_sym_table = compiler.find_sym_table(shared_file);
+			bool cache_hit = shared_sym_table && shared_sym_table->m_obj_cache_hit;
+			check_tof(cache_hit == (i == 2), i == 2 ? "Cache Hit" : "Cache Missed");
+			check_program_exit_code(test_error_codes[i]);
+		});
+	}
+}
+
+// Compiles the projects at the same time with a compiler on
+// each thread. Each compiler links an executable of its own
+void test_concurrent_compilers(const std::string& first_sub_project, int first_error_code,
+	                           const std::string& second_sub_project, int second_error_code) {
+	const std::string sub_projects[2]     = { first_sub_project, second_sub_project };
+	const int         test_error_codes[2] = { first_error_code, second_error_code };
+	const std::string executable_names[2] = { "nyla_test_project_0.exe", "nyla_test_project_1.exe" };
+
+	bool compiled[2] = { false, false };
+	std::vector<std::thread> threads;
+	for (u32 i = 0; i < 2; i++) {
+		threads.emplace_back([&sub_projects, &executable_names, &compiled, i]() {
+			nyla::compiler compiler;
+			compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION);
+			compiler.set_num_jobs(2);
+			std::vector<std::string> src_directories;
+			src_directories.push_back("resources/" + sub_projects[i]);
+
+			compiler.set_executable_name(executable_names[i]);
+			compiler.compile(src_directories, sub_projects[i]);
+			compiled[i] = !compiler.get_found_compilation_errors();
+			compiler.completely_cleanup();
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	for (u32 i = 0; i < 2; i++) {
+		if (compiled[i]) {
+			check_program_exit_code(test_error_codes[i], executable_names[i]);
+		} else {
+			check_tof(false, "Compile Errors");
+		}
+	}
+}
+
+// Copies the files under the directory into another directory
+bool copy_directory(const std::string& from, const std::string& to) {
+	if (!nyla::create_directory(to)) return false;
+	std::tuple<std::vector<nyla::search_file>, bool> files = nyla::get_directory_files(from);
+	if (!std::get<1>(files)) return false;
+	for (const nyla::search_file& file : std::get<0>(files)) {
+		std::string from_path = from + "/" + file.path;
+		std::string to_path   = to + "/" + file.path;
+		if (file.is_directory) {
+			if (!copy_directory(from_path, to_path)) return false;
+			continue;
+		}
+		c8*  data;
+		ulen size;
+		if (!nyla::read_file(from_path, data, size)) return false;
+		bool written = nyla::write_file(to_path, data, size);
+		delete[] data;
+		if (!written) return false;
+	}
+	return true;
+}
+
+// Contents of the file or an empty string if it cannot be read
+std::string read_test_file(const std::string& path) {
+	c8*  data;
+	ulen size;
+	if (!nyla::read_file(path, data, size)) return "";
+	std::string contents(data, size);
+	delete[] data;
+	return contents;
+}
+
+// Writes the dependency file and both forms of the import graph
+// for a copy of the project in a directory whose name has to be
+// escaped
+void test_emitted_files() {
+	std::string directory_name  = "a b#$";
+	std::string make_directory  = "a\\ b\\#$$";
+	std::string graph_directory = "a b#$";
+#ifndef _WIN32
+	// Windows does not allow control characters in paths
+	directory_name  += "\t\x01";
+	make_directory  += "\t\x01";
+	graph_directory += "\\t\\u0001";
+#endif
+	std::string src_directory = "nyla_test_deps/" + directory_name;
+	nyla::remove_directory("nyla_test_deps");
+	if (!nyla::create_directory("nyla_test_deps") ||
+		!copy_directory("resources/Reproducible", src_directory)) {
+		check_tof(false, "Copy Project");
+		return;
+	}
+	std::vector<std::string> src_directories;
+	src_directories.push_back(src_directory);
+
+	std::string make_path  = "nyla_test_deps/" + make_directory + "/";
+	std::string graph_path = "nyla_test_deps/" + graph_directory + "/";
+	std::string expected_deps =
+		"nyla_test_project.exe: \\\n"
+		"  " + make_path + "Reproducible.nyla \\\n"
+		"  " + make_path + "shapes/Square.nyla \\\n"
+		"  " + make_path + "shapes/Triangle.nyla\n";
+	std::string expected_json =
+		"{\n"
+		"  \"files\": [\n"
+		"    { \"path\": \"Reproducible\", \"file\": \"" + graph_path + "Reproducible.nyla\" },\n"
+		"    { \"path\": \"shapes/Square\", \"file\": \"" + graph_path + "shapes/Square.nyla\" },\n"
+		"    { \"path\": \"shapes/Triangle\", \"file\": \"" + graph_path + "shapes/Triangle.nyla\" }\n"
+		"  ],\n"
+		"  \"imports\": [\n"
+		"    { \"from\": \"Reproducible\", \"to\": \"shapes/Square\" },\n"
+		"    { \"from\": \"Reproducible\", \"to\": \"shapes/Triangle\" },\n"
+		"    { \"from\": \"shapes/Triangle\", \"to\": \"shapes/Square\" }\n"
+		"  ]\n"
+		"}\n";
+	std::string expected_dot =
+		"digraph imports {\n"
+		"  \"Reproducible\";\n"
+		"  \"shapes/Square\";\n"
+		"  \"shapes/Triangle\";\n"
+		"  \"Reproducible\" -> \"shapes/Square\";\n"
+		"  \"Reproducible\" -> \"shapes/Triangle\";\n"
+		"  \"shapes/Triangle\" -> \"shapes/Square\";\n"
+		"}\n";
+
+	const std::string graph_files[2]     = { "nyla_test_deps/imports.json", "nyla_test_deps/imports.dot" };
+	const std::string expected_graphs[2] = { expected_json, expected_dot };
+	for (u32 i = 0; i < 2; i++) {
+		compile_test_project(src_directories, "Reproducible", [&graph_files, i](nyla::compiler& compiler) {
+			compiler.set_deps_file("nyla_test_deps/program.d");
+			compiler.set_graph_file(graph_files[i]);
+		}, [&](nyla::compiler&) {
+			check_tof(read_test_file("nyla_test_deps/program.d") == expected_deps, "Dependency File");
+			check_tof(read_test_file(graph_files[i]) == expected_graphs[i], i == 0 ? "JSON Graph" : "DOT Graph");
+		});
+	}
+	nyla::remove_directory("nyla_test_deps");
+}
+
+// Writes the contents into the file of the watched project
+bool write_test_file(const std::string& path, const std::string& contents) {
+	return nyla::write_file(path, contents.data(), contents.size());
+}
+
+// Compiles a copy of a project with one compiler the way -watch
+// does. The files and directories are changed between compiles
+// and the compiler is told of the changes instead of searching
+// the source directory again
+void test_source_changes() {
+	std::string src_directory = "nyla_test_watch/src";
+	nyla::remove_directory("nyla_test_watch");
+	if (!nyla::create_directory("nyla_test_watch") ||
+		!copy_directory("resources/Reproducible", src_directory)) {
+		check_tof(false, "Copy Project");
+		return;
+	}
+	std::vector<std::string> src_directories;
+	src_directories.push_back(src_directory);
+
+	std::string main_path   = src_directory + "/Reproducible.nyla";
+	std::string square_path = src_directory + "/shapes/Square.nyla";
+	std::string offset_path = src_directory + "/Offset.nyla";
+	std::string extra_path  = src_directory + "/extra";
+	std::string main_source = read_test_file(main_path);
+	std::string square_source = read_test_file(square_path);
+
+	nyla::compiler compiler;
+	compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION);
+	compiler.set_reuse_sym_tables(true);
+	compiler.set_executable_name("nyla_test_project.exe");
+
+	auto compile = [&](c_string info, int test_error_code) {
+		compiler.compile(src_directories, "Reproducible");
+		if (compiler.get_found_compilation_errors()) {
+			check_tof(false, info);
+			return false;
+		}
+		check_program_exit_code(test_error_code);
+		return true;
+	};
+
+	if (!compile("Compile Errors", 9 + 16 + 12 + 8 + 7)) return;
+
+	// Modified file
+	write_test_file(square_path, nyla::replace(square_source, "side * side", "side * side * 2"));
+	nyla::source_changes modify_changes;
+	modify_changes.modified_files.push_back(square_path);
+	compiler.set_source_changes(modify_changes);
+	if (!compile("Modified File", 18 + 16 + 12 + 8 + 7)) return;
+
+	// Created file and a created directory with a file in it
+	nyla::create_directory(extra_path);
+	write_test_file(extra_path + "/Bonus.nyla", "module Bonus {\n\tstatic int value() {\n\t\treturn 100;\n\t}\n}");
+	write_test_file(offset_path, "module Offset {\n\tstatic int value() {\n\t\treturn 3;\n\t}\n}");
+	std::string created_main_source =
+		"import extra.Bonus;\nimport Offset;\n" +
+		nyla::replace(main_source, "+ started;", "+ started + Bonus.value() + Offset.value();");
+	write_test_file(main_path, created_main_source);
+	nyla::source_changes create_changes;
+	create_changes.created_directories.push_back(extra_path);
+	create_changes.created_files.push_back(offset_path);
+	create_changes.modified_files.push_back(main_path);
+	compiler.set_source_changes(create_changes);
+	if (!compile("Created Files", 18 + 16 + 12 + 8 + 7 + 100 + 3)) return;
+	nyla::sym_table* square_sym_table = compiler.find_sym_table("shapes/Square");
+	check_tof(square_sym_table && square_sym_table->m_reused, "Unchanged File Reused");
+
+	// Deleted file and a deleted directory
+	nyla::remove_directory(extra_path);
+	std::remove(offset_path.c_str());
+	write_test_file(main_path, main_source);
+	nyla::source_changes delete_changes;
+	delete_changes.deleted_directories.push_back(extra_path);
+	delete_changes.deleted_files.push_back(offset_path);
+	delete_changes.modified_files.push_back(main_path);
+	compiler.set_source_changes(delete_changes);
+	if (!compile("Deleted Files", 18 + 16 + 12 + 8 + 7)) return;
+	check_tof(!compiler.find_sym_table("Offset") && !compiler.find_sym_table("extra/Bonus"), "Deleted Files Removed");
+
+	// Editors which save by writing a new file and renaming
+	// it over the old one report a delete and a create
+	write_test_file(square_path, square_source);
+	nyla::source_changes rename_changes;
+	rename_changes.deleted_files.push_back(square_path);
+	rename_changes.created_files.push_back(square_path);
+	compiler.set_source_changes(rename_changes);
+	if (!compile("Renamed File", 9 + 16 + 12 + 8 + 7)) return;
+
+	compiler.completely_cleanup();
+	nyla::remove_directory("nyla_test_watch");
+}
+
+// Builds the project twice and checks that both builds
+// produce the exact same executable. The second build is
+// of a copy of the project at another path and uses a
+// different number of jobs
+void test_reproducible(const std::string& sub_project) {
+	std::string copy_directory_path = "nyla_test_copy/src/" + sub_project;
+	nyla::remove_directory("nyla_test_copy");
+	if (!nyla::create_directory("nyla_test_copy") || !nyla::create_directory("nyla_test_copy/src") ||
+		!copy_directory("resources/" + sub_project, copy_directory_path)) {
+		check_tof(false, "Copy Project");
+		return;
+	}
+	const std::string src_directories[2] = { "resources/" + sub_project, copy_directory_path };
+	const u32 num_jobs[2] = { 1, 4 };
+
+	std::string executables[2];
+	bool compiled = true;
+	for (u32 i = 0; i < 2 && compiled; i++) {
+		std::vector<std::string> project_directories;
+		project_directories.push_back(src_directories[i]);
+		compiled = compile_test_project(project_directories, sub_project, [&num_jobs, i](nyla::compiler& compiler) {
+			compiler.set_num_jobs(num_jobs[i]);
+		}, [&executables, i](nyla::compiler&) {
+			c8*  data;
+			ulen size;
+			if (nyla::read_file("nyla_test_project.exe", data, size)) {
+				executables[i].assign(data, size);
+				delete[] data;
+			}
+		});
+	}
+	nyla::remove_directory("nyla_test_copy");
+	if (compiled) {
+		check_tof(!executables[0].empty() && executables[0] == executables[1], "Identical Executables");
+	}
+}
+
+// Scalar references the scan kernels are checked against
+static bool ref_is_new_line(const c8* ptr) {
+	return *ptr == '\n' || (*ptr == '\r' && *(ptr + 1) != '\n');
+}
+
+static const c8* ref_skip_blank(const c8* ptr, u32& num_lines) {
+	for (; *ptr == ' ' || (*ptr >= 8 && *ptr <= 13); ptr++) {
+		if (ref_is_new_line(ptr)) ++num_lines;
+	}
+	return ptr;
+}
+
+static const c8* ref_find_line_end(const c8* ptr, u32&) {
+	while (*ptr && *ptr != '\n' && *ptr != '\r') ptr++;
+	return ptr;
+}
+
+static const c8* ref_find_block_comment_end(const c8* ptr, u32& num_lines) {
+	for (; *ptr && !(*ptr == '*' && *(ptr + 1) == '/'); ptr++) {
+		if (ref_is_new_line(ptr)) ++num_lines;
+	}
+	return ptr;
+}
+
+static const c8* ref_find_identifier_end(const c8* ptr, u32&) {
+	while ((*ptr >= 'a' && *ptr <= 'z') || (*ptr >= 'A' && *ptr <= 'Z') ||
+		   (*ptr >= '0' && *ptr <= '9') || *ptr == '_') ptr++;
+	return ptr;
+}
+
+static const c8* ref_find_digits_end(const c8* ptr, u32&) {
+	while (*ptr >= '0' && *ptr <= '9') ptr++;
+	return ptr;
+}
+
+static const c8* ref_find_string_special(const c8* ptr, u32&) {
+	while (*ptr && *ptr != '"' && *ptr != '\\' && *ptr != '\n' && *ptr != '\r') ptr++;
+	return ptr;
+}
+
+struct scan_case {
+	c_string name;
+	const c8* (*kernel)(const nyla::scan_kernels& kernels, const c8* ptr, u32& num_lines);
+	const c8* (*reference)(const c8* ptr, u32& num_lines);
+	c_string run_chars;    // Characters the kernel keeps scanning over
+	c_string stop;         // What ends a run of run_chars
+	c_string random_chars; // Characters of inputs which stop anywhere
+};
+
+// Checks the kernels of every instruction set the processor
+// supports against the references for every input length up
+// to 64 at every alignment within 32 bytes, so the stopping
+// character falls at each position of a 16 or 32 byte chunk
+void test_scan_kernels() {
+	const scan_case cases[] = {
+		{ "skip_blank",
+		  [](const nyla::scan_kernels& kernels, const c8* ptr, u32& num_lines) { return kernels.skip_blank(ptr, num_lines); },
+		  ref_skip_blank,
+		  "\r\n \t\r\v\f\n\r", "x", " \t\r\n\r\n\x07\x0e" },
+		{ "find_line_end",
+		  [](const nyla::scan_kernels& kernels, const c8* ptr, u32&) { return kernels.find_line_end(ptr); },
+		  ref_find_line_end,
+		  "ab \t*/\"", "\r", "ab\n\r\t" },
+		{ "find_block_comment_end",
+		  [](const nyla::scan_kernels& kernels, const c8* ptr, u32& num_lines) { return kernels.find_block_comment_end(ptr, num_lines); },
+		  ref_find_block_comment_end,
+		  "\r\n*a\r**\n", "*/", "*/\r\na" },
+		{ "find_identifier_end",
+		  [](const nyla::scan_kernels& kernels, const c8* ptr, u32&) { return kernels.find_identifier_end(ptr); },
+		  ref_find_identifier_end,
+		  "azAZ09_", "@", "aZ09_@[`{/:" },
+		{ "find_digits_end",
+		  [](const nyla::scan_kernels& kernels, const c8* ptr, u32&) { return kernels.find_digits_end(ptr); },
+		  ref_find_digits_end,
+		  "0123456789", "/", "09/:a" },
+		{ "find_string_special",
+		  [](const nyla::scan_kernels& kernels, const c8* ptr, u32&) { return kernels.find_string_special(ptr); },
+		  ref_find_string_special,
+		  "ab' \t/!", "\"", "a\"\\\n\r" },
+	};
+
+	c_string instruction_sets[] = { "Scalar", "SSE2", "AVX2" };
+
+	// Room for the longest input at any alignment followed
+	// by the padding the kernels read into
+	std::vector<c8> storage(32 + 32 + 64 + 2 + nyla::source_padding);
+	c8* aligned = storage.data() + ((32 - ((uintptr_t)storage.data() & 31)) & 31);
+
+	for (c_string instructions : instruction_sets) {
+		const nyla::scan_kernels* kernels = nyla::find_scan_kernels(instructions);
+		if (!kernels) {
+			std::cout << instructions << " is not supported. Skipping its kernels" << std::endl;
+			continue;
+		}
+		for (const scan_case& scan_case : cases) {
+			u32 random = 12345;
+			u32 failures = 0;
+			ulen run_chars_length    = strlen(scan_case.run_chars);
+			ulen random_chars_length = strlen(scan_case.random_chars);
+			for (ulen length = 0; length <= 64; length++) {
+				for (ulen alignment = 0; alignment < 32; alignment++) {
+					// A run in order, a run in random order and random
+					// characters which may stop anywhere
+					std::string inputs[3];
+					for (ulen i = 0; i < length; i++) {
+						random = random * 1103515245 + 12345;
+						inputs[0] += scan_case.run_chars[i % run_chars_length];
+						inputs[1] += scan_case.run_chars[(random >> 16) % run_chars_length];
+						inputs[2] += scan_case.random_chars[(random >> 8) % random_chars_length];
+					}
+					inputs[0] += scan_case.stop;
+					inputs[1] += scan_case.stop;
+
+					for (const std::string& input : inputs) {
+						c8* ptr = aligned + alignment;
+						memset(storage.data(), 0, storage.size());
+						memcpy(ptr, input.c_str(), input.size());
+
+						u32 num_lines = 0, ref_num_lines = 0;
+						const c8* end     = scan_case.kernel(*kernels, ptr, num_lines);
+						const c8* ref_end = scan_case.reference(ptr, ref_num_lines);
+						if (end != ref_end || num_lines != ref_num_lines) {
+							++failures;
+						}
+					}
+				}
+			}
+			std::string info = std::string(instructions) + " " + scan_case.name;
+			check_tof(failures == 0, info.c_str());
+		}
+	}
+}
+
+#ifdef __unix__
+// Starts a compile server on a socket of its own and sends it
+// requests the way nylac-client does. The server compiles with
+// one compiler which keeps unchanged files between requests
+void test_server() {
+	std::string socket_path = "/tmp/nyla-test-" + std::to_string(getpid()) + ".sock";
+
+	// The server never returns so the thread and the
+	// compiler it uses are left running until the tests exit
+	nyla::compiler* compiler = new nyla::compiler;
+	compiler->set_reuse_sym_tables(true);
+	compiler->set_executable_name("nyla_test_project.exe");
+	std::thread server_thread([socket_path, compiler]() {
+		nyla::run_server(socket_path, [compiler](const std::vector<std::string>& args) {
+			std::vector<std::string> src_directories;
+			src_directories.push_back("resources/" + args[0]);
+			compiler->set_flags(nyla::COMPFLAGS_FULL_COMPILATION);
+			compiler->compile(src_directories, args[0]);
+			return compiler->get_found_compilation_errors() ? 1 : 0;
+		});
+	});
+	server_thread.detach();
+
+	// Waiting for the server to listen
+	auto send_request = [&socket_path](const std::string& sub_project, s32& exit_code) {
+		std::vector<std::string> args;
+		args.push_back(sub_project);
+		for (u32 attempt = 0; attempt < 500; attempt++) {
+			if (nyla::send_server_request(socket_path, args, exit_code)) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return false;
+	};
+
+	s32 exit_code;
+	for (u32 i = 0; i < 2; i++) {
+		if (!send_request("LoopSum", exit_code)) {
+			check_tof(false, "Server Reached");
+			return;
+		}
+		check_eq(exit_code, 0, i == 0 ? "Server Compiled" : "Server Compiled Again");
+		check_program_exit_code(54 * 55 / 2);
+	}
+	// The main file does not exist
+	if (send_request("DoesNotExist", exit_code)) {
+		check_eq(exit_code, 1, "Server Compile Errors");
+	} else {
+		check_tof(false, "Server Reached");
+	}
+}
+#endif
+
+// Every keyword is recognized by the perfect hash and words which
+// fall into the slot of a keyword are not. A keyword with another
+// last character has the same first character, second to last
+// character and length so it always falls into the same slot
+void test_keywords() {
+	u32 num_keywords = 0;
+	u32 failures     = 0;
+	for (u32 tag = 0; tag < nyla::TK_EOF; tag++) {
+		c_string spelling = nyla::get_keyword_spelling(tag);
+		if (!spelling) continue;
+		++num_keywords;
+		std::string keyword = spelling;
+		if (nyla::get_keyword_tag(keyword.c_str(), keyword.size()) != tag) {
+			std::cout << "Keyword not recognized: " << keyword << std::endl;
+			++failures;
+		}
+
+		std::string same_slot = keyword;
+		same_slot.back() = same_slot.back() == '_' ? 'x' : '_';
+		const std::string near_misses[] = {
+			same_slot,
+			keyword.substr(0, keyword.size() - 1),
+			keyword + "s",
+			(c8)toupper(keyword[0]) + keyword.substr(1),
+		};
+		for (const std::string& near_miss : near_misses) {
+			if (nyla::get_keyword_tag(near_miss.c_str(), near_miss.size()) != nyla::TK_IDENTIFIER) {
+				std::cout << "Identifier taken as a keyword: " << near_miss << std::endl;
+				++failures;
+			}
+		}
+	}
+	check_eq(num_keywords, 39, "Keywords");
+	check_tof(failures == 0, "Keyword Hash");
+}
+
 void run_personal_test() {
 	nyla::compiler compiler;
 	compiler.set_flags(nyla::COMPFLAGS_FULL_COMPILATION | nyla::COMPFLAG_DISPLAY_STAGES);
@@ -40,6 +691,9 @@ void run_personal_test() {
 
 int main(int argc, char* argv[]) {
 
+	test_scan_kernels();
+	test_keywords();
+
 	test_program("Arithmetic", [](){
 		s32 b = 22;
 		s32 sum = 44 * 3 + 55 - 421 * b;
@@ -98,6 +752,43 @@ int main(int argc, char* argv[]) {
 	test_program("StartupAnnotation", 55);
 	test_program("Hexidecimals", -860032909);
 	test_program("NewObject", 61 + 4 + 5 + 4 + 43 + 124);
+	test_program("Reproducible", 9 + 16 + 12 + 8 + 7);
+	test_reproducible("Reproducible");
+	test_emitted_files();
+	test_source_changes();
+#ifdef __unix__
+	test_server();
+#endif
+	test_concurrent_compilers("LoopSum", 54 * 55 / 2, "NewObject", 61 + 4 + 5 + 4 + 43 + 124);
+
+	test_program("LoopSum", 54 * 55 / 2, nyla::COMPFLAG_OPT_O2);
+	test_program("LoopSum", 54 * 55 / 2, nyla::COMPFLAG_OPT_Os);
+	test_program("NewObject", 61 + 4 + 5 + 4 + 43 + 124, nyla::COMPFLAG_OPT_O2);
+	test_program("NewObject", 61 + 4 + 5 + 4 + 43 + 124, nyla::COMPFLAG_OPT_Os);
+	test_program("StaticModuleCall", "Caller", 631 + 8, nyla::COMPFLAG_OPT_O2);
+
+	test_run("LoopSum", "LoopSum", 54 * 55 / 2);
+	test_run("NewObject", "NewObject", 61 + 4 + 5 + 4 + 43 + 124);
+	test_run("NewObject", "NewObject", 61 + 4 + 5 + 4 + 43 + 124, nyla::COMPFLAG_OPT_O2);
+	test_run("StaticModuleCall", "Caller", 631 + 8);
+	test_run("StartupAnnotation", "StartupAnnotation", 55);
+
+	test_interfaces("StaticModuleCall", "Caller", "Called", 631 + 8);
+	test_interfaces("Reproducible", "Reproducible", "shapes/Square", 9 + 16 + 12 + 8 + 7);
+
+	test_object_cache("LoopSum", "LoopSum", 54 * 55 / 2);
+	test_object_cache("Reproducible", "Reproducible", 9 + 16 + 12 + 8 + 7);
+	test_interfaces_with_object_cache("Reproducible", "Reproducible", "shapes/Triangle", 9 + 16 + 12 + 8 + 7);
+	test_interfaces_with_object_cache("Reproducible", "Reproducible", "shapes/Triangle", 9 + 16 + 12 + 8 + 7,
+		                              nyla::COMPFLAG_OPT_O2 | nyla::COMPFLAG_LTO_THIN);
+	test_object_cache_reachability("CacheReach", "Shapes", "AreaMain", 5 * 5, "PerimeterMain", 7 * 4);
+
+	test_program("LoopSum", 54 * 55 / 2, nyla::COMPFLAG_OPT_O2 | nyla::COMPFLAG_LTO_THIN);
+	test_program("LoopSum", 54 * 55 / 2, nyla::COMPFLAG_OPT_O2 | nyla::COMPFLAG_LTO_FULL);
+	test_program("NewObject", 61 + 4 + 5 + 4 + 43 + 124, nyla::COMPFLAG_OPT_O2 | nyla::COMPFLAG_LTO_THIN);
+	test_program("NewObject", 61 + 4 + 5 + 4 + 43 + 124, nyla::COMPFLAG_OPT_O2 | nyla::COMPFLAG_LTO_FULL);
+	test_program("Reproducible", 9 + 16 + 12 + 8 + 7, nyla::COMPFLAG_OPT_O2 | nyla::COMPFLAG_LTO_THIN);
+	test_program("Reproducible", 9 + 16 + 12 + 8 + 7, nyla::COMPFLAG_OPT_O2 | nyla::COMPFLAG_LTO_FULL);
 
 	return 0;
 }
\ No newline at end of file